@@ -0,0 +1,182 @@
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <simulator.hpp>
+#include <tune.hpp>
+
+#include "workload.hpp"
+
+#ifndef HFT_INSTRUMENT
+#error "The simulator follows the nodes recorded by the instrumentation: define HFT_INSTRUMENT"
+#endif
+
+using namespace std;
+using namespace hft;
+
+constexpr size_t BOUND = 64;
+
+struct Options {
+  vector<string> Trees, Ops = {"prefix", "add", "find"};
+  size_t Size = 1 << 24, Queries = 100000, Warmup = SIZE_MAX;
+  string Dist = "uniform";
+  uint64_t Seed = 0;
+  model::Hierarchy Hw = model::Hierarchy::host();
+};
+
+// split at the commas outside angle brackets, e.g. "bitf,hybrid<fixedl,bytef,16>"
+vector<string> split(const string &list) {
+  vector<string> items(1);
+  int depth = 0;
+  for (char c : list) {
+    depth += (c == '<') - (c == '>');
+    if (c == ',' && depth == 0)
+      items.emplace_back();
+    else
+      items.back() += c;
+  }
+  return items;
+}
+
+size_t bytes(const string &value) {
+  size_t pos;
+  const double number = stod(value, &pos);
+  const string unit = value.substr(pos, 1);
+  const int shift = unit == "K" ? 10 : unit == "M" ? 20 : unit == "G" ? 30 : 0;
+  return number * (1ULL << shift);
+}
+
+// "size:ways", e.g. "48K:12"
+void level(const string &value, size_t &size, size_t &ways) {
+  const size_t colon = value.find(':');
+  size = bytes(value.substr(0, colon));
+  if (colon != string::npos)
+    ways = stoul(value.substr(colon + 1));
+}
+
+void print(const string &tree, const string &op, const Options &opts, const string &name,
+           const model::Misses &m) {
+  printf("%s,%s,%zu,%s,%lu,%lu,%.6f,%lu,%lu,%lu,%.4f\n", tree.c_str(), op.c_str(), opts.Size,
+         name.c_str(), m.Accesses, m.Misses, m.rate(), m.Compulsory, m.Capacity, m.Conflict,
+         m.Misses / (double)opts.Queries);
+}
+
+void usage() {
+  cerr << "Usage: cachesim [--option=value]...\n"
+       << "  --tree    trees, as named by hft-tune (default: every plain tree)\n"
+       << "  --op      prefix, add and/or find (default: all of them)\n"
+       << "  --size    elements (default: 16777216)\n"
+       << "  --queries simulated operations (default: 100000)\n"
+       << "  --warmup  operations run before counting (default: as many as --queries)\n"
+       << "  --dist    key distribution, see benchmark/workload.hpp (default: uniform)\n"
+       << "  --seed    seed of the random engine (default: 0)\n"
+       << "  --l1, --l2, --l3  size:ways of a cache level (default: this machine)\n"
+       << "  --tlb     entries:ways of the TLB (default: 1536:12)\n"
+       << "  --line    bytes of a cache line (default: this machine)\n"
+       << "  --page    bytes of a page (default: the page policy of the build)\n";
+}
+
+// Replays the queries of a workload on each tree through a simulated memory hierarchy and prints,
+// for every cache level and the TLB, the misses split into compulsory, capacity and conflict ones
+// (as a CSV on the standard output)
+int main(int argc, char **argv) {
+  Options opts;
+
+  for (int i = 1; i < argc; i++) {
+    const string arg = argv[i];
+    const size_t eq = arg.find('=');
+    const string key = arg.substr(0, eq), value = eq == string::npos ? "" : arg.substr(eq + 1);
+
+    if (key == "--tree")
+      opts.Trees = split(value);
+    else if (key == "--op")
+      opts.Ops = split(value);
+    else if (key == "--size")
+      opts.Size = stoul(value);
+    else if (key == "--queries")
+      opts.Queries = stoul(value);
+    else if (key == "--warmup")
+      opts.Warmup = stoul(value);
+    else if (key == "--dist")
+      opts.Dist = value;
+    else if (key == "--seed")
+      opts.Seed = stoull(value);
+    else if (key == "--l1" || key == "--l2" || key == "--l3") {
+      const size_t l = key[3] - '1';
+      level(value, opts.Hw.Cache[l], opts.Hw.Ways[l]);
+    } else if (key == "--tlb") {
+      const size_t colon = value.find(':');
+      opts.Hw.Tlb = stoul(value.substr(0, colon));
+      if (colon != string::npos)
+        opts.Hw.TlbWays = stoul(value.substr(colon + 1));
+    } else if (key == "--line")
+      opts.Hw.Line = bytes(value);
+    else if (key == "--page")
+      opts.Hw.Page = bytes(value);
+    else {
+      usage();
+      return -1;
+    }
+  }
+
+  if (opts.Trees.empty())
+    opts.Trees = {"fixedf", "fixedl", "typef", "typel", "bytef", "bytel", "bitf", "bitl"};
+  if (opts.Warmup == SIZE_MAX)
+    opts.Warmup = opts.Queries;
+
+  mt19937_64 re(opts.Seed);
+  unique_ptr<workload::Distribution> dist = workload::make(opts.Dist, opts.Size, re);
+  if (!dist) {
+    cerr << "Unknown distribution: " << opts.Dist << endl;
+    return -1;
+  }
+
+  vector<uint64_t> sequence(opts.Size);
+  uniform_int_distribution<uint64_t> seqdist(0, BOUND);
+  for (uint64_t &e : sequence)
+    e = seqdist(re);
+
+  // finds look for the prefix sums expected at the chosen indices, adds don't change the tree
+  const vector<uint64_t> keys = workload::keys(*dist, opts.Warmup + opts.Queries, re);
+
+  printf("tree,op,size,level,accesses,misses,missrate,compulsory,capacity,conflict,missesperop\n");
+  for (const string &name : opts.Trees) {
+    unique_ptr<fenwick::FenwickTree> tree = tune::makeTree<BOUND>(name, sequence.data(), opts.Size);
+    if (!tree) {
+      cerr << "Unknown tree: " << name << endl;
+      return -1;
+    }
+
+    for (const string &op : opts.Ops) {
+      if (op != "prefix" && op != "add" && op != "find") {
+        cerr << "Unknown operation: " << op << endl;
+        return -1;
+      }
+
+      model::Simulator sim(opts.Hw);
+      model::Watch watch(sim);
+      uint64_t u = 0;
+      for (size_t i = 0; i < keys.size(); i++) {
+        if (i == opts.Warmup)
+          sim.reset();
+
+        if (op == "prefix")
+          u ^= tree->prefix(keys[i]);
+        else if (op == "add")
+          tree->add(keys[i], 0);
+        else
+          u ^= tree->find(keys[i] * (BOUND / 2));
+      }
+
+      print(name, op, opts, "L1", sim.level(0));
+      print(name, op, opts, "L2", sim.level(1));
+      print(name, op, opts, "L3", sim.level(2));
+      print(name, op, opts, "TLB", sim.tlb());
+      const volatile uint64_t __attribute__((unused)) unused = u;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,439 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+#include <fenwick.hpp>
+#include <numa.hpp>
+
+#include "../results.hpp"
+#include "../workload.hpp"
+
+using namespace std;
+using namespace hft::fenwick;
+
+// The page policy of DArray (PAGES, see results.hpp) is a compile-time choice: the Makefile builds
+// this file once per policy and the driver runs a configuration with a different policy by
+// executing its sibling
+
+template <size_t N> using Fixed20Fixed = Hybrid<FixedL, FixedF, N, 20>;
+template <size_t N> using Fixed23Byte = Hybrid<FixedL, ByteF, N, 23>;
+template <size_t N> using Fixed23Bit = Hybrid<FixedL, BitF, N, 23>;
+template <size_t N> using Byte23Byte = Hybrid<ByteL, ByteF, N, 23>;
+template <size_t N> using Byte23Bit = Hybrid<ByteL, BitF, N, 23>;
+template <size_t N> using Bit23Bit = Hybrid<BitL, BitF, N, 23>;
+
+// Hole policies of the classical layouts (see Holes): spacing, and XOR scattering of the lines
+template <size_t N> using FixedFH0 = HoledFixedF<N, Holes<0, 0>>;
+template <size_t N> using FixedFH10 = HoledFixedF<N, Holes<10, 64>>;
+template <size_t N> using FixedFH18 = HoledFixedF<N, Holes<18, 64>>;
+template <size_t N> using FixedFXor = HoledFixedF<N, Holes<14, 64, true>>;
+template <size_t N> using FixedFH0Xor = HoledFixedF<N, Holes<0, 0, true>>;
+template <size_t N> using ByteFH0 = HoledByteF<N, Holes<0, 0>>;
+template <size_t N> using ByteFH14 = HoledByteF<N, Holes<14, 64>>;
+template <size_t N> using BitFH0 = HoledBitF<N, Holes<0, 0>>;
+template <size_t N> using BitFH10 = HoledBitF<N, Holes<10, 64>>;
+
+template <template <size_t> class T> struct Tree {
+  const char *Name;
+};
+
+// Adding a tree to the benchmark only takes a new entry here
+const auto TREES = make_tuple(
+    Tree<FixedF>{"fixedf"}, Tree<FixedL>{"fixedl"}, Tree<ByteF>{"bytef"}, Tree<ByteL>{"bytel"},
+    Tree<BitF>{"bitf"}, Tree<BitL>{"bitl"}, Tree<TypeF>{"typef"}, Tree<TypeL>{"typel"},
+    Tree<Fixed20Fixed>{"fixed20fixed"}, Tree<Fixed23Byte>{"fixed23byte"},
+    Tree<Fixed23Bit>{"fixed23bit"}, Tree<Byte23Byte>{"byte23byte"}, Tree<Byte23Bit>{"byte23bit"},
+    Tree<Bit23Bit>{"bit23bit"}, Tree<FixedFH0>{"fixedf-h0"}, Tree<FixedFH10>{"fixedf-h10"},
+    Tree<FixedFH18>{"fixedf-h18"}, Tree<FixedFXor>{"fixedf-xor"},
+    Tree<FixedFH0Xor>{"fixedf-h0-xor"}, Tree<ByteFH0>{"bytef-h0"}, Tree<ByteFH14>{"bytef-h14"},
+    Tree<BitFH0>{"bitf-h0"}, Tree<BitFH10>{"bitf-h10"});
+
+const vector<string> OPS = {"build", "prefix", "add", "find", "compfind"};
+const vector<string> DISTS = workload::distributions();
+const vector<string> POLICIES = {"transparent", "small", "huge"};
+
+constexpr size_t BOUND = 64, REPS = 5;
+
+/**
+ * struct Config - A single measured configuration.
+ *
+ */
+struct Config {
+  string Tree, Op, Dist, Pages;
+  size_t Size, Threads, Queries;
+  uint64_t Seed;
+};
+
+/**
+ * operation() - Run @keys operations of kind @op on @tree.
+ * @sequence: Elements of the tree, updated by add.
+ *
+ * Return a value depending on every result, so that the compiler can't drop the queries.
+ *
+ */
+template <typename T>
+uint64_t operation(T &tree, const string &op, const vector<uint64_t> &keys, uint64_t *sequence,
+                   uint64_t u) {
+  if (op == "prefix") {
+    for (uint64_t key : keys)
+      u ^= tree.prefix(key ^ (u & 1));
+  } else if (op == "find") {
+    for (uint64_t key : keys)
+      u ^= tree.find(key ^ (u & 1));
+  } else if (op == "compfind") {
+    for (uint64_t key : keys)
+      u ^= tree.compFind(key ^ (u & 1));
+  } else if (op == "add") {
+    // the sequence is tracked to keep every element within its bound
+    for (uint64_t key : keys) {
+      const int64_t val = sequence[key - 1] < BOUND ? 1 : -1;
+      sequence[key - 1] += val;
+      tree.add(key, val);
+    }
+    u ^= tree.prefix(keys.back());
+  }
+
+  return u;
+}
+
+/**
+ * measure() - Run a configuration in this process, write one CSV row per repetition to @out.
+ *
+ */
+template <template <size_t> class T> void measure(const Config &config, ostream &out) {
+  using namespace std::chrono;
+
+  mt19937_64 re(config.Seed);
+  vector<uint64_t> sequence(config.Size);
+  uniform_int_distribution<uint64_t> seqdist(0, BOUND);
+  for (size_t i = 0; i < config.Size; i++)
+    sequence[i] = seqdist(re);
+
+  auto row = [&](size_t rep, double ns) {
+    out << config.Tree << "," << config.Op << "," << config.Size << "," << config.Dist << ","
+        << PAGES << "," << config.Threads << "," << config.Queries << "," << rep << "," << ns
+        << endl;
+  };
+
+  if (config.Op == "build") {
+    for (size_t r = 0; r < REPS; r++) {
+      const auto begin = high_resolution_clock::now();
+      T<BOUND> tree(sequence.data(), config.Size);
+      const auto end = high_resolution_clock::now();
+      row(r, duration_cast<nanoseconds>(end - begin).count() / (double)config.Size);
+    }
+    return;
+  }
+
+  T<BOUND> tree(sequence.data(), config.Size);
+  const bool search = config.Op == "find" || config.Op == "compfind";
+  const uint64_t last = search ? max<uint64_t>(tree.prefix(config.Size), 1) : config.Size;
+
+  // every thread has its own arguments, and they are all drawn before the clock starts
+  vector<vector<uint64_t>> args;
+  for (size_t t = 0; t < config.Threads; t++)
+    args.push_back(workload::keys(*workload::make(config.Dist, last, re), config.Queries, re));
+
+  for (size_t r = 0; r < REPS; r++) {
+    vector<double> elapsed(config.Threads);
+    atomic<size_t> ready(0);
+
+    auto worker = [&](size_t t) {
+      hft::numa::pin(t % hft::numa::nodes());
+
+      ready++;
+      while (ready.load() < config.Threads)
+        ;
+
+      const auto begin = high_resolution_clock::now();
+      const uint64_t u = operation(tree, config.Op, args[t], sequence.data(), t);
+      const auto end = high_resolution_clock::now();
+      elapsed[t] = duration_cast<nanoseconds>(end - begin).count();
+
+      const volatile uint64_t __attribute__((unused)) unused = u;
+    };
+
+    vector<thread> threads;
+    for (size_t t = 1; t < config.Threads; t++)
+      threads.emplace_back(worker, t);
+    worker(0);
+    for (thread &t : threads)
+      t.join();
+
+    double total = 0;
+    for (double ns : elapsed)
+      total += ns;
+    row(r, total / config.Threads / config.Queries);
+  }
+}
+
+template <typename> struct Measure;
+template <template <size_t> class T> struct Measure<Tree<T>> {
+  static void run(const Config &config, ostream &out) { measure<T>(config, out); }
+};
+
+/**
+ * run() - Run a configuration in this process, false if the tree is unknown.
+ *
+ */
+template <size_t... I> bool run(const Config &config, ostream &out, index_sequence<I...>) {
+  bool found = false;
+  ((get<I>(TREES).Name == config.Tree
+        ? (Measure<decay_t<decltype(get<I>(TREES))>>::run(config, out), found = true)
+        : false),
+   ...);
+  return found;
+}
+
+bool run(const Config &config, ostream &out) {
+  return run(config, out, make_index_sequence<tuple_size_v<decltype(TREES)>>());
+}
+
+template <size_t... I> vector<string> names(index_sequence<I...>) {
+  return {get<I>(TREES).Name...};
+}
+
+/**
+ * sibling() - Path of the driver built with another page policy.
+ *
+ */
+string sibling(const string &pages) {
+  char self[4096];
+  const ssize_t len = readlink("/proc/self/exe", self, sizeof(self) - 1);
+  if (len < 0)
+    return "";
+
+  string path(self, len);
+  path = path.substr(0, path.rfind('/') + 1);
+  return path + (pages == "transparent" ? "driver" : "driver_" + pages);
+}
+
+/**
+ * isolated() - Run a configuration in a child process and return its CSV rows.
+ *
+ * Every configuration starts from a fresh address space: no warm caches, no recycled pages and
+ * no allocator state inherited from the previous one.
+ *
+ */
+string isolated(const Config &config) {
+  int fd[2];
+  if (pipe(fd) != 0)
+    return "";
+
+  const pid_t pid = fork();
+  if (pid == 0) {
+    close(fd[0]);
+    dup2(fd[1], STDOUT_FILENO);
+
+    if (config.Pages == PAGES) {
+      if (!run(config, cout))
+        _exit(1);
+      cout.flush();
+      _exit(0);
+    }
+
+    const string exe = sibling(config.Pages);
+    const vector<string> args = {exe,
+                                 "--child",
+                                 "--tree=" + config.Tree,
+                                 "--op=" + config.Op,
+                                 "--size=" + to_string(config.Size),
+                                 "--dist=" + config.Dist,
+                                 "--pages=" + config.Pages,
+                                 "--threads=" + to_string(config.Threads),
+                                 "--queries=" + to_string(config.Queries),
+                                 "--seed=" + to_string(config.Seed)};
+    vector<char *> argv;
+    for (const string &arg : args)
+      argv.push_back(const_cast<char *>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    execv(exe.c_str(), argv.data());
+    cerr << "Cannot execute " << exe << ": " << strerror(errno) << endl;
+    _exit(1);
+  }
+
+  close(fd[1]);
+  string rows;
+  char buffer[4096];
+  for (ssize_t len; (len = read(fd[0], buffer, sizeof(buffer))) > 0;)
+    rows.append(buffer, len);
+  close(fd[0]);
+
+  int status;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    cerr << "Configuration failed: " << config.Tree << " " << config.Op << " " << config.Size
+         << " " << config.Dist << " " << config.Pages << " " << config.Threads << endl;
+
+  return rows;
+}
+
+vector<string> split(const string &list, const vector<string> &all) {
+  if (list == "all")
+    return all;
+
+  vector<string> items;
+  istringstream stream(list);
+  for (string item; getline(stream, item, ',');)
+    items.push_back(item);
+  return items;
+}
+
+bool check(const vector<string> &items, const vector<string> &valid, const char *what) {
+  for (const string &item : items) {
+    if (find(valid.begin(), valid.end(), item) == valid.end()) {
+      cerr << "Unknown " << what << ": " << item << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+void usage() {
+  const vector<string> trees = names(make_index_sequence<tuple_size_v<decltype(TREES)>>());
+  auto join = [](const vector<string> &items) {
+    string joined;
+    for (const string &item : items)
+      joined += (joined.empty() ? "" : ",") + item;
+    return joined;
+  };
+
+  cerr << "Usage: driver [--option=value,value,...|all]...\n"
+       << "  --tree     " << join(trees) << "\n"
+       << "  --op       " << join(OPS) << "\n"
+       << "  --dist     " << join(DISTS) << "\n"
+       << "  --pages    " << join(POLICIES) << " (default: " PAGES ")\n"
+       << "  --size     number of elements (default: 1000000)\n"
+       << "  --threads  number of threads querying the same tree (default: 1)\n"
+       << "  --queries  operations per thread and repetition (default: 1000000)\n"
+       << "  --seed     seed of the random engine (default: 0)\n"
+       << "  --out      CSV file the rows are appended to (default: standard output)\n"
+       << "  --json     JSON file with the repetitions and the metadata of the run (see "
+          "utils/compare.py)\n";
+}
+
+// Runs the cartesian product of the selected configurations, each in its own process, and emits
+// one row per repetition: tree,op,size,dist,pages,threads,queries,rep,ns (per item and thread)
+int main(int argc, char **argv) {
+  const vector<string> trees = names(make_index_sequence<tuple_size_v<decltype(TREES)>>());
+  string tree = "all", op = "prefix,add,find", dist = "uniform", pages = PAGES, out, json;
+  string size = "1000000", threads = "1";
+  size_t queries = 1000000;
+  uint64_t seed = 0;
+  bool child = false;
+
+  for (int i = 1; i < argc; i++) {
+    const string arg = argv[i];
+    const size_t eq = arg.find('=');
+    const string key = arg.substr(0, eq), value = eq == string::npos ? "" : arg.substr(eq + 1);
+
+    if (key == "--tree")
+      tree = value;
+    else if (key == "--op")
+      op = value;
+    else if (key == "--dist")
+      dist = value;
+    else if (key == "--pages")
+      pages = value;
+    else if (key == "--size")
+      size = value;
+    else if (key == "--threads")
+      threads = value;
+    else if (key == "--queries")
+      queries = stoul(value);
+    else if (key == "--seed")
+      seed = stoull(value);
+    else if (key == "--out")
+      out = value;
+    else if (key == "--json")
+      json = value;
+    else if (key == "--child")
+      child = true;
+    else {
+      usage();
+      return -1;
+    }
+  }
+
+  const vector<string> treelist = split(tree, trees), oplist = split(op, OPS),
+                       distlist = split(dist, DISTS), pagelist = split(pages, POLICIES);
+  if (!check(treelist, trees, "tree") || !check(oplist, OPS, "operation") ||
+      !check(distlist, DISTS, "distribution") || !check(pagelist, POLICIES, "page policy")) {
+    usage();
+    return -1;
+  }
+
+  vector<size_t> sizelist, threadlist;
+  for (const string &s : split(size, {}))
+    sizelist.push_back(stoul(s));
+  for (const string &t : split(threads, {}))
+    threadlist.push_back(max<size_t>(stoul(t), 1));
+
+  if (child) {
+    const Config config{treelist[0], oplist[0], distlist[0], pagelist[0], sizelist[0],
+                        threadlist[0], queries, seed};
+    return run(config, cout) ? 0 : 1;
+  }
+
+  ofstream file;
+  if (!out.empty()) {
+    struct stat buffer;
+    const bool exists = stat(out.c_str(), &buffer) == 0;
+    file.open(out, ios::out | ios::app);
+    if (!exists)
+      file << "tree,op,size,dist,pages,threads,queries,rep,ns" << endl;
+  } else {
+    cout << "tree,op,size,dist,pages,threads,queries,rep,ns" << endl;
+  }
+  ostream &csv = out.empty() ? cout : file;
+  results::Json results;
+
+  for (const string &p : pagelist)
+    for (size_t s : sizelist)
+      for (const string &t : treelist)
+        for (const string &o : oplist)
+          for (const string &d : distlist)
+            for (size_t n : threadlist) {
+              // add is not thread-safe and build doesn't depend on the arguments
+              if ((o == "add" && n > 1) || (o == "build" && (n > 1 || d != distlist[0])))
+                continue;
+
+              cerr << p << " " << s << " " << t << " " << o << " " << d << " x" << n << endl;
+              const string rows = isolated(Config{t, o, d, p, s, n, queries, seed});
+              csv << rows << flush;
+
+              // the last field of every row is the time of a repetition
+              vector<double> samples;
+              istringstream stream(rows);
+              for (string row; getline(stream, row);)
+                samples.push_back(stod(row.substr(row.rfind(',') + 1)));
+
+              if (!samples.empty())
+                results.add({{"tree", t},
+                             {"op", o},
+                             {"size", to_string(s)},
+                             {"dist", d},
+                             {"pages", p},
+                             {"threads", to_string(n)},
+                             {"queries", to_string(queries)}},
+                            samples);
+            }
+
+  if (!json.empty())
+    results.write(json);
+
+  return 0;
+}
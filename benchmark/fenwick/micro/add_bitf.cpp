@@ -1,2 +0,0 @@
-#define __HFT_BENCHMARK_FUNCTION__ add<BitF<64>>(name + "/" + "BitF", queries, re);
-#include "../micro.cpp"
@@ -1,2 +0,0 @@
-#define __HFT_BENCHMARK_FUNCTION__ add<BitL<64>>(name + "/" + "BitL", queries, re);
-#include "../micro.cpp"
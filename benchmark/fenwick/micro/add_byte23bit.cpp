@@ -1,2 +0,0 @@
-#define __HFT_BENCHMARK_FUNCTION__ add<Hybrid<ByteL, BitF, 64, 23>>(name + "/" + "Byte23Bit", queries, re);
-#include "../micro.cpp"
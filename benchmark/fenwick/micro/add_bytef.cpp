@@ -1,2 +0,0 @@
-#define __HFT_BENCHMARK_FUNCTION__ add<ByteF<64>>(name + "/" + "ByteF", queries, re);
-#include "../micro.cpp"
@@ -1,2 +0,0 @@
-#define __HFT_BENCHMARK_FUNCTION__ prefix<Hybrid<BitL, BitF, 64, 23>>(name + "/" + "Bit23Bit", queries, re);
-#include "../micro.cpp"
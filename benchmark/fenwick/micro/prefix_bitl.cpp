@@ -1,2 +0,0 @@
-#define __HFT_BENCHMARK_FUNCTION__ prefix<BitL<64>>(name + "/" + "BitL", queries, re);
-#include "../micro.cpp"
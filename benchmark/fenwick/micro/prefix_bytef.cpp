@@ -1,2 +0,0 @@
-#define __HFT_BENCHMARK_FUNCTION__ prefix<ByteF<64>>(name + "/" + "ByteF", queries, re);
-#include "../micro.cpp"
@@ -1,2 +0,0 @@
-#define __HFT_BENCHMARK_FUNCTION__ prefix<ByteL<64>>(name + "/" + "ByteL", queries, re);
-#include "../micro.cpp"
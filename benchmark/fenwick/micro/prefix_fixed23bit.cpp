@@ -1,2 +0,0 @@
-#define __HFT_BENCHMARK_FUNCTION__ prefix<Hybrid<FixedL, BitF, 64, 23>>(name + "/" + "Fixed23Bit", queries, re);
-#include "../micro.cpp"
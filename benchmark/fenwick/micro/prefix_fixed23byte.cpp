@@ -1,2 +0,0 @@
-#define __HFT_BENCHMARK_FUNCTION__ prefix<Hybrid<FixedL, ByteF, 64, 23>>(name + "/" + "Fixed23Byte", queries, re);
-#include "../micro.cpp"
@@ -1,2 +0,0 @@
-#define __HFT_BENCHMARK_FUNCTION__ prefix<FixedF<64>>(name + "/" + "FixedF", queries, re);
-#include "../micro.cpp"
@@ -1,2 +0,0 @@
-#define __HFT_BENCHMARK_FUNCTION__ prefix<FixedL<64>>(name + "/" + "FixedL", queries, re);
-#include "../micro.cpp"
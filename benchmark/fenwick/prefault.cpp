@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+
+#include <fenwick.hpp>
+#include <numa.hpp>
+
+using namespace std;
+
+#if defined(HFT_PREFAULT) && defined(HFT_NUMA_INTERLEAVE)
+#define PLACEMENT "prefault+interleave"
+#elif defined(HFT_PREFAULT)
+#define PLACEMENT "prefault"
+#elif defined(HFT_NUMA_INTERLEAVE)
+#define PLACEMENT "interleave"
+#else
+#define PLACEMENT "firsttouch"
+#endif
+
+template <template <size_t> class T>
+void placement(ofstream &csv, const char *name, size_t size, size_t queries, mt19937 re);
+
+// Build this file once per placement (without flags, with -DHFT_PREFAULT, -DHFT_NUMA_INTERLEAVE or
+// both) and run every binary with the same <outdir>: the rows are appended to the same prefault.csv
+int main(int argc, char **argv) {
+  using namespace hft::fenwick;
+
+  if (argc < 4) {
+    cerr << "Not enough parameters: <outdir> <size> <queries> [seed]\n";
+    return -1;
+  }
+
+  const string path = argv[1];
+  const size_t size = stoul(argv[2]);
+  const size_t queries = stoul(argv[3]);
+  const uint64_t seed = argc >= 5 ? stoul(argv[4]) : 0;
+
+  mt19937 re(seed);
+
+  const string filename = path + "prefault.csv";
+  struct stat buffer;
+  const bool exists = stat(filename.c_str(), &buffer) == 0;
+
+  ofstream csv(filename, ios::out | ios::app);
+  if (!exists)
+    csv << "Elements,Nodes,Placement,Tree,build,find" << endl;
+
+  cout << PLACEMENT << " on " << hft::numa::nodes() << " node(s)" << endl;
+  placement<FixedF>(csv, "FixedF", size, queries, re);
+  placement<ByteF>(csv, "ByteF", size, queries, re);
+  placement<BitF>(csv, "BitF", size, queries, re);
+  placement<ByteL>(csv, "ByteL", size, queries, re);
+  placement<BitL>(csv, "BitL", size, queries, re);
+
+  return 0;
+}
+
+template <template <size_t> class T>
+void placement(ofstream &csv, const char *name, size_t size, size_t queries, mt19937 re) {
+  using namespace std::chrono;
+  high_resolution_clock::time_point begin, end;
+
+  uint64_t u = 0;
+  const double c = 1. / queries;
+  constexpr size_t BOUND = 64, REPS = 5, IDXMID = (REPS - 1) / 2;
+  uniform_int_distribution<uint64_t> seqdist(0, BOUND);
+  uniform_int_distribution<uint64_t> cumseqdist(0, BOUND * size / 2);
+
+  unique_ptr<uint64_t[]> sequence = make_unique<uint64_t[]>(size);
+  for (size_t i = 0; i < size; i++)
+    sequence[i] = seqdist(re);
+
+  begin = high_resolution_clock::now();
+  T<BOUND> fenwick(sequence.get(), size);
+  end = high_resolution_clock::now();
+  const double build = duration_cast<nanoseconds>(end - begin).count() / (double)size;
+  sequence.reset(nullptr);
+
+  cout << name << ": build " << build << setw(7) << " ns/item" << flush;
+
+  vector<nanoseconds::rep> find;
+  for (size_t r = 0; r < REPS; r++) {
+    begin = high_resolution_clock::now();
+    for (uint64_t i = 0; i < queries; ++i)
+      u ^= fenwick.find(cumseqdist(re) ^ (u & 1));
+    end = high_resolution_clock::now();
+    find.push_back(duration_cast<nanoseconds>(end - begin).count());
+  }
+  sort(find.begin(), find.end());
+  cout << ", find " << find[IDXMID] * c << setw(7) << " ns/item" << endl;
+
+  csv << size << "," << hft::numa::nodes() << "," PLACEMENT "," << name << "," << build << ","
+      << find[IDXMID] * c << endl;
+
+  const volatile uint64_t __attribute__((unused)) unused = u;
+}
@@ -8,10 +8,17 @@
 
 using namespace std;
 
+// HFT_HOLES overrides the spacing of the holes of FixedF, ByteF and BitF (see Holes)
+#ifdef HFT_HOLES
+#define HOLES "holes every 2^" STRINGIFY(HFT_HOLES)
+#else
+#define HOLES "default holes"
+#endif
+
 template <template <size_t> class T>
 void runall(const char *name, size_t size, size_t queries, mt19937 re);
 
-// g++ -DHFT_DISABLE_TRANSHUGE -DHFT_NOHOLES -std=c++17 -O3 -march=native -I../../include runall.cpp
+// g++ -DHFT_DISABLE_TRANSHUGE -DHFT_HOLES=0 -std=c++17 -O3 -march=native -I../../include runall.cpp
 int main(int argc, char **argv) {
   using namespace hft::fenwick;
 
@@ -26,12 +33,12 @@ int main(int argc, char **argv) {
 
   mt19937 re(seed);
 
-  runall<FixedF>("FixedF (holes " STRINGIFY(HFT_HOLES) ")", size, queries, re);
-  // runall<FixedL>("FixedL (holes " STRINGIFY(HFT_HOLES) ")", size, queries, re);
-  runall<ByteF>("ByteF (holes " STRINGIFY(HFT_HOLES) ")", size, queries, re);
-  // runall<ByteL>("ByteL (holes " STRINGIFY(HFT_HOLES) ")", size, queries, re);
-  runall<BitF>("BitF (holes " STRINGIFY(HFT_HOLES) ")", size, queries, re);
-  // runall<BitL>("BitL (holes " STRINGIFY(HFT_HOLES) ")", size, queries, re);
+  runall<FixedF>("FixedF (" HOLES ")", size, queries, re);
+  // runall<FixedL>("FixedL (" HOLES ")", size, queries, re);
+  runall<ByteF>("ByteF (" HOLES ")", size, queries, re);
+  // runall<ByteL>("ByteL (" HOLES ")", size, queries, re);
+  runall<BitF>("BitF (" HOLES ")", size, queries, re);
+  // runall<BitL>("BitL (" HOLES ")", size, queries, re);
 
   return 0;
 }
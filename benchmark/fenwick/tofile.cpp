@@ -6,8 +6,15 @@
 #include <fstream>
 #include <string>
 #include <memory>
+#include <sstream>
 
 #include <fenwick.hpp>
+#include <model.hpp>
+
+#include "../latency.hpp"
+#include "../perf.hpp"
+#include "../results.hpp"
+#include "../workload.hpp"
 
 using namespace std;
 using namespace hft::fenwick;
@@ -22,19 +29,44 @@ template <size_t N> using Fixed26Bit = Hybrid<FixedL, BitF, N, 26>;
 
 template <size_t BOUND> class Benchmark {
 private:
-    string path;
+    string path, dist;
     size_t size, queries;
 
     mt19937 mte;
     unique_ptr<uint64_t[]> sequence = make_unique<uint64_t[]>(size);
-    uniform_int_distribution<uint64_t> seqdist, cumseqdist;
+    uniform_int_distribution<uint64_t> seqdist;
     uniform_int_distribution<size_t> idxdist;
 
+    // arguments of the queries (drawn from the chosen distribution) and YCSB operation streams
+    static constexpr char YCSB[] = "abcdef";
+    vector<uint64_t> keys, values;
+    vector<workload::Operation> streams[6];
+    ofstream fycsb[6];
+
     ofstream fbuild, fprefix, fadd, ffind, ffindc, fbitspace;
+    ofstream fmempayload, fmemholes, fmempages, fmemmetadata, fmemresident;
+
+    // hardware counters, one long-format file per operation
+    Perf perf;
+    PerfFile pprefix, padd, pfind;
+
+    // costs predicted by the analytic model for the same queries, see utils/modelcheck.py
+    hft::model::Hierarchy hierarchy = hft::model::Hierarchy::host();
+    ofstream fmodel;
+
+    // latency distribution of single operations
+    Clock clock;
+    LatencyFile lprefix, ladd, lfind;
+    vector<string> trees;
+    size_t column = 0;
+
+    // every repetition of every measure, with the metadata of the run
+    results::Json results;
 
   public:
-    Benchmark(string path, size_t size, size_t queries) :
+    Benchmark(string path, size_t size, size_t queries, string dist) :
         path(path),
+        dist(dist),
         size(size),
         queries(queries) {}
 
@@ -45,6 +77,33 @@ private:
       finit(ffind, "find.csv", "Elements," + order);
       finit(ffindc, "findc.csv", "Elements," + order);
       finit(fbitspace, "bitspace.csv", "Elements," + order);
+      finit(fmempayload, "mempayload.csv", "Elements," + order);
+      finit(fmemholes, "memholes.csv", "Elements," + order);
+      finit(fmempages, "mempages.csv", "Elements," + order);
+      finit(fmemmetadata, "memmetadata.csv", "Elements," + order);
+      finit(fmemresident, "memresident.csv", "Elements," + order);
+      for (int w = 0; w < 6; w++)
+        finit(fycsb[w], string("ycsb_") + YCSB[w] + ".csv", "Elements," + order);
+
+      pprefix.open(path + "perf_prefix.csv");
+      padd.open(path + "perf_add.csv");
+      pfind.open(path + "perf_find.csv");
+
+      const bool fresh = is_empty(ifstream(path + "model.csv"));
+      fmodel.open(path + "model.csv", ios::out | ios::app);
+      if (fresh)
+        fmodel << "Elements,Tree,Op,nodes,lines,pages,l1dmiss,l2miss,llcmiss,dtlbmiss" << endl;
+
+      lprefix.open(path + "latency_prefix");
+      ladd.open(path + "latency_add");
+      lfind.open(path + "latency_find");
+
+      istringstream names(order);
+      for (string name; getline(names, name, ',');)
+        trees.push_back(name);
+
+      if (!perf.available())
+        cout << "Hardware performance counters unavailable: software events only" << endl;
     }
 
     void separator(string sep = ",") {
@@ -54,16 +113,33 @@ private:
         ffind << sep;
         ffindc << sep;
         fbitspace << sep;
+        fmempayload << sep;
+        fmemholes << sep;
+        fmempages << sep;
+        fmemmetadata << sep;
+        fmemresident << sep;
+        for (ofstream &f : fycsb)
+          f << sep;
+        column++;
     }
 
     void datainit(mt19937 &engine) {
       mte = engine;
       seqdist = uniform_int_distribution<uint64_t>(0, BOUND);
       idxdist = uniform_int_distribution<size_t>(1, size);
-      cumseqdist = uniform_int_distribution<uint64_t>(0, BOUND*size);
 
       for (size_t i = 0; i < size; i++)
         sequence[i] = seqdist(mte);
+
+      // finds look for the prefix sums expected at the chosen indices
+      mt19937_64 re(mte());
+      keys = workload::keys(*workload::make(dist, size, re), queries, re);
+      values = workload::keys(*workload::make(dist, size, re), queries, re);
+      for (uint64_t &value : values)
+        value *= BOUND / 2;
+
+      for (int w = 0; w < 6; w++)
+        streams[w] = workload::stream(workload::ycsb(YCSB[w]), size, queries, re);
     }
 
     template <template <size_t> class T> void run() {
@@ -77,71 +153,205 @@ private:
       end = high_resolution_clock::now();
       auto build = duration_cast<chrono::nanoseconds>(end - begin).count();
       fbuild << to_string(build / (double)size);
+      results.add(config("build"), {build / (double)size});
 
       constexpr int REPS = 5;
       constexpr size_t MID = 2; // index of the median of a REPS elements sorted vector
 
       cout << "prefix: " << flush;
       vector<chrono::nanoseconds::rep> prefix;
+      perf.clear();
       for (int r = 0; r < REPS; r++) {
           cout << r << " " << flush;
+          perf.start();
           begin = high_resolution_clock::now();
           for (uint64_t i = 0; i < queries; ++i) {
-            u ^= tree.prefix(idxdist(mte) ^ (u & 1));
+            u ^= tree.prefix(keys[i] ^ (u & 1));
             // u ^= tree.prefix(idxdist(mte));
           }
           end = high_resolution_clock::now();
+          perf.stop();
           prefix.push_back(duration_cast<chrono::nanoseconds>(end-begin).count());
       }
+      result("prefix", prefix);
       std::sort(prefix.begin(), prefix.end());
       fprefix << to_string(prefix[MID] * c);
+      pprefix.write(size, trees[column], perf, REPS * (double)queries);
 
       cout << "find: " << flush;
       vector<chrono::nanoseconds::rep> find;
+      perf.clear();
       for (int r = 0; r < REPS; r++) {
           cout << r << " " << flush;
+          perf.start();
           begin = high_resolution_clock::now();
           for (uint64_t i = 0; i < queries; ++i) {
-            u ^= tree.find(cumseqdist(mte) ^ (u & 1));
+            u ^= tree.find(values[i] ^ (u & 1));
             // u ^= tree.find(cumseqdist(mte));
           }
           end = high_resolution_clock::now();
+          perf.stop();
           find.push_back(duration_cast<chrono::nanoseconds>(end-begin).count());
       }
+      result("find", find);
       std::sort(find.begin(), find.end());
       ffind << to_string(find[MID] * c);
+      pfind.write(size, trees[column], perf, REPS * (double)queries);
 
       cout << "add: " << flush;
       vector<chrono::nanoseconds::rep> add;
+      perf.clear();
       for (int r = 0; r < REPS; r++) {
           cout << r << " " << flush;
+          perf.start();
           begin = high_resolution_clock::now();
           for (uint64_t i = 0; i < queries; ++i) {
-            size_t idx = idxdist(mte);
+            size_t idx = keys[i];
             int64_t val = seqdist(mte) ^ (u & 1);
             //tree.add(idx, i % 2 ? -val : val);
-            tree.add(idx, sequence[idx] + val < BOUND ? val : -val);
+            tree.add(idx, sequence[idx - 1] + val < BOUND ? val : -val);
             // size_t idx = idxdist(mte);
             // uint64_t val = seqdist(mte);
             // tree.add(idx, sequence[idx] + val < BOUND ? val : -val);
           }
           end = high_resolution_clock::now();
+          perf.stop();
           add.push_back(duration_cast<chrono::nanoseconds>(end-begin).count());
       }
+      result("add", add);
       std::sort(add.begin(), add.end());
       fadd << to_string(add[MID] * c);
+      padd.write(size, trees[column], perf, REPS * (double)queries);
 
       // the compiler can't erase the adds
       u ^= tree.prefix(idxdist(mte));
 
+      if constexpr (hft::model::modelled<T<BOUND>>) {
+        cout << "model... " << flush;
+        predict(tree);
+      }
+
+      // the adds above don't keep track of the elements, the mixed streams do
+      vector<uint64_t> elements(sequence.get(), sequence.get() + size);
+      cout << "ycsb: " << flush;
+      for (int w = 0; w < 6; w++) {
+          cout << YCSB[w] << " " << flush;
+          vector<chrono::nanoseconds::rep> mixed;
+          for (int r = 0; r < REPS; r++) {
+              begin = high_resolution_clock::now();
+              u ^= mix(tree, streams[w], elements.data());
+              end = high_resolution_clock::now();
+              mixed.push_back(duration_cast<chrono::nanoseconds>(end-begin).count());
+          }
+          result(string("ycsb_") + YCSB[w], mixed);
+          std::sort(mixed.begin(), mixed.end());
+          fycsb[w] << to_string(mixed[MID] * c);
+      }
+
+      cout << "latency... " << flush;
+      u ^= sample(lprefix, [&](uint64_t i) { return tree.prefix(keys[i]); });
+      u ^= sample(lfind, [&](uint64_t i) { return tree.find(values[i]); });
+      u ^= sample(ladd, [&](uint64_t i) {
+        const int64_t val = elements[keys[i] - 1] < BOUND ? 1 : -1;
+        elements[keys[i] - 1] += val;
+        tree.add(keys[i], val);
+        return 0;
+      });
+
       cout << "bitspace... " << flush;
       fbitspace << to_string(tree.bitCount() / (size * 64.));
+      memory(tree.memoryReport());
       cout << "done.  " << endl;
 
       const volatile uint64_t __attribute__((unused)) unused = u;
     }
 
+    // results_<size>_<distribution>.json, see utils/compare.py
+    void save() {
+      results.write(path + "results_" + to_string(size) + "_" + dist + ".json");
+    }
+
 private:
+    results::Config config(const string &op) {
+      return {{"tree", trees[column]}, {"op", op}, {"size", to_string(size)}, {"dist", dist}};
+    }
+
+    // nanoseconds per query of every repetition
+    void result(const string &op, const vector<chrono::nanoseconds::rep> &reps) {
+      vector<double> samples;
+      for (auto ns : reps)
+        samples.push_back(ns / (double)queries);
+      results.add(config(op), samples);
+    }
+
+    // predictions for (a prefix of) the queries of the loops above
+    template <typename T> void predict(const T &tree) {
+      using namespace hft;
+      const size_t count = min<size_t>(queries, 1 << 16);
+      vector<size_t> found(count);
+      for (size_t i = 0; i < count; i++)
+        found[i] = tree.find(values[i]);
+
+      const pair<string, model::Cost> costs[] = {
+          {"prefix", model::predict<T>(size, trace::PREFIX, keys.data(), count, hierarchy)},
+          {"find", model::predict<T>(size, trace::FIND, found.data(), count, hierarchy)},
+          {"add", model::predict<T>(size, trace::ADD, keys.data(), count, hierarchy)}};
+
+      for (const auto &[op, cost] : costs)
+        fmodel << size << "," << trees[column] << "," << op << "," << cost.Nodes << ","
+               << cost.Lines << "," << cost.Pages << "," << cost.L1 << "," << cost.L2 << ","
+               << cost.L3 << "," << cost.Tlb << endl;
+    }
+
+    // time every query on its own, with the same arguments of the loops above
+    template <typename F> uint64_t sample(LatencyFile &file, F &&op) {
+      Histogram hist;
+      uint64_t u = 0;
+      for (uint64_t i = 0; i < queries; ++i) {
+        const uint64_t begin = Clock::ticks();
+        u ^= op(i);
+        const uint64_t end = Clock::ticks();
+        hist.record(llround(clock.ns(begin, end)));
+      }
+
+      file.write(size, trees[column], hist);
+      return u;
+    }
+
+    template <typename T>
+    uint64_t mix(T &tree, const vector<workload::Operation> &ops, uint64_t *elements) {
+      uint64_t u = 0;
+      for (const workload::Operation &op : ops) {
+        switch (op.Kind) {
+        case workload::Op::READ:
+          u ^= tree.prefix(op.Key);
+          break;
+        case workload::Op::SCAN:
+          u ^= tree.prefix(min(op.Key + op.Length, size)) - tree.prefix(op.Key - 1);
+          break;
+        case workload::Op::RMW:
+          u ^= tree.prefix(op.Key);
+          [[fallthrough]];
+        case workload::Op::UPDATE:
+          const int64_t val = elements[op.Key - 1] < BOUND ? 1 : -1;
+          elements[op.Key - 1] += val;
+          tree.add(op.Key, val);
+          break;
+        }
+      }
+      return u;
+    }
+
+    // same unit of bitspace.csv: bits per 64-bit element
+    void memory(const hft::MemoryReport &report) {
+      const double c = 1. / (size * 64.);
+      fmempayload << to_string(report.Payload * c);
+      fmemholes << to_string(report.Holes * c);
+      fmempages << to_string(report.Pages * c);
+      fmemmetadata << to_string(report.Metadata * c);
+      fmemresident << to_string(report.Resident * c);
+    }
+
     bool is_empty(ifstream file) {
         return file.peek() == ifstream::traits_type::eof();
     }
@@ -164,8 +374,8 @@ int main(int argc, char *argv[])
     random_device rd;
     mt19937 mte(rd());
 
-    if (argc < 3) {
-        cerr << "Invalid parameters: <outdir> <size> <queries>" << endl;
+    if (argc < 4) {
+        cerr << "Invalid parameters: <outdir> <size> <queries> [distribution]" << endl;
         return -1;
     }
 
@@ -174,7 +384,14 @@ int main(int argc, char *argv[])
 
     constexpr size_t BOUND = 64;
 
-    Benchmark<BOUND> bench(argv[1], size, queries);
+    const string dist = argc >= 5 ? argv[4] : "uniform";
+    mt19937_64 check;
+    if (!workload::make(dist, 1, check)) {
+        cerr << "Unknown distribution: " << dist << endl;
+        return -1;
+    }
+
+    Benchmark<BOUND> bench(argv[1], size, queries, dist);
     bench.datainit(mte);
 
     bench.filesinit("fixed[F],fixed[$\\ell$],byte[F],byte[$\\ell$],bit[F],bit[$\\ell$],"
@@ -192,5 +409,6 @@ int main(int argc, char *argv[])
     cout << "size = " << size << ", queries = " << queries << " => fixed[26]byte:  ";  bench.run<Fixed26Byte>(); bench.separator();
     cout << "size = " << size << ", queries = " << queries << " => fixed[26]bit:   ";  bench.run<Fixed26Bit>(); bench.separator("\n");
 
+    bench.save();
     return 0;
 }
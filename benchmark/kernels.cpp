@@ -0,0 +1,153 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <popcount.hpp>
+#include <rankselect/stride.hpp>
+#include <rankselect/word.hpp>
+#include <fenwick/bytel.hpp>
+
+using namespace std;
+using namespace hft;
+
+// defeats dead code elimination
+static volatile uint64_t Sink;
+
+template <typename F> double nsPerOp(size_t ops, F &&run) {
+  const auto begin = chrono::high_resolution_clock::now();
+  Sink = run();
+  const auto end = chrono::high_resolution_clock::now();
+  return chrono::duration_cast<chrono::nanoseconds>(end - begin).count() / (double)ops;
+}
+
+void row(const string &kernel, const string &variant, bool selected, double ns) {
+  printf("%-12s %-12s %s %8.3f ns\n", kernel.c_str(), variant.c_str(), selected ? "*" : " ", ns);
+}
+
+int main(int argc, char *argv[]) {
+  const size_t ops = argc > 1 ? stoul(argv[1]) : 10000000;
+
+  const cpu::Features &host = cpu::Host;
+  printf("host:     popcnt=%d bmi2=%d fast-pdep=%d avx2=%d avx512-vpopcntq=%d\n", host.Popcnt,
+         host.Bmi2, host.FastPdep, host.Avx2, host.Avx512Popcnt);
+
+  const bool native_popcnt =
+#ifdef __POPCNT__
+      true;
+#else
+      false;
+#endif
+  const bool native_pdep =
+#if defined(__BMI2__) && !defined(__znver1__) && !defined(__znver2__)
+      true;
+#else
+      false;
+#endif
+#ifdef HFT_DISABLE_BMI2
+  const string select = "broadword (HFT_DISABLE_BMI2)";
+#else
+  const string select = native_pdep ? "pdep (compile time)" : string(cpu::name(cpu::Selection));
+#endif
+  printf("selected: popcount=%s select64=%s strides=%s\n\n",
+         native_popcnt ? "popcnt (compile time)" : host.Popcnt ? "popcnt" : "builtin",
+         select.c_str(), cpu::name(cpu::Kernels));
+
+  mt19937_64 mte(42);
+  vector<uint64_t> words(1 << 16);
+  for (uint64_t &word : words)
+    word = mte() | 1;
+  const size_t mask = words.size() - 1;
+
+  printf("%-12s %-12s   %11s\n", "kernel", "variant", "time/op");
+
+  row("popcount", "builtin", false, nsPerOp(ops, [&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < ops; i++)
+          sum += __builtin_popcountll(words[i & mask] ^ sum);
+        return sum;
+      }));
+  row("popcount", "dispatched", true, nsPerOp(ops, [&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < ops; i++)
+          sum += popcount(words[i & mask] ^ sum);
+        return sum;
+      }));
+
+  // every select depends on the previous one, to time the latency
+  row("select64", "broadword", cpu::Selection == cpu::BROADWORD, nsPerOp(ops, [&] {
+        uint64_t pos = 0;
+        for (size_t i = 0; i < ops; i++)
+          pos = select64_broadword(words[(i + pos) & mask], 0);
+        return pos;
+      }));
+  if (host.Bmi2) {
+    row("select64", "pdep", cpu::Selection == cpu::PDEP, nsPerOp(ops, [&] {
+          uint64_t pos = 0;
+          for (size_t i = 0; i < ops; i++)
+            pos = select64_pdep(words[(i + pos) & mask], 0);
+          return pos;
+        }));
+  }
+  row("select64", "dispatched", true, nsPerOp(ops, [&] {
+        uint64_t pos = 0;
+        for (size_t i = 0; i < ops; i++)
+          pos = select64(words[(i + pos) & mask], 0);
+        return pos;
+      }));
+
+  for (size_t stride : {8, 16, 64, 256}) {
+    // the number of blocks is a power of two
+    const size_t blocks = words.size() / stride, scans = ops / stride + 1;
+    const string kernel = "stride" + to_string(stride);
+    cpu::Simd picked = cpu::SCALAR;
+    if (cpu::Kernels == cpu::AVX512 && stride >= simd::AVX512_WORDS)
+      picked = cpu::AVX512;
+    else if (cpu::Kernels == cpu::AVX2 && stride >= simd::AVX2_WORDS)
+      picked = cpu::AVX2;
+
+    row(kernel, "scalar", picked == cpu::SCALAR, nsPerOp(scans, [&] {
+          uint64_t sum = 0;
+          for (size_t i = 0; i < scans; i++)
+            sum += simd::popcount_scalar(&words[((i + sum) & (blocks - 1)) * stride], stride, 0);
+          return sum;
+        }));
+    if (host.Avx2) {
+      row(kernel, "avx2", picked == cpu::AVX2, nsPerOp(scans, [&] {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < scans; i++)
+              sum += simd::popcount_avx2(&words[((i + sum) & (blocks - 1)) * stride], stride, 0);
+            return sum;
+          }));
+    }
+    if (host.Avx512Popcnt) {
+      row(kernel, "avx512", picked == cpu::AVX512, nsPerOp(scans, [&] {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < scans; i++)
+              sum += simd::popcount_avx512(&words[((i + sum) & (blocks - 1)) * stride], stride, 0);
+            return sum;
+          }));
+    }
+  }
+
+  // end to end, with whatever was selected
+  ranking::Word<fenwick::ByteL> word(words.data(), words.size());
+  ranking::Stride<fenwick::ByteL, 16> stride(words.data(), words.size());
+  const uint64_t ones = word.rank(words.size() * 64);
+
+  row("select", "word", true, nsPerOp(ops, [&] {
+        uint64_t pos = 0;
+        for (size_t i = 0; i < ops; i++)
+          pos = word.select((i * 0x9E3779B97F4A7C15ULL + pos) % ones);
+        return pos;
+      }));
+  row("select", "stride16", true, nsPerOp(ops, [&] {
+        uint64_t pos = 0;
+        for (size_t i = 0; i < ops; i++)
+          pos = stride.select((i * 0x9E3779B97F4A7C15ULL + pos) % ones);
+        return pos;
+      }));
+
+  return 0;
+}
@@ -0,0 +1,213 @@
+#ifndef __BENCHMARK_LATENCY_HPP__
+#define __BENCHMARK_LATENCY_HPP__
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+#include <fenwick/fixedf.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * class Clock - Cycle-accurate timer for a single operation.
+ *
+ * On x86 the time stamp counter is read with rdtscp, which waits for the previous instructions to
+ * complete, followed by an lfence, which keeps the following ones from starting early. The
+ * constructor calibrates the length of a tick against the steady clock and the overhead of a pair
+ * of readings, which ns() subtracts. Elsewhere ticks are nanoseconds of the steady clock.
+ *
+ */
+class Clock {
+private:
+  double NsPerTick = 1;
+  uint64_t Overhead = 0;
+
+public:
+  Clock() {
+    using namespace std::chrono;
+
+    const auto begin = steady_clock::now();
+    const uint64_t first = ticks();
+    while (steady_clock::now() - begin < milliseconds(50))
+      ;
+    const uint64_t last = ticks();
+    const auto end = steady_clock::now();
+    NsPerTick = duration_cast<nanoseconds>(end - begin).count() / (double)(last - first);
+
+    Overhead = UINT64_MAX;
+    for (int i = 0; i < 1000; i++) {
+      const uint64_t a = ticks();
+      const uint64_t b = ticks();
+      Overhead = std::min(Overhead, b - a);
+    }
+  }
+
+  static uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned aux;
+    const uint64_t ticks = __rdtscp(&aux);
+    _mm_lfence();
+    return ticks;
+#else
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+  }
+
+  /**
+   * ns() - Nanoseconds elapsed between two readings, net of the overhead of the readings.
+   *
+   */
+  double ns(uint64_t begin, uint64_t end) const {
+    const uint64_t elapsed = end - begin;
+    return (elapsed > Overhead ? elapsed - Overhead : 0) * NsPerTick;
+  }
+};
+
+/**
+ * class Histogram - Log-bucketed histogram of latencies.
+ *
+ * Values below 2^SUBBITS have a bucket each, every following power of two is split in 2^SUBBITS
+ * buckets of the same width, so that the relative error is bounded by 2^-SUBBITS (about 3%) over
+ * the whole 64-bit range. The counts are kept in a FixedF: recording a value and looking up a
+ * percentile (a find on the cumulative counts) both take logarithmic time in the number of
+ * buckets.
+ *
+ */
+class Histogram {
+public:
+  static constexpr unsigned SUBBITS = 5;
+  static constexpr uint64_t SUB = 1ULL << SUBBITS;
+  static constexpr size_t BUCKETS = (64 - SUBBITS + 1) * SUB;
+
+private:
+  // the bound is nominal: FixedF nodes are 64-bit words anyway
+  hft::fenwick::FixedF<(1ULL << 48)> Counts;
+  uint64_t Total = 0, Max = 0;
+
+  static hft::fenwick::FixedF<(1ULL << 48)> zeroes() {
+    std::vector<uint64_t> zeroes(BUCKETS);
+    return hft::fenwick::FixedF<(1ULL << 48)>(zeroes.data(), BUCKETS);
+  }
+
+public:
+  Histogram() : Counts(zeroes()) {}
+
+  static size_t bucket(uint64_t value) {
+    if (value < SUB)
+      return value;
+
+    const unsigned exp = 63 - __builtin_clzll(value);
+    return (exp - SUBBITS + 1) * SUB + ((value >> (exp - SUBBITS)) & (SUB - 1));
+  }
+
+  /**
+   * lowest() - Smallest value falling in a bucket.
+   *
+   */
+  static uint64_t lowest(size_t bucket) {
+    if (bucket < SUB)
+      return bucket;
+
+    const unsigned exp = bucket / SUB + SUBBITS - 1;
+    return (SUB + bucket % SUB) << (exp - SUBBITS);
+  }
+
+  /**
+   * highest() - Largest value falling in a bucket.
+   *
+   */
+  static uint64_t highest(size_t bucket) {
+    return bucket + 1 < BUCKETS ? lowest(bucket + 1) - 1 : UINT64_MAX;
+  }
+
+  void record(uint64_t value, uint64_t count = 1) {
+    Counts.add(bucket(value) + 1, count);
+    Total += count;
+    Max = std::max(Max, value);
+  }
+
+  uint64_t count(size_t bucket) const { return Counts.prefix(bucket + 1) - Counts.prefix(bucket); }
+
+  uint64_t total() const { return Total; }
+
+  uint64_t max() const { return Max; }
+
+  /**
+   * percentile() - Highest value equivalent (i.e. in the same bucket) to the @p-th quantile.
+   * @p: Quantile, in [0, 1].
+   *
+   */
+  uint64_t percentile(double p) const {
+    if (Total == 0)
+      return 0;
+
+    const uint64_t rank = std::clamp<uint64_t>(std::ceil(p * Total), 1, Total);
+    return std::min(highest(Counts.find(rank - 1)), Max);
+  }
+
+  Histogram &operator+=(const Histogram &oth) {
+    for (size_t b = 0; b < BUCKETS; b++) {
+      const uint64_t c = oth.count(b);
+      if (c != 0)
+        Counts.add(b + 1, c);
+    }
+
+    Total += oth.Total;
+    Max = std::max(Max, oth.Max);
+    return *this;
+  }
+};
+
+/**
+ * class LatencyFile - Percentiles and buckets of the latency histograms of an operation.
+ *
+ * "<name>.csv" has a row "Elements,Tree,p50,p90,p99,p999,max" (in nanoseconds) per histogram,
+ * "<name>_hist.csv" a row "Elements,Tree,Low,Count,Max" per non-empty bucket, Max being the largest
+ * value of the whole histogram: histograms of different runs can be merged by summing the counts of
+ * the same bucket and taking the largest Max (see utils/histmerge.py).
+ *
+ */
+class LatencyFile {
+private:
+  std::ofstream Percentiles, Buckets;
+
+  static void open(std::ofstream &file, const std::string &filename, const char *header) {
+    struct stat buffer;
+    const bool exists = stat(filename.c_str(), &buffer) == 0;
+
+    file.open(filename, std::ios::out | std::ios::app);
+    if (!exists)
+      file << header << std::endl;
+  }
+
+public:
+  void open(const std::string &name) {
+    open(Percentiles, name + ".csv", "Elements,Tree,p50,p90,p99,p999,max");
+    open(Buckets, name + "_hist.csv", "Elements,Tree,Low,Count,Max");
+  }
+
+  void write(size_t size, const std::string &tree, const Histogram &hist) {
+    Percentiles << size << "," << tree << "," << hist.percentile(.5) << ","
+                << hist.percentile(.9) << "," << hist.percentile(.99) << ","
+                << hist.percentile(.999) << "," << hist.max() << std::endl;
+
+    for (size_t b = 0; b < Histogram::BUCKETS; b++) {
+      const uint64_t count = hist.count(b);
+      if (count != 0)
+        Buckets << size << "," << tree << "," << Histogram::lowest(b) << "," << count << ","
+                << hist.max() << "\n";
+    }
+    Buckets.flush();
+  }
+};
+
+#endif // __BENCHMARK_LATENCY_HPP__
@@ -0,0 +1,195 @@
+#ifndef __BENCHMARK_PERF_HPP__
+#define __BENCHMARK_PERF_HPP__
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <linux/perf_event.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace perf {
+
+struct Event {
+  const char *Name;
+  uint32_t Type;
+  uint64_t Config;
+};
+
+constexpr uint64_t cache(uint64_t id, uint64_t op, uint64_t result) {
+  return id | (op << 8) | (result << 16);
+}
+
+inline constexpr Event EVENTS[] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"l1dmiss", PERF_TYPE_HW_CACHE,
+     cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"llcmiss", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"dtlbmiss", PERF_TYPE_HW_CACHE,
+     cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"branchmiss", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"taskclock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    {"pagefaults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+
+} // namespace perf
+
+/**
+ * class Perf - Hardware performance counters around a measured loop.
+ *
+ * Every event is opened on its own (not as a group) through perf_event_open(2), counting only the
+ * user space of the calling thread, so that it also works with perf_event_paranoid = 2. When the
+ * PMU is overcommitted the kernel multiplexes the events: counts are scaled by the ratio between
+ * the enabled and the running time.
+ *
+ * Events that cannot be opened (no PMU in a VM, seccomp in a container, paranoid = 3, ...) are
+ * simply unavailable and reported as empty CSV fields. Software events (task clock and page
+ * faults) are usually still available when hardware events are not, so the harness always has at
+ * least the wall-clock time and the software counters to fall back on.
+ *
+ */
+class Perf {
+public:
+  static constexpr size_t EVENTS = std::size(perf::EVENTS);
+
+private:
+  int Fd[EVENTS];
+  double Count[EVENTS] = {};
+
+public:
+  Perf() {
+    for (size_t i = 0; i < EVENTS; i++) {
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = perf::EVENTS[i].Type;
+      attr.config = perf::EVENTS[i].Config;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      Fd[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+  }
+
+  ~Perf() {
+    for (size_t i = 0; i < EVENTS; i++)
+      if (Fd[i] >= 0)
+        close(Fd[i]);
+  }
+
+  Perf(const Perf &) = delete;
+  Perf &operator=(const Perf &) = delete;
+
+  /**
+   * available() - Whether at least one hardware event can be counted.
+   *
+   */
+  bool available() const {
+    for (size_t i = 0; i < EVENTS; i++)
+      if (Fd[i] >= 0 && perf::EVENTS[i].Type != PERF_TYPE_SOFTWARE)
+        return true;
+
+    return false;
+  }
+
+  /**
+   * start() - Reset and start every counter.
+   *
+   */
+  void start() {
+    for (size_t i = 0; i < EVENTS; i++) {
+      if (Fd[i] >= 0) {
+        ioctl(Fd[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(Fd[i], PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  }
+
+  /**
+   * stop() - Stop every counter and add its (scaled) value to the accumulated counts.
+   *
+   */
+  void stop() {
+    for (size_t i = 0; i < EVENTS; i++) {
+      if (Fd[i] < 0)
+        continue;
+
+      ioctl(Fd[i], PERF_EVENT_IOC_DISABLE, 0);
+
+      uint64_t value[3];
+      if (read(Fd[i], value, sizeof(value)) == sizeof(value) && value[2] != 0)
+        Count[i] += value[0] * ((double)value[1] / value[2]);
+    }
+  }
+
+  /**
+   * clear() - Zero the accumulated counts.
+   *
+   */
+  void clear() {
+    for (size_t i = 0; i < EVENTS; i++)
+      Count[i] = 0;
+  }
+
+  /**
+   * header() - CSV header with the names of the events.
+   *
+   */
+  static std::string header() {
+    std::string header;
+    for (size_t i = 0; i < EVENTS; i++)
+      header += std::string(i ? "," : "") + perf::EVENTS[i].Name;
+
+    return header;
+  }
+
+  /**
+   * csv() - Accumulated counts divided by @items, as CSV fields (empty if unavailable).
+   * @items: Number of measured items (e.g. repetitions times queries).
+   *
+   */
+  std::string csv(double items) const {
+    std::string row;
+    for (size_t i = 0; i < EVENTS; i++)
+      row += std::string(i ? "," : "") + (Fd[i] >= 0 ? std::to_string(Count[i] / items) : "");
+
+    return row;
+  }
+};
+
+/**
+ * class PerfFile - Long-format CSV file of the counters of an operation.
+ *
+ * Rows have the form "Elements,Tree,<events...>". The file is appended to, and the header is only
+ * written when it is created.
+ *
+ */
+class PerfFile {
+private:
+  std::ofstream File;
+
+public:
+  PerfFile() = default;
+
+  void open(const std::string &filename) {
+    struct stat buffer;
+    const bool exists = stat(filename.c_str(), &buffer) == 0;
+
+    File.open(filename, std::ios::out | std::ios::app);
+    if (!exists)
+      File << "Elements,Tree," << Perf::header() << std::endl;
+  }
+
+  void write(size_t size, const std::string &tree, const Perf &perf, double items) {
+    File << size << "," << tree << "," << perf.csv(items) << std::endl;
+  }
+};
+
+#endif // __BENCHMARK_PERF_HPP__
@@ -0,0 +1,98 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <rankselect/line.hpp>
+#include <rankselect/stride.hpp>
+#include <rankselect/word.hpp>
+
+#include <fenwick/bytel.hpp>
+
+using namespace std;
+using namespace hft;
+using namespace hft::fenwick;
+using namespace hft::ranking;
+
+// defeats dead code elimination
+static volatile uint64_t Sink;
+
+template <typename F> double nsPerBit(size_t bits, F &&run) {
+  const auto begin = chrono::high_resolution_clock::now();
+  Sink = run();
+  const auto end = chrono::high_resolution_clock::now();
+  return chrono::duration_cast<chrono::nanoseconds>(end - begin).count() / (double)bits;
+}
+
+// every 1-bit (and 0-bit) enumerated by the ranges, by nextOne() and by select()
+template <typename T> void bench(const char *name, const char *density, vector<uint64_t> &words) {
+  T bv(words.data(), words.size());
+  const uint64_t ones = bv.rank(words.size() * 64), zeroes = words.size() * 64 - ones;
+
+  const double range = nsPerBit(ones, [&] {
+    uint64_t u = 0;
+    for (size_t pos : bv.onesFrom(0))
+      u += pos;
+    return u;
+  });
+  const double down = nsPerBit(ones, [&] {
+    uint64_t u = 0;
+    for (size_t pos : bv.onesDownFrom(words.size() * 64 - 1))
+      u += pos;
+    return u;
+  });
+  const double next = nsPerBit(ones, [&] {
+    uint64_t u = 0;
+    for (size_t pos = bv.nextOne(0); pos != SIZE_MAX; pos = bv.nextOne(pos + 1))
+      u += pos;
+    return u;
+  });
+  const double select = nsPerBit(ones, [&] {
+    uint64_t u = 0;
+    for (uint64_t i = 0; i < ones; i++)
+      u += bv.select(i);
+    return u;
+  });
+  const double zeroRange = nsPerBit(zeroes, [&] {
+    uint64_t u = 0;
+    for (size_t pos : bv.zerosFrom(0))
+      u += pos;
+    return u;
+  });
+  const double zeroSelect = nsPerBit(zeroes, [&] {
+    uint64_t u = 0;
+    for (uint64_t i = 0; i < zeroes; i++)
+      u += bv.selectZero(i);
+    return u;
+  });
+
+  printf("%-10s %-8s %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n", name, density, range, down, next,
+         select, zeroRange, zeroSelect);
+}
+
+int main(int argc, char *argv[]) {
+  const size_t size = argc > 1 ? stoul(argv[1]) : 1 << 22;
+
+  printf("ns per enumerated bit on %zu words\n", size);
+  printf("%-10s %-8s %9s %9s %9s %9s %9s %9s\n", "structure", "density", "onesFrom", "down",
+         "nextOne", "select", "zerosFrom", "selZero");
+
+  mt19937_64 mte(42);
+  vector<uint64_t> words(size);
+  // 1-bits out of 4096
+  for (size_t ones : {4, 40, 410, 2048, 3686, 4092}) {
+    for (uint64_t &word : words) {
+      word = 0;
+      for (size_t j = 0; j < 64; j++)
+        word |= uint64_t(mte() % 4096 < ones) << j;
+    }
+
+    const string density = to_string(ones * 100 / 4096.).substr(0, 4) + "%";
+    bench<Word<ByteL>>("word", density.c_str(), words);
+    bench<Stride<ByteL, 16>>("stride16", density.c_str(), words);
+    bench<Line<ByteL>>("line", density.c_str(), words);
+  }
+
+  return 0;
+}
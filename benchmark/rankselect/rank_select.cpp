@@ -4,6 +4,7 @@
 #include <iomanip>
 #include <random>
 
+#include <rankselect/line.hpp>
 #include <rankselect/rank_select.hpp>
 #include <rankselect/stride.hpp>
 #include <rankselect/word.hpp>
@@ -75,6 +76,12 @@ int main(int argc, char *argv[]) {
   internal<Word<BitF>>("Bit[F]1", bv, rank, select0, select1, bit, size, queries, re);
   internal<Word<BitL>>("Bit[L]1", bv, rank, select0, select1, bit, size, queries, re);
   cout << "\n------------------------------\n";
+  internal<Line<FixedF>>("Line Fixed[F]", bv, rank, select0, select1, bit, size, queries, re);
+  internal<Line<ByteF>>("Line Byte[F]", bv, rank, select0, select1, bit, size, queries, re);
+  internal<Line<ByteL>>("Line Byte[L]", bv, rank, select0, select1, bit, size, queries, re);
+  internal<Line<BitF>>("Line Bit[F]", bv, rank, select0, select1, bit, size, queries, re);
+  internal<Line<BitL>>("Line Bit[L]", bv, rank, select0, select1, bit, size, queries, re);
+  cout << "\n------------------------------\n";
   internal<Stride<FixedF, 8>>("Fixed[F]8", bv, rank, select0, select1, bit, size, queries, re);
   internal<Stride<FixedL, 8>>("Fixed[L]8", bv, rank, select0, select1, bit, size, queries, re);
   internal<Stride<ByteL, 8>>("Byte[L]8", bv, rank, select0, select1, bit, size, queries, re);
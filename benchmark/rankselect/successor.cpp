@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <rankselect/counted.hpp>
+#include <rankselect/stride.hpp>
+#include <rankselect/word.hpp>
+
+#include <fenwick/bytel.hpp>
+
+using namespace std;
+using namespace hft;
+using namespace hft::fenwick;
+using namespace hft::ranking;
+
+// defeats dead code elimination
+static volatile uint64_t Sink;
+
+template <typename F> double nsPerOp(size_t ops, F &&run) {
+  const auto begin = chrono::high_resolution_clock::now();
+  Sink = run();
+  const auto end = chrono::high_resolution_clock::now();
+  return chrono::duration_cast<chrono::nanoseconds>(end - begin).count() / (double)ops;
+}
+
+// native nextOne/prevOne/nextZero against select(rank(pos)) and friends, every query depends on
+// the previous one
+template <typename T>
+void bench(const char *name, const char *density, vector<uint64_t> &words, size_t ops) {
+  T bv(words.data(), words.size());
+  const RankSelect &base = bv;
+  const size_t size = words.size() * 64;
+  auto pos = [&](size_t i, uint64_t u) { return (i * 0x9E3779B97F4A7C15ULL + (u & 1)) % size; };
+
+  const double next = nsPerOp(ops, [&] {
+    uint64_t u = 0;
+    for (size_t i = 0; i < ops; i++)
+      u ^= bv.nextOne(pos(i, u));
+    return u;
+  });
+  const double nextRank = nsPerOp(ops, [&] {
+    uint64_t u = 0;
+    for (size_t i = 0; i < ops; i++)
+      u ^= base.RankSelect::nextOne(pos(i, u));
+    return u;
+  });
+  const double prev = nsPerOp(ops, [&] {
+    uint64_t u = 0;
+    for (size_t i = 0; i < ops; i++)
+      u ^= bv.prevOne(pos(i, u));
+    return u;
+  });
+  const double prevRank = nsPerOp(ops, [&] {
+    uint64_t u = 0;
+    for (size_t i = 0; i < ops; i++)
+      u ^= base.RankSelect::prevOne(pos(i, u));
+    return u;
+  });
+  const double zero = nsPerOp(ops, [&] {
+    uint64_t u = 0;
+    for (size_t i = 0; i < ops; i++)
+      u ^= bv.nextZero(pos(i, u));
+    return u;
+  });
+  const double zeroRank = nsPerOp(ops, [&] {
+    uint64_t u = 0;
+    for (size_t i = 0; i < ops; i++)
+      u ^= base.RankSelect::nextZero(pos(i, u));
+    return u;
+  });
+
+  printf("%-14s %-8s %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n", name, density, next, nextRank, prev,
+         prevRank, zero, zeroRank);
+}
+
+int main(int argc, char *argv[]) {
+  const size_t size = argc > 1 ? stoul(argv[1]) : 1 << 22;
+  const size_t ops = argc > 2 ? stoul(argv[2]) : 1000000;
+
+  printf("ns per query on %zu words (rank+select: the same query through select(rank(pos)))\n",
+         size);
+  printf("%-14s %-8s %9s %9s %9s %9s %9s %9s\n", "structure", "density", "nextOne", "rank+sel",
+         "prevOne", "rank+sel", "nextZero", "rank+sel");
+
+  mt19937_64 mte(42);
+  vector<uint64_t> words(size);
+  // 1-bits out of 4096
+  for (size_t ones : {4, 40, 410, 2048, 3686, 4092}) {
+    for (uint64_t &word : words) {
+      word = 0;
+      for (size_t j = 0; j < 64; j++)
+        word |= uint64_t(mte() % 4096 < ones) << j;
+    }
+
+    const string density = to_string(ones * 100 / 4096.).substr(0, 4) + "%";
+    bench<Word<ByteL>>("word", density.c_str(), words, ops);
+    bench<Stride<ByteL, 16>>("stride16", density.c_str(), words, ops);
+    bench<Counted<ByteL, 64>>("counted64", density.c_str(), words, ops);
+  }
+
+  return 0;
+}
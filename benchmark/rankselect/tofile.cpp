@@ -5,10 +5,14 @@
 #include <fstream>
 #include <string>
 #include <memory>
+#include <sstream>
 
 #include <rankselect/rank_select.hpp>
 #include <rankselect/word.hpp>
 #include <rankselect/stride.hpp>
+#include <rankselect/line.hpp>
+#include <rankselect/counted.hpp>
+#include <rankselect/hinted.hpp>
 
 #include <fenwick/bitf.hpp>
 #include <fenwick/bytef.hpp>
@@ -23,6 +27,11 @@
 
 #include <dynamic.hpp>
 
+#include "../latency.hpp"
+#include "../perf.hpp"
+#include "../results.hpp"
+#include "../workload.hpp"
+
 using namespace std;
 using namespace hft;
 using namespace hft::fenwick;
@@ -36,7 +45,7 @@ template <size_t N> using Fixed26Bit = Hybrid<FixedL, BitF, N, 26>;
 
 class Benchmark {
 private:
-    string path;
+    string path, dist;
     size_t size, queries;
 
     uint64_t ones = 0, zeroes = 0;
@@ -46,11 +55,37 @@ private:
     uniform_int_distribution<uint64_t> bvdist, sel0dist, sel1dist;
     uniform_int_distribution<size_t> idxdist, bitdist;
 
+    // arguments of the queries (drawn from the chosen distribution) and YCSB operation streams
+    static constexpr char YCSB[] = "abcdef";
+    vector<uint64_t> rankkeys, selkeys, bitkeys;
+    vector<size_t> rankpos; // rankkeys as positions, for the batches
+    vector<workload::Operation> streams[6];
+    ofstream fycsb[6];
+
     ofstream fbuild, frank0, frank1, fselect0, fselect1, fupdate, fbitspace;
+    ofstream frank1batch, fselect1batch;
+    // selects with a toggle every UPDATES[k] of them (none if zero)
+    static constexpr size_t UPDATES[] = {0, 100, 10};
+    ofstream fselect1upd[3];
+    ofstream fmempayload, fmemholes, fmempages, fmemmetadata, fmemresident;
+
+    // hardware counters, one long-format file per operation
+    Perf perf;
+    PerfFile prank1, pselect1, pupdate;
+
+    // latency distribution of single operations
+    Clock clock;
+    LatencyFile lrank1, lselect1, lupdate;
+    vector<string> trees;
+    size_t column = 0;
+
+    // every repetition of every measure, with the metadata of the run
+    results::Json results;
 
 public:
-    Benchmark(string path, size_t size, size_t queries) :
+    Benchmark(string path, size_t size, size_t queries, string dist) :
         path(path),
+        dist(dist),
         size(size),
         queries(queries) {}
 
@@ -60,8 +95,34 @@ public:
         finit(frank1,    "rank1.csv",    "Elements," + order);
         finit(fselect0,  "select0.csv",  "Elements," + order);
         finit(fselect1,  "select1.csv",  "Elements," + order);
+        finit(frank1batch,   "rank1batch.csv",   "Elements," + order);
+        finit(fselect1batch, "select1batch.csv", "Elements," + order);
         finit(fupdate,   "update.csv",   "Elements," + order);
         finit(fbitspace, "bitspace.csv", "Elements," + order);
+        finit(fmempayload,  "mempayload.csv",  "Elements," + order);
+        finit(fmemholes,    "memholes.csv",    "Elements," + order);
+        finit(fmempages,    "mempages.csv",    "Elements," + order);
+        finit(fmemmetadata, "memmetadata.csv", "Elements," + order);
+        finit(fmemresident, "memresident.csv", "Elements," + order);
+        for (int w = 0; w < 6; w++)
+            finit(fycsb[w], string("ycsb_") + YCSB[w] + ".csv", "Elements," + order);
+        for (int k = 0; k < 3; k++)
+            finit(fselect1upd[k], "select1upd" + rate(k) + ".csv", "Elements," + order);
+
+        prank1.open(path + "perf_rank1.csv");
+        pselect1.open(path + "perf_select1.csv");
+        pupdate.open(path + "perf_update.csv");
+
+        lrank1.open(path + "latency_rank1");
+        lselect1.open(path + "latency_select1");
+        lupdate.open(path + "latency_update");
+
+        istringstream names(order);
+        for (string name; getline(names, name, ',');)
+            trees.push_back(name);
+
+        if (!perf.available())
+            cout << "Hardware performance counters unavailable: software events only" << endl;
     }
 
     void separator(string sep = ",") {
@@ -70,8 +131,20 @@ public:
         frank1 << sep;
         fselect0 << sep;
         fselect1 << sep;
+        frank1batch << sep;
+        fselect1batch << sep;
         fupdate << sep;
         fbitspace << sep;
+        fmempayload << sep;
+        fmemholes << sep;
+        fmempages << sep;
+        fmemmetadata << sep;
+        fmemresident << sep;
+        for (ofstream &f : fycsb)
+            f << sep;
+        for (ofstream &f : fselect1upd)
+            f << sep;
+        column++;
     }
 
     void datainit(mt19937 &engine) {
@@ -89,6 +162,21 @@ public:
 
         sel0dist = uniform_int_distribution<uint64_t>(0, zeroes-1);
         sel1dist = uniform_int_distribution<uint64_t>(0, ones-1);
+
+        // keys are in [1, n]: ranks and updates go over the whole bit vector
+        mt19937_64 re(mte());
+        rankkeys = workload::keys(*workload::make(dist, size*64, re), queries, re);
+        selkeys = workload::keys(*workload::make(dist, ones, re), queries, re);
+        bitkeys = workload::keys(*workload::make(dist, size*64, re), queries, re);
+
+        rankpos.resize(queries);
+        for (size_t i = 0; i < queries; i++)
+            rankpos[i] = rankkeys[i] - 1;
+        for (uint64_t &key : selkeys)
+            key--;
+
+        for (int w = 0; w < 6; w++)
+            streams[w] = workload::stream(workload::ycsb(YCSB[w]), size*64, queries, re);
     }
 
     template<typename T>
@@ -103,53 +191,146 @@ public:
         end = high_resolution_clock::now();
         auto build = duration_cast<chrono::nanoseconds>(end-begin).count();
         fbuild << to_string(build / (double)size);
+        results.add(config("build"), {build / (double)size});
 
         constexpr int REPS = 5;
         constexpr size_t MID = 2; // index of the median of a REPS elements sorted vector
 
         cout << "rank1: " << flush;
         vector<chrono::nanoseconds::rep> rank1;
+        perf.clear();
         for (int r = 0; r < REPS; r++) {
             cout << r << " " << flush;
+            perf.start();
             begin = high_resolution_clock::now();
             for(uint64_t i = 0; i < queries; ++i)
-                u ^= bv.rank(idxdist(mte) ^ (u & 1));
+                u ^= bv.rank((rankkeys[i] - 1) ^ (u & 1));
             end = high_resolution_clock::now();
+            perf.stop();
             rank1.push_back(duration_cast<chrono::nanoseconds>(end-begin).count());
         }
+        result("rank1", rank1);
         std::sort(rank1.begin(), rank1.end());
         frank1 << to_string(rank1[MID] * c);
+        prank1.write(size*64, trees[column], perf, REPS * (double)queries);
 
         cout << "select1: " << flush;
         vector<chrono::nanoseconds::rep> select1;
+        perf.clear();
         for (int r = 0; r < REPS; r++) {
             cout << r << " " << flush;
+            perf.start();
             begin = high_resolution_clock::now();
             for(uint64_t i = 0; i < queries; ++i)
-                u ^= bv.select(sel1dist(mte) ^ (u & 1));
+                u ^= bv.select(selkeys[i] ^ (u & 1));
             end = high_resolution_clock::now();
+            perf.stop();
             select1.push_back(duration_cast<chrono::nanoseconds>(end-begin).count());
         }
+        result("select1", select1);
         std::sort(select1.begin(), select1.end());
         fselect1 << to_string(select1[MID] * c);
+        pselect1.write(size*64, trees[column], perf, REPS * (double)queries);
+
+        // independent queries in batches, as a columnar engine issues them
+        constexpr size_t BATCH = 1024;
+        vector<uint64_t> ranked(BATCH);
+        vector<size_t> selected(BATCH);
+
+        cout << "rank1batch: " << flush;
+        vector<chrono::nanoseconds::rep> rank1batch;
+        for (int r = 0; r < REPS; r++) {
+            cout << r << " " << flush;
+            begin = high_resolution_clock::now();
+            for (uint64_t i = 0; i < queries; i += BATCH) {
+                bv.rank(&rankpos[i], ranked.data(), min(BATCH, queries - i));
+                u ^= ranked[0];
+            }
+            end = high_resolution_clock::now();
+            rank1batch.push_back(duration_cast<chrono::nanoseconds>(end-begin).count());
+        }
+        result("rank1batch", rank1batch);
+        std::sort(rank1batch.begin(), rank1batch.end());
+        frank1batch << to_string(rank1batch[MID] * c);
+
+        cout << "select1batch: " << flush;
+        vector<chrono::nanoseconds::rep> select1batch;
+        for (int r = 0; r < REPS; r++) {
+            cout << r << " " << flush;
+            begin = high_resolution_clock::now();
+            for (uint64_t i = 0; i < queries; i += BATCH) {
+                bv.select(&selkeys[i], selected.data(), min(BATCH, queries - i));
+                u ^= selected[0];
+            }
+            end = high_resolution_clock::now();
+            select1batch.push_back(duration_cast<chrono::nanoseconds>(end-begin).count());
+        }
+        result("select1batch", select1batch);
+        std::sort(select1batch.begin(), select1batch.end());
+        fselect1batch << to_string(select1batch[MID] * c);
 
         cout << "update: " << flush;
         vector<chrono::nanoseconds::rep> update;
+        perf.clear();
         for (int r = 0; r < REPS; r++) {
             cout << r << " " << flush;
+            perf.start();
             begin = high_resolution_clock::now();
             for(uint64_t i = 0; i < queries; ++i) {
-                if (i & 1) u ^= bv.set(bitdist(mte) ^ (u & 1));
-                else u ^= bv.clear(bitdist(mte) ^ (u & 1));
+                if (i & 1) u ^= bv.set((bitkeys[i] - 1) ^ (u & 1));
+                else u ^= bv.clear((bitkeys[i] - 1) ^ (u & 1));
             }
             end = high_resolution_clock::now();
+            perf.stop();
             update.push_back(duration_cast<chrono::nanoseconds>(end-begin).count());
         }
+        result("update", update);
         std::sort(update.begin(), update.end());
         fupdate << to_string(update[MID] * c);
+        pupdate.write(size*64, trees[column], perf, REPS * (double)queries);
+
+        cout << "ycsb: " << flush;
+        for (int w = 0; w < 6; w++) {
+            cout << YCSB[w] << " " << flush;
+            vector<chrono::nanoseconds::rep> mixed;
+            for (int r = 0; r < REPS; r++) {
+                begin = high_resolution_clock::now();
+                u ^= mix(bv, streams[w]);
+                end = high_resolution_clock::now();
+                mixed.push_back(duration_cast<chrono::nanoseconds>(end-begin).count());
+            }
+            result(string("ycsb_") + YCSB[w], mixed);
+            std::sort(mixed.begin(), mixed.end());
+            fycsb[w] << to_string(mixed[MID] * c);
+        }
+
+        cout << "select1upd: " << flush;
+        for (int k = 0; k < 3; k++) {
+            cout << rate(k) << "% " << flush;
+            vector<chrono::nanoseconds::rep> mixed;
+            for (int r = 0; r < REPS; r++) {
+                begin = high_resolution_clock::now();
+                for (uint64_t i = 0; i < queries; ++i) {
+                    if (UPDATES[k] && i % UPDATES[k] == 0)
+                        u ^= bv.toggle((bitkeys[i] - 1) ^ (u & 1));
+                    u ^= bv.select(selkeys[i] ^ (u & 1));
+                }
+                end = high_resolution_clock::now();
+                mixed.push_back(duration_cast<chrono::nanoseconds>(end-begin).count());
+            }
+            result("select1upd" + rate(k), mixed);
+            std::sort(mixed.begin(), mixed.end());
+            fselect1upd[k] << to_string(mixed[MID] * c);
+        }
+
+        cout << "latency... " << flush;
+        u ^= sample(lrank1, [&](uint64_t i) { return bv.rank(rankkeys[i] - 1); });
+        u ^= sample(lselect1, [&](uint64_t i) { return bv.select(selkeys[i]); });
+        u ^= sample(lupdate, [&](uint64_t i) { return bv.toggle(bitkeys[i] - 1); });
 
         cout << "bitspace... " << flush;
         fbitspace << to_string(bv.bitCount() / (size * 64.));
+        memory(bv.memoryReport());
         cout << "done.  " << endl;
 
         const volatile uint64_t __attribute__((unused)) unused = u;
@@ -171,59 +352,147 @@ public:
         end = high_resolution_clock::now();
         auto build = duration_cast<chrono::nanoseconds>(end-begin).count();
         fbuild << to_string(build / (double)size);
+        results.add(config("build"), {build / (double)size});
 
         constexpr int REPS = 5;
         constexpr size_t MID = 2; // index of the median of a REPS elements sorted vector
 
         cout << "rank1: " << flush;
         vector<chrono::nanoseconds::rep> rank1;
+        perf.clear();
         for (int r = 0; r < REPS; r++) {
             cout << r << " " << flush;
+            perf.start();
             begin = high_resolution_clock::now();
             for(uint64_t i = 0; i < queries; ++i)
                 u ^= dynamic.rank1(idxdist(mte) ^ (u & 1));
             end = high_resolution_clock::now();
+            perf.stop();
             rank1.push_back(duration_cast<chrono::nanoseconds>(end-begin).count());
         }
+        result("rank1", rank1);
         std::sort(rank1.begin(), rank1.end());
         frank1 << to_string(rank1[MID] * c);
+        prank1.write(size*64, trees[column], perf, REPS * (double)queries);
 
         cout << "select1: " << flush;
         vector<chrono::nanoseconds::rep> select1;
+        perf.clear();
         for (int r = 0; r < REPS; r++) {
             cout << r << " " << flush;
+            perf.start();
             begin = high_resolution_clock::now();
             for(uint64_t i = 0; i < queries; ++i)
                 u ^= dynamic.select1(sel1dist(mte) ^ (u & 1));
             end = high_resolution_clock::now();
+            perf.stop();
             select1.push_back(duration_cast<chrono::nanoseconds>(end-begin).count());
         }
+        result("select1", select1);
         std::sort(select1.begin(), select1.end());
         fselect1 << to_string(select1[MID] * c);
+        pselect1.write(size*64, trees[column], perf, REPS * (double)queries);
 
         cout << "update: " << flush;
         vector<chrono::nanoseconds::rep> update;
+        perf.clear();
         for (int r = 0; r < REPS; r++) {
             cout << r << " " << flush;
+            perf.start();
             begin = high_resolution_clock::now();
             for(uint64_t i = 0; i < queries; ++i) {
                 if (i & 1) dynamic.set(bitdist(mte)  ^ (u & 1), true);
                 else dynamic.set(bitdist(mte) ^ (u & 1), false);
             }
             end = high_resolution_clock::now();
+            perf.stop();
             update.push_back(duration_cast<chrono::nanoseconds>(end-begin).count());
         }
+        result("update", update);
         std::sort(update.begin(), update.end());
         fupdate << to_string(update[MID] * c);
+        pupdate.write(size*64, trees[column], perf, REPS * (double)queries);
 
         cout << "bitspace... " << flush;
         fbitspace << to_string(dynamic.bit_size() / (size * 64.));
+        for (ofstream &f : fycsb)
+            f << "nan";
+        for (ofstream &f : fselect1upd)
+            f << "nan";
         cout << "done.  " << endl;
 
         const volatile uint64_t __attribute__((unused)) unused = u;
     }
 
+    // results_<size>_<distribution>.json, see utils/compare.py
+    void save() {
+        results.write(path + "results_" + to_string(size*64) + "_" + dist + ".json");
+    }
+
 private:
+    results::Config config(const string &op) {
+        return {{"tree", trees[column]}, {"op", op}, {"size", to_string(size*64)}, {"dist", dist}};
+    }
+
+    // percentage of updates among the selects of fselect1upd[k]
+    static string rate(int k) { return to_string(UPDATES[k] ? 100 / UPDATES[k] : 0); }
+
+    // nanoseconds per query of every repetition
+    void result(const string &op, const vector<chrono::nanoseconds::rep> &reps) {
+        vector<double> samples;
+        for (auto ns : reps)
+            samples.push_back(ns / (double)queries);
+        results.add(config(op), samples);
+    }
+
+    // time every query on its own, with the same arguments of the loops above
+    template <typename F> uint64_t sample(LatencyFile &file, F &&op) {
+        Histogram hist;
+        uint64_t u = 0;
+        for (uint64_t i = 0; i < queries; ++i) {
+            const uint64_t begin = Clock::ticks();
+            u ^= op(i);
+            const uint64_t end = Clock::ticks();
+            hist.record(llround(clock.ns(begin, end)));
+        }
+
+        file.write(size*64, trees[column], hist);
+        return u;
+    }
+
+    // reads are ranks, updates toggle a bit and scans count the ones in a few words
+    template <typename T> uint64_t mix(T &bv, const vector<workload::Operation> &ops) {
+        uint64_t u = 0;
+        for (const workload::Operation &op : ops) {
+            const size_t pos = op.Key - 1;
+            switch (op.Kind) {
+            case workload::Op::READ:
+                u ^= bv.rank(pos);
+                break;
+            case workload::Op::SCAN:
+                u ^= bv.rank(pos, min<size_t>(pos + op.Length * 64, size * 64));
+                break;
+            case workload::Op::RMW:
+                u ^= bv.rank(pos);
+                [[fallthrough]];
+            case workload::Op::UPDATE:
+                u ^= bv.toggle(pos);
+                break;
+            }
+        }
+        return u;
+    }
+
+    // same unit of bitspace.csv: bits per bit of the bitvector
+    void memory(const hft::MemoryReport &report) {
+        const double c = 1. / (size * 64.);
+        fmempayload << to_string(report.Payload * c);
+        fmemholes << to_string(report.Holes * c);
+        fmempages << to_string(report.Pages * c);
+        fmemmetadata << to_string(report.Metadata * c);
+        fmemresident << to_string(report.Resident * c);
+    }
+
     bool is_empty(ifstream file) {
         return file.peek() == ifstream::traits_type::eof();
     }
@@ -247,18 +516,29 @@ int main(int argc, char *argv[])
     mt19937 mte(rd());
 
     size_t size, queries;
-    if (argc < 3 || !(istringstream(argv[2]) >> size) || !(istringstream(argv[3]) >> queries)) {
-        cerr << "Invalid parameters" << endl;
+    if (argc < 4 || !(istringstream(argv[2]) >> size) || !(istringstream(argv[3]) >> queries)) {
+        cerr << "Invalid parameters: <outdir> <size> <queries> [distribution]" << endl;
+        return -1;
+    }
+
+    const string dist = argc >= 5 ? argv[4] : "uniform";
+    mt19937_64 check;
+    if (!workload::make(dist, 1, check)) {
+        cerr << "Unknown distribution: " << dist << endl;
         return -1;
     }
 
-    Benchmark bench(argv[1], size, queries);
+    Benchmark bench(argv[1], size, queries, dist);
 
     bench.datainit(mte);
 
     bench.filesinit("fixed[F]1,fixed[$\\ell$]1,byte[F]1,byte[$\\ell$]1,bit[F]1,bit[$\\ell$]1,fixed[24]byte1,fixed[24]bit1,fixed[26]byte1,fixed[26]bit1,"
     "fixed[F]8,fixed[$\\ell$]8,byte[F]8,byte[$\\ell$]8,bit[F]8,bit[$\\ell$]8,fixed[24]byte8,fixed[24]bit8,fixed[26]byte8,fixed[26]bit8,"
-                    "fixed[F]16,fixed[$\\ell$]16,byte[F]16,byte[$\\ell$]16,bit[F]16,bit[$\\ell$]16,fixed[24]byte16,fixed[24]bit16,fixed[26]byte16,fixed[26]bit16");
+                    "fixed[F]16,fixed[$\\ell$]16,byte[F]16,byte[$\\ell$]16,bit[F]16,bit[$\\ell$]16,fixed[24]byte16,fixed[24]bit16,fixed[26]byte16,fixed[26]bit16,"
+                    "fixed[F]64,byte[F]64,bit[F]64,bit[$\\ell$]64,"
+                    "line fixed[F],line byte[F],line byte[$\\ell$],line bit[F],line bit[$\\ell$],"
+                    "counted fixed[F]16,counted bit[F]16,counted fixed[F]64,counted byte[$\\ell$]64,counted bit[F]64,"
+                    "hinted fixed[F]1,hinted byte[$\\ell$]1,hinted bit[F]16,hinted counted bit[F]64");
 
     //bench.filesinit("Prezza");
     //cout << "Prezza: "; bench.run_dynamic(); bench.separator("\n");
@@ -294,7 +574,34 @@ int main(int argc, char *argv[])
     cout << "size = " << size << ", queries = " << queries << " => fixed[24]byte16: "; bench.run<Stride<Fixed24Byte, 16>>(); bench.separator();
     cout << "size = " << size << ", queries = " << queries << " => fixed[24]bit16:  "; bench.run<Stride<Fixed24Bit, 16>>(); bench.separator();
     cout << "size = " << size << ", queries = " << queries << " => fixed[26]byte16: "; bench.run<Stride<Fixed26Byte, 16>>(); bench.separator();
-    cout << "size = " << size << ", queries = " << queries << " => fixed[26]bit16:  "; bench.run<Stride<Fixed26Bit, 16>>(); bench.separator("\n");
-
+    cout << "size = " << size << ", queries = " << queries << " => fixed[26]bit16:  "; bench.run<Stride<Fixed26Bit, 16>>(); bench.separator();
+
+    // long strides, scanned by the vector kernels of popcount.hpp
+    cout << "size = " << size << ", queries = " << queries << " => fixed[F]64:      "; bench.run<Stride<FixedF, 64>>(); bench.separator();
+    cout << "size = " << size << ", queries = " << queries << " => byte[F]64:       "; bench.run<Stride<ByteF, 64>>(); bench.separator();
+    cout << "size = " << size << ", queries = " << queries << " => bit[F]64:        "; bench.run<Stride<BitF, 64>>(); bench.separator();
+    cout << "size = " << size << ", queries = " << queries << " => bit[l]64:        "; bench.run<Stride<BitL, 64>>(); bench.separator();
+
+    // counters in the lines of the bitvector
+    cout << "size = " << size << ", queries = " << queries << " => line fixed[F]:   "; bench.run<Line<FixedF>>(); bench.separator();
+    cout << "size = " << size << ", queries = " << queries << " => line byte[F]:    "; bench.run<Line<ByteF>>(); bench.separator();
+    cout << "size = " << size << ", queries = " << queries << " => line byte[l]:    "; bench.run<Line<ByteL>>(); bench.separator();
+    cout << "size = " << size << ", queries = " << queries << " => line bit[F]:     "; bench.run<Line<BitF>>(); bench.separator();
+    cout << "size = " << size << ", queries = " << queries << " => line bit[l]:     "; bench.run<Line<BitL>>(); bench.separator();
+
+    // cumulative counts of the words of each stride
+    cout << "size = " << size << ", queries = " << queries << " => counted fixed[F]16:"; bench.run<Counted<FixedF, 16>>(); bench.separator();
+    cout << "size = " << size << ", queries = " << queries << " => counted bit[F]16:  "; bench.run<Counted<BitF, 16>>(); bench.separator();
+    cout << "size = " << size << ", queries = " << queries << " => counted fixed[F]64:"; bench.run<Counted<FixedF, 64>>(); bench.separator();
+    cout << "size = " << size << ", queries = " << queries << " => counted byte[l]64: "; bench.run<Counted<ByteL, 64>>(); bench.separator();
+    cout << "size = " << size << ", queries = " << queries << " => counted bit[F]64:  "; bench.run<Counted<BitF, 64>>(); bench.separator();
+
+    // sampled select hints, see the select1upd*.csv files for their cost under updates
+    cout << "size = " << size << ", queries = " << queries << " => hinted fixed[F]1:  "; bench.run<Hinted<Word<FixedF>>>(); bench.separator();
+    cout << "size = " << size << ", queries = " << queries << " => hinted byte[l]1:   "; bench.run<Hinted<Word<ByteL>>>(); bench.separator();
+    cout << "size = " << size << ", queries = " << queries << " => hinted bit[F]16:   "; bench.run<Hinted<Stride<BitF, 16>>>(); bench.separator();
+    cout << "size = " << size << ", queries = " << queries << " => hinted counted bit[F]64:"; bench.run<Hinted<Counted<BitF, 64>>>(); bench.separator("\n");
+
+    bench.save();
     return 0;
 }
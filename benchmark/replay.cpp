@@ -0,0 +1,121 @@
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fenwick.hpp>
+#include <rankselect.hpp>
+#include <trace.hpp>
+
+using namespace std;
+using namespace hft;
+using namespace hft::fenwick;
+using namespace hft::ranking;
+
+// Fenwick traces don't carry the bound of the sequence: the benchmarks always use 64
+constexpr size_t BOUND = 64;
+
+template <size_t N> using Byte16Bit = Hybrid<ByteL, BitF, N, 16>;
+template <size_t N> using Fixed20Byte = Hybrid<FixedL, ByteF, N, 20>;
+
+/**
+ * replay() - Replay a trace on a data structure, write a CSV row with the timings.
+ * @validate: Replay it first on a fresh copy of both @T and @REF, comparing every result.
+ *
+ * Return false if the validation found a mismatch.
+ *
+ */
+template <typename T, typename REF>
+bool replay(const string &name, trace::Reader &reader, bool validate) {
+  using namespace std::chrono;
+  const trace::Record *records = reader.records();
+  const size_t count = reader.count();
+
+  size_t mismatches = 0;
+  if (validate) {
+    T ds(reader.snapshot(), reader.size());
+    REF ref(reader.snapshot(), reader.size());
+
+    for (size_t i = 0; i < count; i++) {
+      const uint64_t got = trace::apply(ds, records[i]), expected = trace::apply(ref, records[i]);
+      if (got != expected && mismatches++ == 0)
+        cerr << name << ": record " << i << " (op " << int(records[i].op()) << ", index "
+             << records[i].index() << ", value " << records[i].Value << ") returned " << got
+             << " instead of " << expected << endl;
+    }
+  }
+
+  auto begin = high_resolution_clock::now();
+  T ds(reader.snapshot(), reader.size());
+  auto end = high_resolution_clock::now();
+  const double build = duration_cast<nanoseconds>(end - begin).count() / (double)reader.size();
+
+  uint64_t u = 0;
+  begin = high_resolution_clock::now();
+  for (size_t i = 0; i < count; i++)
+    u ^= trace::apply(ds, records[i]);
+  end = high_resolution_clock::now();
+  const double ns = duration_cast<nanoseconds>(end - begin).count() / max(count, (size_t)1);
+
+  cout << name << "," << reader.size() << "," << count << "," << build << "," << ns << ","
+       << (validate ? to_string(mismatches) : "") << endl;
+
+  const volatile uint64_t __attribute__((unused)) unused = u;
+  return mismatches == 0;
+}
+
+using Replay = bool (*)(const string &, trace::Reader &, bool);
+
+const vector<pair<string, Replay>> FENWICK = {
+    {"fixedf", replay<FixedF<BOUND>, FixedF<BOUND>>},
+    {"fixedl", replay<FixedL<BOUND>, FixedF<BOUND>>},
+    {"bytef", replay<ByteF<BOUND>, FixedF<BOUND>>},
+    {"bytel", replay<ByteL<BOUND>, FixedF<BOUND>>},
+    {"bitf", replay<BitF<BOUND>, FixedF<BOUND>>},
+    {"bitl", replay<BitL<BOUND>, FixedF<BOUND>>},
+    {"byte16bit", replay<Byte16Bit<BOUND>, FixedF<BOUND>>},
+    {"fixed20byte", replay<Fixed20Byte<BOUND>, FixedF<BOUND>>},
+};
+
+const vector<pair<string, Replay>> RANKSELECT = {
+    {"word<fixedf>", replay<Word<FixedF>, Word<FixedF>>},
+    {"word<bytel>", replay<Word<ByteL>, Word<FixedF>>},
+    {"word<bitf>", replay<Word<BitF>, Word<FixedF>>},
+    {"stride<fixedf,8>", replay<Stride<FixedF, 8>, Word<FixedF>>},
+    {"stride<bytel,8>", replay<Stride<ByteL, 8>, Word<FixedF>>},
+    {"stride<bitf,16>", replay<Stride<BitF, 16>, Word<FixedF>>},
+    {"stride<byte16bit,8>", replay<Stride<Byte16Bit, 8>, Word<FixedF>>},
+};
+
+// Replays a trace recorded by fenwick::Capture or ranking::Capture on some (or all) of the
+// data structures above; the results are validated against FixedF (or Word<FixedF>)
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    cerr << "Not enough parameters: <trace> [tree,tree,...|all] [--validate]\n";
+    return -1;
+  }
+
+  trace::Reader reader(argv[1]);
+  if (!reader.valid()) {
+    cerr << argv[1] << " is not a valid trace\n";
+    return -1;
+  }
+
+  const string selected = argc >= 3 && argv[2][0] != '-' ? argv[2] : "all";
+  const bool validate = string(argv[argc - 1]) == "--validate";
+  const auto &candidates = reader.kind() == trace::FENWICK ? FENWICK : RANKSELECT;
+
+  vector<string> names;
+  istringstream stream(selected);
+  for (string name; getline(stream, name, ',');)
+    names.push_back(name);
+
+  bool ok = true;
+  cout << "Tree,Size,Records,build,replay,mismatches" << endl;
+  for (const auto &[name, run] : candidates)
+    if (selected == "all" || find(names.begin(), names.end(), name) != names.end())
+      ok &= run(name, reader, validate);
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+#ifndef __BENCHMARK_RESULTS_HPP__
+#define __BENCHMARK_RESULTS_HPP__
+
+#include <cerrno>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include <numa.hpp>
+
+// Both are passed by the Makefile
+#ifndef HFT_GIT_HASH
+#define HFT_GIT_HASH "unknown"
+#endif
+#ifndef HFT_BUILD_FLAGS
+#define HFT_BUILD_FLAGS "unknown"
+#endif
+
+#if defined(HFT_FORCE_HUGETLBPAGE)
+#define PAGES "huge"
+#elif defined(HFT_DISABLE_TRANSHUGE)
+#define PAGES "small"
+#else
+#define PAGES "transparent"
+#endif
+
+#if defined(HFT_PREFAULT) && defined(HFT_NUMA_INTERLEAVE)
+#define PLACEMENT "prefault+interleave"
+#elif defined(HFT_PREFAULT)
+#define PLACEMENT "prefault"
+#elif defined(HFT_NUMA_INTERLEAVE)
+#define PLACEMENT "interleave"
+#else
+#define PLACEMENT "firsttouch"
+#endif
+
+namespace results {
+
+/**
+ * escape() - JSON string literal of @str (control characters are dropped).
+ *
+ */
+inline std::string escape(const std::string &str) {
+  std::string quoted = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\')
+      quoted += '\\';
+    if ((unsigned char)c >= 0x20)
+      quoted += c;
+  }
+  return quoted + "\"";
+}
+
+/**
+ * quote() - @str itself if it is a decimal number, its JSON string literal otherwise.
+ *
+ */
+inline std::string quote(const std::string &str) {
+  char *end;
+  errno = 0;
+  strtod(str.c_str(), &end);
+  if (!str.empty() && *end == '\0' && errno == 0 && str.find_first_of("xXnN") == std::string::npos)
+    return str;
+
+  return escape(str);
+}
+
+/**
+ * firstline() - First line of @filename, starting after @key if given, or an empty string.
+ *
+ */
+inline std::string firstline(const std::string &filename, const std::string &key = "") {
+  std::ifstream file(filename);
+  for (std::string line; std::getline(file, line);) {
+    if (key.empty())
+      return line;
+
+    if (line.compare(0, key.size(), key) == 0) {
+      const size_t value = line.find_first_not_of(" \t", line.find(':') + 1);
+      return value == std::string::npos ? "" : line.substr(value);
+    }
+  }
+  return "";
+}
+
+/**
+ * metadata() - Description of the host and of the build, as a JSON object.
+ *
+ */
+inline std::string metadata() {
+  utsname uts;
+  uname(&uts);
+
+  char date[32];
+  const time_t now = time(nullptr);
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+  const std::vector<std::pair<std::string, std::string>> fields = {
+      {"date", date},
+      {"host", uts.nodename},
+      {"kernel", uts.release},
+      {"cpu", firstline("/proc/cpuinfo", "model name")},
+      {"cpus", std::to_string(sysconf(_SC_NPROCESSORS_ONLN))},
+      {"nodes", std::to_string(hft::numa::nodes())},
+      {"l1d", std::to_string(sysconf(_SC_LEVEL1_DCACHE_SIZE))},
+      {"l2", std::to_string(sysconf(_SC_LEVEL2_CACHE_SIZE))},
+      {"l3", std::to_string(sysconf(_SC_LEVEL3_CACHE_SIZE))},
+      {"line", std::to_string(sysconf(_SC_LEVEL1_DCACHE_LINESIZE))},
+      {"thp", firstline("/sys/kernel/mm/transparent_hugepage/enabled")},
+      {"pages", PAGES},
+      {"placement", PLACEMENT},
+      {"compiler", __VERSION__},
+      {"flags", HFT_BUILD_FLAGS},
+      {"git", HFT_GIT_HASH},
+  };
+
+  std::string json = "{";
+  for (size_t i = 0; i < fields.size(); i++)
+    json += (i ? ", " : "") + escape(fields[i].first) + ": " + escape(fields[i].second);
+  return json + "}";
+}
+
+using Config = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * class Json - Repeated measurements of a benchmark, with the metadata of the run.
+ *
+ * The file has the form {"metadata": {...}, "results": [{"tree": ..., "op": ..., "size": ...,
+ * "unit": "ns", "samples": [...]}, ...]}: every result keeps all the repetitions, so that
+ * utils/compare.py can tell noise from regressions.
+ *
+ */
+class Json {
+private:
+  std::vector<std::string> Results;
+
+public:
+  /**
+   * add() - Add the samples of a configuration.
+   * @config: Name and value of the parameters (e.g. tree, op and size).
+   * @samples: One value per repetition.
+   * @unit: Unit of the samples.
+   *
+   */
+  void add(const Config &config, const std::vector<double> &samples,
+           const std::string &unit = "ns") {
+    std::ostringstream json;
+    json << "{";
+    for (const auto &[key, value] : config)
+      json << escape(key) << ": " << quote(value) << ", ";
+
+    json << "\"unit\": " << escape(unit) << ", \"samples\": [";
+    for (size_t i = 0; i < samples.size(); i++)
+      json << (i ? ", " : "") << samples[i];
+    json << "]}";
+
+    Results.push_back(json.str());
+  }
+
+  bool empty() const { return Results.empty(); }
+
+  void write(const std::string &filename) const {
+    std::ofstream file(filename);
+    file << "{\n\"metadata\": " << metadata() << ",\n\"results\": [\n";
+    for (size_t i = 0; i < Results.size(); i++)
+      file << (i ? ",\n" : "") << Results[i];
+    file << "\n]}\n";
+  }
+};
+
+} // namespace results
+
+#endif // __BENCHMARK_RESULTS_HPP__
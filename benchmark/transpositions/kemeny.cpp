@@ -65,8 +65,7 @@ size_t vigna_ktsl(uint64_t *sigmainv, uint64_t *rho, size_t len)
     for (size_t i = 0; i < len; i++)
     {
         size_t p = sigmainv[ rho[i] ];
-        d += b.rankZero(p);
-        b.set(p);
+        d += b.rankZeroAndSet(p);
     }
 
     return d;
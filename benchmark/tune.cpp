@@ -0,0 +1,183 @@
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <tune.hpp>
+
+using namespace std;
+using namespace hft;
+
+// Fenwick trees need their bound at compile time: the requested one is rounded up to the first of
+// these, so that every element still fits
+constexpr size_t BOUNDS[] = {1, 3, 15, 64, 255, 4095, 65535, (1ULL << 24) - 1, (1ULL << 32) - 1};
+
+struct Options {
+  string Kind = "fenwick", Trace;
+  size_t Size = 1000000, Bound = 64, Ops = 1000000, Budget = SIZE_MAX;
+  unsigned Reps = 3;
+  uint64_t Seed = 0;
+  tune::Mix Mix;
+  bool Config = false;
+};
+
+void report(const Options &opts, const vector<tune::Result> &results, size_t bound) {
+  if (results.empty() || !results[0].Fits) {
+    cerr << "No candidate fits in " << opts.Budget << " bytes" << endl;
+    return;
+  }
+
+  if (opts.Config) {
+    cout << results[0].Name << endl;
+    return;
+  }
+
+  fprintf(stderr, "%-28s %10s %12s\n", "candidate", "ns/op", "MiB");
+  for (const tune::Result &r : results)
+    fprintf(stderr, "%-28s %10.2f %12.2f%s\n", r.Name.c_str(), r.Ns, r.Bytes / 1048576.,
+            r.Fits ? "" : " (over budget)");
+
+  cout << "// " << opts.Kind << ", " << results[0].Ns << " ns/op, " << results[0].Bytes
+       << " bytes\n"
+       << tune::snippet(results[0]) << "\n"
+       << "// runtime: "
+       << (opts.Kind == "fenwick"
+               ? "hft::tune::makeTree<" + to_string(bound) + ">(\"" + results[0].Name + "\", ...)"
+               : "hft::tune::makeRankSelect(\"" + results[0].Name + "\", ...)")
+       << endl;
+}
+
+template <size_t BOUND> void tree(const Options &opts, trace::Reader *reader) {
+  vector<uint64_t> sequence;
+  vector<trace::Record> ops;
+  if (reader) {
+    sequence.assign(reader->snapshot(), reader->snapshot() + reader->size());
+    ops.assign(reader->records(), reader->records() + reader->count());
+  } else {
+    mt19937_64 re(opts.Seed);
+    uniform_int_distribution<uint64_t> dist(0, opts.Bound);
+    sequence.resize(opts.Size);
+    for (uint64_t &e : sequence)
+      e = dist(re);
+    ops = tune::treeOps<BOUND>(sequence.data(), sequence.size(), opts.Mix, opts.Ops, opts.Seed);
+  }
+
+  report(opts,
+         tune::tree<BOUND>(sequence.data(), sequence.size(), ops.data(), ops.size(), opts.Budget,
+                           opts.Reps),
+         BOUND);
+}
+
+template <size_t... I> bool dispatch(const Options &opts, trace::Reader *reader,
+                                     index_sequence<I...>) {
+  // the first bound large enough
+  return ((opts.Bound <= BOUNDS[I] ? (tree<BOUNDS[I]>(opts, reader), true) : false) || ...);
+}
+
+void rankselect(const Options &opts, trace::Reader *reader) {
+  vector<uint64_t> bitvector;
+  vector<trace::Record> ops;
+  if (reader) {
+    bitvector.assign(reader->snapshot(), reader->snapshot() + reader->size());
+    ops.assign(reader->records(), reader->records() + reader->count());
+  } else {
+    mt19937_64 re(opts.Seed);
+    bitvector.resize(opts.Size);
+    for (uint64_t &word : bitvector)
+      word = re();
+    ops = tune::rankSelectOps(bitvector.data(), bitvector.size(), opts.Mix, opts.Ops, opts.Seed);
+  }
+
+  report(opts,
+         tune::rankSelect(bitvector.data(), bitvector.size(), ops.data(), ops.size(), opts.Budget,
+                          opts.Reps),
+         0);
+}
+
+size_t bytes(const string &value) {
+  size_t pos;
+  const double number = stod(value, &pos);
+  const string unit = value.substr(pos);
+  const int shift = unit == "K" ? 10 : unit == "M" ? 20 : unit == "G" ? 30 : 0;
+  return number * (1ULL << shift);
+}
+
+void usage() {
+  cerr << "Usage: hft-tune [--option=value]...\n"
+       << "  --kind    fenwick or rankselect (default: fenwick)\n"
+       << "  --size    elements (or 64-bit words of the bitvector, default: 1000000)\n"
+       << "  --bound   largest element of the sequence (default: 64)\n"
+       << "  --mix     weights of read,update,search: prefix,add,find or rank,toggle,select "
+          "(default: 1,0,0)\n"
+       << "  --ops     operations of the workload (default: 1000000)\n"
+       << "  --trace   workload recorded by fenwick::Capture or ranking::Capture, instead of "
+          "--kind, --size and --mix\n"
+       << "  --budget  largest footprint, in bytes (suffixes K, M and G, default: unlimited)\n"
+       << "  --reps    replays of the workload per candidate (default: 3)\n"
+       << "  --seed    seed of the random engine (default: 0)\n"
+       << "  --config  print only the runtime configuration of the fastest candidate\n";
+}
+
+// Benchmarks every candidate of include/tune.hpp on a workload, prints the table on the standard
+// error and the fastest candidate within the budget (as a type alias, or as a runtime
+// configuration for the factories of include/tune.hpp) on the standard output
+int main(int argc, char **argv) {
+  Options opts;
+
+  for (int i = 1; i < argc; i++) {
+    const string arg = argv[i];
+    const size_t eq = arg.find('=');
+    const string key = arg.substr(0, eq), value = eq == string::npos ? "" : arg.substr(eq + 1);
+
+    if (key == "--kind")
+      opts.Kind = value;
+    else if (key == "--size")
+      opts.Size = stoul(value);
+    else if (key == "--bound")
+      opts.Bound = stoull(value);
+    else if (key == "--mix") {
+      char comma;
+      istringstream(value) >> opts.Mix.Read >> comma >> opts.Mix.Update >> comma >> opts.Mix.Search;
+    } else if (key == "--ops")
+      opts.Ops = stoul(value);
+    else if (key == "--trace")
+      opts.Trace = value;
+    else if (key == "--budget")
+      opts.Budget = bytes(value);
+    else if (key == "--reps")
+      opts.Reps = stoul(value);
+    else if (key == "--seed")
+      opts.Seed = stoull(value);
+    else if (key == "--config")
+      opts.Config = true;
+    else {
+      usage();
+      return -1;
+    }
+  }
+
+  unique_ptr<trace::Reader> reader;
+  if (!opts.Trace.empty()) {
+    reader = make_unique<trace::Reader>(opts.Trace);
+    if (!reader->valid()) {
+      cerr << opts.Trace << " is not a valid trace\n";
+      return -1;
+    }
+    opts.Kind = reader->kind() == trace::FENWICK ? "fenwick" : "rankselect";
+  }
+
+  if (opts.Kind == "rankselect") {
+    rankselect(opts, reader.get());
+  } else if (opts.Kind != "fenwick") {
+    usage();
+    return -1;
+  } else if (!dispatch(opts, reader.get(), make_index_sequence<size(BOUNDS)>())) {
+    cerr << "Bounds larger than " << BOUNDS[size(BOUNDS) - 1] << " are not supported\n";
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,327 @@
+#ifndef __BENCHMARK_WORKLOAD_HPP__
+#define __BENCHMARK_WORKLOAD_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace workload {
+
+/**
+ * class Distribution - Random keys in [1, n].
+ *
+ * Keys are meant to be drawn before the measured loop (see keys() and stream()): the virtual call
+ * and the arithmetic of the skewed distributions would otherwise be measured with the tree.
+ *
+ */
+class Distribution {
+protected:
+  const uint64_t N;
+
+public:
+  explicit Distribution(uint64_t n) : N(std::max<uint64_t>(n, 1)) {}
+  virtual ~Distribution() = default;
+
+  /**
+   * next() - Draw a key.
+   * @re: Random engine.
+   *
+   */
+  virtual uint64_t next(std::mt19937_64 &re) = 0;
+
+  /**
+   * written() - Notify that @key has just been updated (only the latest distribution cares).
+   *
+   */
+  virtual void written(uint64_t) {}
+
+  uint64_t size() const { return N; }
+};
+
+/**
+ * class Uniform - Every key has the same probability.
+ *
+ */
+class Uniform : public Distribution {
+private:
+  std::uniform_int_distribution<uint64_t> Dist;
+
+public:
+  explicit Uniform(uint64_t n) : Distribution(n), Dist(1, N) {}
+
+  virtual uint64_t next(std::mt19937_64 &re) override { return Dist(re); }
+};
+
+/**
+ * class Zipf - Zipfian keys, the i-th most popular one with probability proportional to 1/i^theta.
+ * @n: Number of keys.
+ * @theta: Skew, in (0, 1): YCSB uses 0.99.
+ * @scrambled: Spread the popular keys over the whole range (otherwise key i is the i-th most
+ * popular one).
+ *
+ * This is the generator of Gray et al. ("Quickly generating billion-record synthetic databases")
+ * also used by YCSB. Zeta(n) is summed exactly up to 10^7 and approximated by its integral beyond.
+ *
+ */
+class Zipf : public Distribution {
+private:
+  static constexpr uint64_t EXACT = 10000000;
+
+  const double Theta, Alpha, Zetan, Eta;
+  const bool Scrambled;
+  std::uniform_real_distribution<double> Unit;
+
+  static double zeta(uint64_t n, double theta) {
+    double sum = 0;
+    const uint64_t exact = std::min(n, EXACT);
+    for (uint64_t i = 1; i <= exact; i++)
+      sum += 1 / std::pow(i, theta);
+
+    if (n > exact)
+      sum += (std::pow(n + 0.5, 1 - theta) - std::pow(exact + 0.5, 1 - theta)) / (1 - theta);
+
+    return sum;
+  }
+
+  static uint64_t fnv(uint64_t value) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < 8; i++, value >>= 8)
+      hash = (hash ^ (value & 0xff)) * 0x100000001b3ULL;
+    return hash;
+  }
+
+public:
+  Zipf(uint64_t n, double theta = 0.99, bool scrambled = true)
+      : Distribution(n), Theta(theta), Alpha(1 / (1 - theta)), Zetan(zeta(N, theta)),
+        Eta((1 - std::pow(2. / N, 1 - theta)) / (1 - zeta(2, theta) / Zetan)),
+        Scrambled(scrambled) {}
+
+  /**
+   * rank() - Draw a popularity rank in [0, n).
+   *
+   */
+  uint64_t rank(std::mt19937_64 &re) {
+    const double u = Unit(re), uz = u * Zetan;
+
+    if (uz < 1)
+      return 0;
+    if (uz < 1 + std::pow(0.5, Theta))
+      return std::min<uint64_t>(1, N - 1);
+
+    return std::min<uint64_t>(N * std::pow(Eta * u - Eta + 1, Alpha), N - 1);
+  }
+
+  virtual uint64_t next(std::mt19937_64 &re) override {
+    const uint64_t r = rank(re);
+    return (Scrambled ? fnv(r) % N : r) + 1;
+  }
+};
+
+/**
+ * class Hotspot - A contiguous hot set receiving most of the accesses.
+ * @n: Number of keys.
+ * @hotset: Fraction of the keys in the hot set.
+ * @hotops: Fraction of the accesses to the hot set.
+ * @offset: First key of the hot set, minus one.
+ *
+ */
+class Hotspot : public Distribution {
+private:
+  const uint64_t Hot, Offset;
+  const double HotOps;
+  std::uniform_real_distribution<double> Unit;
+  std::uniform_int_distribution<uint64_t> HotDist, ColdDist;
+
+public:
+  Hotspot(uint64_t n, double hotset = 0.2, double hotops = 0.8, uint64_t offset = 0)
+      : Distribution(n), Hot(std::clamp<uint64_t>(N * hotset, 1, N)), Offset(offset % N),
+        HotOps(Hot == N ? 1 : hotops), HotDist(0, Hot - 1), ColdDist(Hot, N - 1) {}
+
+  virtual uint64_t next(std::mt19937_64 &re) override {
+    const uint64_t i = Unit(re) < HotOps ? HotDist(re) : ColdDist(re);
+    return (Offset + i) % N + 1;
+  }
+};
+
+/**
+ * class Sequential - A scan wrapping around at the end.
+ * @n: Number of keys.
+ * @start: First key, minus one.
+ * @stride: Distance between two consecutive keys.
+ *
+ */
+class Sequential : public Distribution {
+private:
+  const uint64_t Stride;
+  uint64_t Current;
+
+public:
+  Sequential(uint64_t n, uint64_t start = 0, uint64_t stride = 1)
+      : Distribution(n), Stride(stride), Current(start % N) {}
+
+  virtual uint64_t next(std::mt19937_64 &) override {
+    const uint64_t key = Current + 1;
+    Current = (Current + Stride) % N;
+    return key;
+  }
+};
+
+/**
+ * class Latest - Zipfian distance from the most recently written key.
+ *
+ * The YCSB "latest" distribution: recently updated keys are the most popular ones. Until
+ * something is written the most recent key is the last one.
+ *
+ */
+class Latest : public Distribution {
+private:
+  Zipf Distance;
+  uint64_t Last;
+
+public:
+  explicit Latest(uint64_t n, double theta = 0.99)
+      : Distribution(n), Distance(n, theta, false), Last(N - 1) {}
+
+  virtual uint64_t next(std::mt19937_64 &re) override {
+    return (Last + N - Distance.rank(re)) % N + 1;
+  }
+
+  virtual void written(uint64_t key) override { Last = (key - 1) % N; }
+};
+
+/**
+ * distributions() - Names accepted by make().
+ *
+ */
+inline const std::vector<std::string> &distributions() {
+  static const std::vector<std::string> names = {"uniform", "zipf", "hotspot", "sequential",
+                                                 "latest"};
+  return names;
+}
+
+/**
+ * make() - Build a distribution with its default parameters.
+ * @name: One of distributions().
+ * @n: Number of keys.
+ * @re: Random engine, used to place the hot set and the start of the scan.
+ *
+ * Return nullptr if the name is unknown.
+ *
+ */
+inline std::unique_ptr<Distribution> make(const std::string &name, uint64_t n,
+                                          std::mt19937_64 &re) {
+  if (name == "uniform")
+    return std::make_unique<Uniform>(n);
+  if (name == "zipf")
+    return std::make_unique<Zipf>(n);
+  if (name == "hotspot")
+    return std::make_unique<Hotspot>(n, 0.2, 0.8, re());
+  if (name == "sequential")
+    return std::make_unique<Sequential>(n, re());
+  if (name == "latest")
+    return std::make_unique<Latest>(n);
+
+  return nullptr;
+}
+
+/**
+ * keys() - Draw @count keys from @dist.
+ *
+ */
+inline std::vector<uint64_t> keys(Distribution &dist, size_t count, std::mt19937_64 &re) {
+  std::vector<uint64_t> keys(count);
+  for (size_t i = 0; i < count; i++)
+    keys[i] = dist.next(re);
+  return keys;
+}
+
+/**
+ * enum Op - Kinds of operations of a mixed stream.
+ * @READ: A point query (prefix sum, rank).
+ * @UPDATE: A point update (add, set or clear).
+ * @SCAN: A short range query, @Length keys from @Key (difference of two prefix sums).
+ * @RMW: A read followed by an update of the same key.
+ *
+ */
+enum class Op : uint8_t { READ, UPDATE, SCAN, RMW };
+
+struct Operation {
+  Op Kind;
+  uint32_t Length;
+  uint64_t Key;
+};
+
+/**
+ * struct Mix - Proportions of the operations of a stream (they don't need to sum to one).
+ * @Read: Weight of reads.
+ * @Update: Weight of updates.
+ * @Scan: Weight of scans.
+ * @Rmw: Weight of read-modify-writes.
+ * @Dist: Name of the key distribution.
+ * @MaxScan: Longest scan.
+ *
+ */
+struct Mix {
+  double Read, Update, Scan, Rmw;
+  std::string Dist;
+  uint32_t MaxScan = 100;
+};
+
+/**
+ * ycsb() - The core YCSB workloads, from 'a' to 'f'.
+ *
+ * Inserts have no counterpart in a fixed-size structure: workload D updates instead of
+ * inserting, and the "latest" distribution follows the updates.
+ *
+ */
+inline Mix ycsb(char workload) {
+  switch (workload) {
+  case 'a':
+    return {0.5, 0.5, 0, 0, "zipf"}; // update heavy
+  case 'b':
+    return {0.95, 0.05, 0, 0, "zipf"}; // read mostly
+  case 'c':
+    return {1, 0, 0, 0, "zipf"}; // read only
+  case 'd':
+    return {0.95, 0.05, 0, 0, "latest"}; // read latest
+  case 'e':
+    return {0, 0.05, 0.95, 0, "zipf"}; // short ranges
+  default:
+    return {0.5, 0, 0, 0.5, "zipf"}; // read-modify-write
+  }
+}
+
+/**
+ * stream() - Draw a stream of @count operations.
+ * @mix: Proportions and distribution of the operations.
+ * @n: Number of keys.
+ * @count: Number of operations.
+ * @re: Random engine.
+ *
+ */
+inline std::vector<Operation> stream(const Mix &mix, uint64_t n, size_t count,
+                                     std::mt19937_64 &re) {
+  std::unique_ptr<Distribution> dist = make(mix.Dist, n, re);
+  std::discrete_distribution<int> kind({mix.Read, mix.Update, mix.Scan, mix.Rmw});
+  std::uniform_int_distribution<uint32_t> length(1, std::max<uint32_t>(mix.MaxScan, 1));
+
+  std::vector<Operation> ops(count);
+  for (size_t i = 0; i < count; i++) {
+    ops[i].Kind = Op(kind(re));
+    ops[i].Key = dist->next(re);
+    ops[i].Length = ops[i].Kind == Op::SCAN ? length(re) : 0;
+
+    if (ops[i].Kind == Op::UPDATE || ops[i].Kind == Op::RMW)
+      dist->written(ops[i].Key);
+  }
+
+  return ops;
+}
+
+} // namespace workload
+
+#endif // __BENCHMARK_WORKLOAD_HPP__
@@ -6,7 +6,12 @@
 #include <cstdint>
 #include <cstring>
 #include <memory>
+
+#include "cpu.hpp"
+
+#ifdef HFT_X86
 #include <x86intrin.h>
+#endif
 
 // Macro stringification
 #define __STRINGIFY(s) #s
@@ -16,6 +21,16 @@
 #define likely(x) __builtin_expect(!!(x), 1)
 #define unlikely(x) __builtin_expect(!!(x), 0)
 
+// Word-straddling accesses counter (see stats.hpp)
+#ifdef HFT_INSTRUMENT
+namespace hft::stats {
+inline thread_local std::uint64_t Straddles = 0;
+}
+#define HFT_STRADDLE() (hft::stats::Straddles++)
+#else
+#define HFT_STRADDLE()
+#endif
+
 namespace hft {
 
 using std::memcpy;
@@ -260,6 +275,7 @@ inline uint64_t bitread(const void *const word, int from, int length) {
   if (likely((from + length) <= 64)) {
     return (ret >> from) & (-1ULL >> (64 - length));
   } else {
+    HFT_STRADDLE();
     uint64_t next;
     memcpy(&next, static_cast<const uint64_t *>(word) + 1, sizeof(uint64_t));
     return (ret >> from) | (next << (128 - from - length) >> (64 - length));
@@ -297,6 +313,7 @@ inline void bitwrite_inc(void *const word, int from, int length, uint64_t inc) {
     value += inc << from;
     memcpy(word, &value, sizeof(uint64_t));
   } else {
+    HFT_STRADDLE();
     value = (value & (-1ULL >> (64 - from))) | (sum << from);
     memcpy(word, &value, sizeof(uint64_t));
 
@@ -311,8 +328,32 @@ inline void bitwrite_inc(void *const word, int from, int length, uint64_t inc) {
  * popcount - Count the number of 1-bits in a word.
  * @word: Binary word.
  *
+ * Without -mpopcnt the builtin is a call to a table-driven routine, so POPCNT runs anyway when
+ * cpu::Host has it (on x86-64, whose registers hold a whole word).
+ *
  */
-inline int popcount(uint64_t word) { return __builtin_popcountll(word); }
+inline int popcount(uint64_t word) {
+#if defined(__x86_64__) && !defined(__POPCNT__)
+  if (likely(cpu::Host.Popcnt)) {
+    uint64_t ones;
+    asm("popcnt %1, %0" : "=r"(ones) : "r"(word));
+    return ones;
+  }
+#endif
+  return __builtin_popcountll(word);
+}
+
+/**
+ * prefetch - Start loading the cache lines of a memory range, without waiting for them.
+ * @addr: First byte of the range.
+ * @bytes: Length of the range.
+ *
+ */
+inline void prefetch(const void *addr, size_t bytes = 1) {
+  const uintptr_t end = reinterpret_cast<uintptr_t>(addr) + bytes;
+  for (uintptr_t line = reinterpret_cast<uintptr_t>(addr) & ~uintptr_t(63); line < end; line += 64)
+    __builtin_prefetch(reinterpret_cast<const void *>(line));
+}
 
 /**
  * mround - Returns a number rounded to the desired power of two multiple.
@@ -335,9 +376,7 @@ inline size_t updroot(size_t j, size_t n) {
 }
 
 /**
- * select64 - Returns the index of the k-th 1-bit in the 64-bit word x.
- * @x: 64-bit word.
- * @k: 0-based rank (@k = 0 returns the position of the first 1-bit).
+ * select64_broadword - select64() without special instructions.
  *
  * Uses the broadword selection algorithm by Vigna [1], improved by Gog and Petri [2] and Vigna [3].
  * Facebook's Folly implementation [4].
@@ -352,8 +391,7 @@ inline size_t updroot(size_t j, size_t n) {
  * [4] Facebook Folly library: https://github.com/facebook/folly
  *
  */
-inline uint64_t select64(uint64_t x, uint64_t k) {
-#ifndef __haswell__
+inline uint64_t select64_broadword(uint64_t x, uint64_t k) {
   constexpr uint64_t kOnesStep4 = 0x1111111111111111ULL;
   constexpr uint64_t kOnesStep8 = 0x0101010101010101ULL;
   constexpr uint64_t kLAMBDAsStep8 = 0x80ULL * kOnesStep8;
@@ -369,8 +407,17 @@ inline uint64_t select64(uint64_t x, uint64_t k) {
   uint64_t place = popcount(geqKStep8) * 8;
   uint64_t byteRank = k - (((byteSums << 8) >> place) & uint64_t(0xFF));
   return place + kSelectInByte[((x >> place) & 0xFF) | (byteRank << 8)];
-#elif defined(__GNUC__) || defined(__clang__)
-  // GCC and Clang won't inline the intrinsics.
+}
+
+/**
+ * select64_pdep - select64() with PDEP and TZCNT, for CPUs with BMI2.
+ *
+ * The instructions are emitted by hand, so that a generic build can run them after checking
+ * cpu::Host (GCC and Clang won't inline the intrinsics outside of a BMI2 target anyway).
+ *
+ */
+#ifdef __x86_64__
+inline uint64_t select64_pdep(uint64_t x, uint64_t k) {
   uint64_t result = uint64_t(1) << k;
 
   asm("pdep %1, %0, %0\n\t"
@@ -379,8 +426,26 @@ inline uint64_t select64(uint64_t x, uint64_t k) {
       : "r"(x));
 
   return result;
+}
+#endif
+
+/**
+ * select64 - Returns the index of the k-th 1-bit in the 64-bit word x.
+ * @x: 64-bit word.
+ * @k: 0-based rank (@k = 0 returns the position of the first 1-bit).
+ *
+ * PDEP is chosen at compile time when the target has a fast one (-mbmi2 but not Zen 1 or 2),
+ * otherwise at runtime by cpu::Selection. Define HFT_DISABLE_BMI2 to always run the broadword
+ * algorithm, the only one outside x86-64.
+ *
+ */
+inline uint64_t select64(uint64_t x, uint64_t k) {
+#if defined(HFT_DISABLE_BMI2) || !defined(__x86_64__)
+  return select64_broadword(x, k);
+#elif defined(__BMI2__) && !defined(__znver1__) && !defined(__znver2__)
+  return select64_pdep(x, k);
 #else
-  return _tzcnt_u64(_pdep_u64(1ULL << k, x));
+  return cpu::Selection == cpu::PDEP ? select64_pdep(x, k) : select64_broadword(x, k);
 #endif
 }
 
@@ -0,0 +1,116 @@
+#ifndef __CPU_HPP__
+#define __CPU_HPP__
+
+/**
+ * HFT_X86 - Defined when compiling for x86, the only target of the vector kernels and of the
+ * instructions detected below: elsewhere no extension is detected and the portable code runs.
+ *
+ */
+#if defined(__x86_64__) || defined(__i386__)
+#define HFT_X86
+#endif
+
+namespace hft::cpu {
+
+/**
+ * struct Features - Instruction set extensions of a CPU.
+ * @Popcnt: POPCNT.
+ * @Bmi2: BMI2 (PDEP and PEXT).
+ * @FastPdep: BMI2 with PDEP and PEXT in hardware (AMD microcodes them before Zen 3).
+ * @Avx2: AVX2.
+ * @Avx512Popcnt: AVX-512 with VPOPCNTQ (AVX512F and AVX512VPOPCNTDQ).
+ *
+ * Kernels compiled for several extensions pick one at runtime, so that a binary built for a
+ * generic x86-64 still uses what the machine offers.
+ *
+ */
+struct Features {
+  bool Popcnt = false, Bmi2 = false, FastPdep = false, Avx2 = false, Avx512Popcnt = false;
+
+  /**
+   * host() - Extensions of the running CPU.
+   *
+   */
+  static Features host() {
+    Features features;
+
+#ifdef HFT_X86
+    __builtin_cpu_init();
+    features.Popcnt = __builtin_cpu_supports("popcnt");
+    features.Bmi2 = __builtin_cpu_supports("bmi2");
+    features.FastPdep =
+        features.Bmi2 && !__builtin_cpu_is("znver1") && !__builtin_cpu_is("znver2");
+    features.Avx2 = __builtin_cpu_supports("avx2");
+    features.Avx512Popcnt =
+        __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq");
+#endif
+
+    return features;
+  }
+};
+
+/**
+ * enum Simd - Width of the vector kernels.
+ *
+ */
+enum Simd { SCALAR, AVX2, AVX512 };
+
+/**
+ * simd() - Widest vector kernels supported by @features.
+ *
+ * Define HFT_DISABLE_SIMD to always run the scalar ones.
+ *
+ */
+inline Simd simd(const Features &features) {
+#ifdef HFT_DISABLE_SIMD
+  return SCALAR;
+#else
+  return features.Avx512Popcnt ? AVX512 : features.Avx2 ? AVX2 : SCALAR;
+#endif
+}
+
+/**
+ * enum Select - Algorithm selecting a 1-bit in a word.
+ *
+ */
+enum Select { BROADWORD, PDEP };
+
+/**
+ * select() - Fastest word selection on @features.
+ *
+ * Define HFT_DISABLE_BMI2 to always run the broadword one.
+ *
+ */
+inline Select select(const Features &features) {
+#ifdef HFT_DISABLE_BMI2
+  return BROADWORD;
+#else
+  return features.FastPdep ? PDEP : BROADWORD;
+#endif
+}
+
+/**
+ * Host, Kernels, Selection - Extensions of the running CPU and the kernels chosen for it, detected
+ * once at startup.
+ *
+ * Until they are initialized (i.e. in the constructors of other globals) every field is false and
+ * the portable kernels run.
+ *
+ */
+inline const Features Host = Features::host();
+inline const Simd Kernels = simd(Host);
+inline const Select Selection = select(Host);
+
+/**
+ * name() - Printable name of a kernel.
+ *
+ */
+inline const char *name(Simd simd) {
+  return simd == AVX512 ? "avx512" : simd == AVX2 ? "avx2" : "scalar";
+}
+
+inline const char *name(Select select) { return select == PDEP ? "pdep" : "broadword"; }
+
+} // namespace hft::cpu
+
+#endif // __CPU_HPP__
@@ -2,12 +2,47 @@
 #define __DARRAY_HPP__
 
 #include "common.hpp"
+#include "numa.hpp"
 #include <assert.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <sys/mman.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+#include <vector>
 
 namespace hft {
 
+/**
+ * struct MemoryReport - Breakdown (in bits) of the memory used by a data structure.
+ * @Payload: Bits storing actual data (e.g. the nodes of a tree or the words of a bitvector).
+ * @Holes: Bits allocated in the arrays but not used by the payload (holes, padding, safety bytes).
+ * @Pages: Bits wasted rounding the arrays up to a whole number of pages.
+ * @Metadata: Bits of the objects themselves and of their auxiliary arrays (e.g. Level).
+ * @Resident: Bits of the arrays currently backed by physical memory (see mincore(2)).
+ *
+ * The first four fields partition the allocated memory, whose total is what bitCount() returns.
+ * Resident memory is a snapshot: pages that were never touched do not count.
+ *
+ */
+struct MemoryReport {
+  size_t Payload = 0, Holes = 0, Pages = 0, Metadata = 0, Resident = 0;
+
+  size_t total() const { return Payload + Holes + Pages + Metadata; }
+
+  MemoryReport &operator+=(const MemoryReport &oth) {
+    Payload += oth.Payload;
+    Holes += oth.Holes;
+    Pages += oth.Pages;
+    Metadata += oth.Metadata;
+    Resident += oth.Resident;
+    return *this;
+  }
+};
+
 /**
  * class DArray - Dinamically-allocated fixed-sized array with hugepages support
  *
@@ -21,6 +56,14 @@ namespace hft {
  * By default (without defining any of the above) every request of at least 2MB allocs 4k pages, but
  * they are transparently defragmented into hugepages by khugepaged thanks to a call to madvice.
  *
+ * Independently of the page size, two more behaviors control where pages are placed:
+ * - HFT_PREFAULT: pages are faulted in at allocation time by a pool of threads pinned to the NUMA
+ *   nodes (see numa::prefault), instead of one by one by the thread building the structure;
+ * - HFT_NUMA_INTERLEAVE: pages are interleaved across every NUMA node, which is the sane choice for
+ *   read-mostly structures queried from every socket.
+ *
+ * Both of them gracefully do nothing more than a single-threaded touch on single-node machines.
+ *
  * [1] https://www.kernel.org/doc/html/latest/admin-guide/mm/hugetlbpage.html
  * [2] https://www.kernel.org/doc/html/latest/admin-guide/mm/transhuge.html
  *
@@ -30,6 +73,11 @@ template <typename T> class DArray {
 public:
   static constexpr int PROT = PROT_READ | PROT_WRITE;
   static constexpr int FLAGS = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef HFT_FORCE_HUGETLBPAGE
+  static constexpr size_t PAGESIZE = 2 * 1024 * 1024;
+#else
+  static constexpr size_t PAGESIZE = 4 * 1024;
+#endif
 
 private:
   size_t Size = 0;
@@ -42,19 +90,23 @@ public:
     const size_t space = page_aligned(Size);
     if (space) {
 #ifdef HFT_FORCE_HUGETLBPAGE
-      void *mem = mmap(nullptr, space, PROT, FLAGS | MAP_HUGETLB, -1, 0);
-      assert(mem != MAP_FAILED && "mmap failed");
+      void *mem = mapped(mmap(nullptr, space, PROT, FLAGS | MAP_HUGETLB, -1, 0), "mmap failed");
 #elif HFT_DISABLE_TRANSHUGE
-      void *mem = mmap(nullptr, space, PROT, FLAGS, -1, 0);
-      assert(mem != MAP_FAILED && "mmap failed");
+      void *mem = mapped(mmap(nullptr, space, PROT, FLAGS, -1, 0), "mmap failed");
 #else
-      void *mem = mmap(nullptr, space, PROT, FLAGS, -1, 0);
-      assert(mem != MAP_FAILED && "mmap failed");
+      void *mem = mapped(mmap(nullptr, space, PROT, FLAGS, -1, 0), "mmap failed");
 
       int adv = madvise(mem, space, MADV_HUGEPAGE);
       assert(adv == 0 && "madvise failed");
 #endif
 
+#ifdef HFT_NUMA_INTERLEAVE
+      numa::interleave(mem, space);
+#endif
+#ifdef HFT_PREFAULT
+      numa::prefault(mem, space, PAGESIZE);
+#endif
+
       Buffer = static_cast<T *>(mem);
     }
   }
@@ -85,15 +137,91 @@ public:
 
   inline size_t size() const { return Size; }
 
+  /**
+   * resize() - Change the length of the array, keeping its content.
+   * @length: The new length.
+   *
+   * The pages are moved by mremap(2), so that the array is never copied: new elements are zero,
+   * as the ones of a new array, and they keep the hugepage and NUMA policies of the old ones. If
+   * the pages can't be moved a std::system_error is thrown (as when a new array can't be mapped)
+   * and the array is left as it was; without exceptions, the error is printed and abort() called.
+   *
+   */
+  void resize(size_t length) {
+    if (Buffer == nullptr || length == 0) {
+      DArray<T> array(length);
+      swap(*this, array);
+      return;
+    }
+
+    const size_t space = page_aligned(length);
+    if (space != page_aligned(Size)) {
+      void *mem = mremap(Buffer, page_aligned(Size), space, MREMAP_MAYMOVE);
+      Buffer = static_cast<T *>(mapped(mem, "mremap failed"));
+    }
+
+    // elements past the end must be zero when the array grows again
+    if (length < Size)
+      std::fill(Buffer + length, Buffer + min(Size, space / sizeof(T)), T());
+
+    Size = length;
+  }
+
   size_t bitCount() const { return sizeof(DArray<T>) * 8 + page_aligned(Size) * 8; }
 
+  /**
+   * resident() - Number of bytes of this array currently backed by physical memory.
+   *
+   */
+  size_t resident() const {
+    if (Buffer == nullptr)
+      return 0;
+
+    const size_t page = sysconf(_SC_PAGESIZE);
+    const size_t space = page_aligned(Size);
+    std::vector<unsigned char> vec((space + page - 1) / page);
+    if (mincore(Buffer, space, vec.data()) != 0)
+      return 0;
+
+    size_t pages = 0;
+    for (unsigned char v : vec)
+      pages += v & 1;
+
+    return min(pages * page, space);
+  }
+
+  /**
+   * memoryReport() - Breakdown of the memory used by this array.
+   * @payload: Number of bits of the array actually storing data.
+   *
+   * The DArray object itself is not taken into account: it is part of the metadata of its owner.
+   *
+   */
+  MemoryReport memoryReport(size_t payload) const {
+    MemoryReport report;
+    report.Payload = payload;
+    report.Holes = Size * sizeof(T) * 8 - payload;
+    report.Pages = (page_aligned(Size) - Size * sizeof(T)) * 8;
+    report.Resident = resident() * 8;
+    return report;
+  }
+
 private:
-  static size_t page_aligned(size_t size) {
-#ifdef HFT_FORCE_HUGETLBPAGE
-    return ((2 * 1024 * 1024 - 1) | (size * sizeof(T) - 1)) + 1;
+  static size_t page_aligned(size_t size) { return ((PAGESIZE - 1) | (size * sizeof(T) - 1)) + 1; }
+
+  // @mem, unless it is MAP_FAILED: then the error of the mapping is thrown (without exceptions,
+  // printed before aborting)
+  static void *mapped(void *mem, const char *what) {
+    if (mem == MAP_FAILED) {
+#ifdef __cpp_exceptions
+      throw std::system_error(errno, std::generic_category(), what);
 #else
-    return ((4 * 1024 - 1) | (size * sizeof(T) - 1)) + 1;
+      std::cerr << what << ": " << std::strerror(errno) << std::endl;
+      std::abort();
 #endif
+    }
+
+    return mem;
   }
 
   friend std::ostream &operator<<(std::ostream &os, const DArray<T> &darray) {
@@ -13,3 +13,7 @@
 #include "fenwick/bitl.hpp"
 
 #include "fenwick/hybrid.hpp"
+
+#include "fenwick/replicated.hpp"
+
+#include "fenwick/capture.hpp"
@@ -6,25 +6,27 @@
 namespace hft::fenwick {
 
 /**
- * class BitF - bit compression and classical node layout.
+ * class HoledBitF - bit compression and classical node layout, with a given hole policy.
  * @sequence: sequence of integers.
  * @size: number of elements.
  * @BOUND: maximum value that @sequence can store.
+ * @HOLES: hole policy (see Holes).
  *
  */
-template <size_t BOUND> class BitF : public FenwickTree {
+template <size_t BOUND, typename HOLES> class HoledBitF : public FenwickTree {
 public:
   static constexpr size_t BOUNDSIZE = ceil_log2_plus1(BOUND);
   static constexpr size_t STARTING_OFFSET = 1;
   static constexpr size_t END_PADDING = 56;
   static_assert(BOUNDSIZE >= 1 && BOUNDSIZE <= 55, "Some nodes will span on multiple words");
+  static_assert(!HOLES::Xor, "Nodes straddle cache lines: only FixedF can permute them");
 
 protected:
   size_t Size;
   DArray<uint8_t> Tree;
 
 public:
-  BitF(uint64_t sequence[], size_t size)
+  HoledBitF(uint64_t sequence[], size_t size)
       : Size(size), Tree((first_bit_after(size) + END_PADDING + 7) >> 3) {
     for (size_t idx = 1; idx <= size; idx++)
       addToPartialFrequency(idx, sequence[idx - 1]);
@@ -35,9 +37,11 @@ public:
   }
 
   virtual uint64_t prefix(size_t idx) const {
+    HFT_PROBE(Statistics.Prefix);
     uint64_t sum = 0;
 
     while (idx != 0) {
+      HFT_NODE(&Tree[first_bit_after(idx - 1) / 8], 8, holes(idx - 1));
       sum += getPartialFrequency(idx);
       idx = clear_rho(idx);
     }
@@ -46,7 +50,10 @@ public:
   }
 
   virtual void add(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Add);
+
     while (idx <= Size) {
+      HFT_NODE(&Tree[first_bit_after(idx - 1) / 8], 8, holes(idx - 1));
       addToPartialFrequency(idx, inc);
       idx += mask_rho(idx);
     }
@@ -54,12 +61,14 @@ public:
 
   using FenwickTree::find;
   virtual size_t find(uint64_t *val) const {
+    HFT_PROBE(Statistics.Find);
     size_t node = 0;
 
     for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
       if (node + m > Size)
         continue;
 
+      HFT_NODE(&Tree[first_bit_after(node + m - 1) / 8], 8, holes(node + m - 1));
       const uint64_t value = getPartialFrequency(node + m);
 
       if (*val >= value) {
@@ -73,12 +82,14 @@ public:
 
   using FenwickTree::compFind;
   virtual size_t compFind(uint64_t *val) const {
+    HFT_PROBE(Statistics.CompFind);
     size_t node = 0;
 
     for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
       if (node + m > Size)
         continue;
 
+      HFT_NODE(&Tree[first_bit_after(node + m - 1) / 8], 8, holes(node + m - 1));
       const int height = rho(node + m);
       const uint64_t value = (BOUND << height) - getPartialFrequency(node + m);
 
@@ -91,15 +102,75 @@ public:
     return node;
   }
 
+  virtual uint64_t prefixAndAdd(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Prefix);
+    uint64_t sum = 0;
+    size_t node = 0;
+
+    for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
+      if (node + m > Size)
+        continue;
+
+      HFT_NODE(&Tree[first_bit_after(node + m - 1) / 8], 8, holes(node + m - 1));
+      if (node + m <= idx) {
+        sum += getPartialFrequency(node + m);
+        node += m;
+      } else
+        addToPartialFrequency(node + m, inc);
+    }
+
+    return sum;
+  }
+
+  using FenwickTree::findAndAdd;
+  virtual size_t findAndAdd(uint64_t *val, int64_t inc) {
+    HFT_PROBE(Statistics.Find);
+    size_t node = 0;
+
+    for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
+      if (node + m > Size)
+        continue;
+
+      HFT_NODE(&Tree[first_bit_after(node + m - 1) / 8], 8, holes(node + m - 1));
+      const uint64_t value = getPartialFrequency(node + m);
+
+      if (*val >= value) {
+        node += m;
+        *val -= value;
+      } else
+        addToPartialFrequency(node + m, inc);
+    }
+
+    return node;
+  }
+
   virtual size_t size() const { return Size; }
 
   virtual size_t bitCount() const {
-    return sizeof(BitF<BOUNDSIZE>) * 8 + Tree.bitCount() - sizeof(Tree);
+    return sizeof(HoledBitF<BOUND, HOLES>) * 8 + Tree.bitCount() - sizeof(Tree) * 8;
+  }
+
+  virtual MemoryReport memoryReport() const {
+    const size_t bits = payload(Size, [](size_t height) { return BOUNDSIZE + height; });
+
+    MemoryReport report = Tree.memoryReport(bits);
+    report.Metadata = sizeof(HoledBitF<BOUND, HOLES>) * 8;
+    return report;
+  }
+
+  /**
+   * node() - Bits occupied by the node of index @idx in a tree of @size elements.
+   *
+   */
+  static Span node(size_t, size_t idx) {
+    return {first_bit_after(idx - 1), BOUNDSIZE + rho(idx)};
   }
 
 private:
   // TODO: try the last micro-improvement (email 05/05/19 09:51)
-  inline static size_t holes(size_t idx) { return STARTING_OFFSET + (idx >> 14) * 64; }
+  inline static size_t holes(size_t idx) {
+    return STARTING_OFFSET + HOLES::count(idx) * ((HOLES::Bits + 63) & ~size_t(63));
+  }
 
   inline static size_t first_bit_after(size_t idx) {
     return (BOUNDSIZE + 1) * idx - popcount(idx) + holes(idx);
@@ -140,14 +211,14 @@ private:
     }
   }
 
-  friend std::ostream &operator<<(std::ostream &os, const BitF<BOUND> &ft) {
+  friend std::ostream &operator<<(std::ostream &os, const HoledBitF<BOUND, HOLES> &ft) {
     const uint64_t nsize = hton((uint64_t)ft.Size);
     os.write((char *)&nsize, sizeof(uint64_t));
 
     return os << ft.Tree;
   }
 
-  friend std::istream &operator>>(std::istream &is, BitF<BOUND> &ft) {
+  friend std::istream &operator>>(std::istream &is, HoledBitF<BOUND, HOLES> &ft) {
     uint64_t nsize;
     is.read((char *)(&nsize), sizeof(uint64_t));
     ft.Size = ntoh(nsize);
@@ -156,6 +227,14 @@ private:
   }
 };
 
+/**
+ * BitF - HoledBitF with the default hole policy (see DefaultHoles).
+ *
+ * Its only parameter is the bound, so that it matches a template <size_t> class parameter.
+ *
+ */
+template <size_t BOUND> using BitF = HoledBitF<BOUND, DefaultHoles<14, 64>>;
+
 } // namespace hft::fenwick
 
 #endif // __FENWICK_BITF_HPP__
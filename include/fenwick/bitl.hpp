@@ -49,11 +49,13 @@ public:
   }
 
   virtual uint64_t prefix(size_t idx) const {
+    HFT_PROBE(Statistics.Prefix);
     uint64_t sum = 0;
 
     while (idx != 0) {
       const int height = rho(idx);
       const size_t pos = Level[height] + (idx >> (1 + height)) * (BOUNDSIZE + height);
+      HFT_NODE(&Tree[pos / 8], (pos % 8 + BOUNDSIZE + height + 7) / 8);
       sum += bitread(&Tree[pos / 8], pos % 8, BOUNDSIZE + height);
 
       idx = clear_rho(idx);
@@ -63,9 +65,12 @@ public:
   }
 
   virtual void add(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Add);
+
     while (idx <= Size) {
       const int height = rho(idx);
       const size_t pos = Level[height] + (idx >> (1 + height)) * (BOUNDSIZE + height);
+      HFT_NODE(&Tree[pos / 8], (pos % 8 + BOUNDSIZE + height + 7) / 8);
       bitwrite_inc(&Tree[pos / 8], pos % 8, BOUNDSIZE + height, inc);
 
       idx += mask_rho(idx);
@@ -74,6 +79,7 @@ public:
 
   using FenwickTree::find;
   virtual size_t find(uint64_t *val) const {
+    HFT_PROBE(Statistics.Find);
     size_t node = 0, idx = 0;
 
     for (size_t height = Levels - 2; height != SIZE_MAX; height--) {
@@ -84,6 +90,7 @@ public:
       if (pos >= Level[height + 1])
         continue;
 
+      HFT_NODE(&Tree[pos / 8], (pos % 8 + BOUNDSIZE + height + 7) / 8);
       const uint64_t value = bitread(&Tree[pos / 8], pos % 8, BOUNDSIZE + height);
 
       if (*val >= value) {
@@ -98,6 +105,7 @@ public:
 
   using FenwickTree::compFind;
   virtual size_t compFind(uint64_t *val) const {
+    HFT_PROBE(Statistics.CompFind);
     size_t node = 0, idx = 0;
 
     for (size_t height = Levels - 2; height != SIZE_MAX; height--) {
@@ -108,6 +116,7 @@ public:
       if (pos >= Level[height + 1])
         continue;
 
+      HFT_NODE(&Tree[pos / 8], (pos % 8 + BOUNDSIZE + height + 7) / 8);
       const uint64_t value =
           (BOUND << height) - bitread(&Tree[pos / 8], pos % 8, BOUNDSIZE + height);
 
@@ -121,13 +130,86 @@ public:
     return min(node, Size);
   }
 
+  virtual uint64_t prefixAndAdd(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Prefix);
+    uint64_t sum = 0;
+    size_t node = 0, level_idx = 0;
+
+    for (size_t height = Levels - 2; height != SIZE_MAX; height--) {
+      const size_t pos = Level[height] + level_idx * (BOUNDSIZE + height);
+
+      level_idx <<= 1;
+
+      if (pos >= Level[height + 1])
+        continue;
+
+      HFT_NODE(&Tree[pos / 8], (pos % 8 + BOUNDSIZE + height + 7) / 8);
+      if (node + (1ULL << height) <= idx) {
+        sum += bitread(&Tree[pos / 8], pos % 8, BOUNDSIZE + height);
+        level_idx++;
+        node += 1ULL << height;
+      } else
+        bitwrite_inc(&Tree[pos / 8], pos % 8, BOUNDSIZE + height, inc);
+    }
+
+    return sum;
+  }
+
+  using FenwickTree::findAndAdd;
+  virtual size_t findAndAdd(uint64_t *val, int64_t inc) {
+    HFT_PROBE(Statistics.Find);
+    size_t node = 0, idx = 0;
+
+    for (size_t height = Levels - 2; height != SIZE_MAX; height--) {
+      const size_t pos = Level[height] + idx * (BOUNDSIZE + height);
+
+      idx <<= 1;
+
+      if (pos >= Level[height + 1])
+        continue;
+
+      HFT_NODE(&Tree[pos / 8], (pos % 8 + BOUNDSIZE + height + 7) / 8);
+      const uint64_t value = bitread(&Tree[pos / 8], pos % 8, BOUNDSIZE + height);
+
+      if (*val >= value) {
+        idx++;
+        *val -= value;
+        node += 1ULL << height;
+      } else
+        bitwrite_inc(&Tree[pos / 8], pos % 8, BOUNDSIZE + height, inc);
+    }
+
+    return min(node, Size);
+  }
+
   virtual size_t size() const { return Size; }
 
   virtual size_t bitCount() const {
-    return sizeof(BitL<BOUNDSIZE>) * 8 + Tree.bitCount() - sizeof(Tree) +
+    return sizeof(BitL<BOUND>) * 8 + Tree.bitCount() - sizeof(Tree) * 8 +
            Levels * sizeof(size_t) * 8;
   }
 
+  virtual MemoryReport memoryReport() const {
+    const size_t bits = payload(Size, [](size_t height) { return BOUNDSIZE + height; });
+
+    MemoryReport report = Tree.memoryReport(bits);
+    report.Metadata = sizeof(BitL<BOUND>) * 8 + Levels * sizeof(size_t) * 8;
+    return report;
+  }
+
+  /**
+   * node() - Bits occupied by the node of index @idx in a tree of @size elements.
+   *
+   */
+  static Span node(size_t size, size_t idx) {
+    const size_t height = rho(idx);
+    size_t level = 0;
+    for (size_t i = 1; i <= height; i++)
+      level += ((size + (1ULL << (i - 1))) / (1ULL << i)) * (BOUNDSIZE - 1 + i);
+
+    return {level + (idx >> (1 + height)) * (BOUNDSIZE + height), BOUNDSIZE + height};
+  }
+
 private:
   friend std::ostream &operator<<(std::ostream &os, const BitL<BOUND> &ft) {
     const uint64_t nsize = hton((uint64_t)ft.Size);
@@ -6,23 +6,43 @@
 namespace hft::fenwick {
 
 /**
- * class ByteF - byte compression and classical node layout.
+ * byteHoles() - Default spacing of the holes of ByteF, as a power of two (zero: no holes).
+ *
+ * Exhaustive benchmarking shows it is better to use no holes on (relatively) small trees, but we
+ * expect holes to be handy again in (very) big trees.
+ *
+ */
+constexpr size_t byteHoles(size_t boundsize) {
+  if (boundsize >= 32)
+    return 0;
+
+#ifdef HFT_DISABLE_TRANSHUGE
+  return 18 + (64 - boundsize) % 8;
+#else
+  return 28 + (64 - boundsize) % 8;
+#endif
+}
+
+/**
+ * class HoledByteF - byte compression and classical node layout, with a given hole policy.
  * @sequence: sequence of integers.
  * @size: number of elements.
  * @BOUND: maximum value that @sequence can store.
+ * @HOLES: hole policy (see Holes).
  *
  */
-template <size_t BOUND> class ByteF : public FenwickTree {
+template <size_t BOUND, typename HOLES> class HoledByteF : public FenwickTree {
 public:
   static constexpr size_t BOUNDSIZE = ceil_log2_plus1(BOUND);
   static_assert(BOUNDSIZE >= 1 && BOUNDSIZE <= 64, "Leaves can't be stored in a 64-bit word");
+  static_assert(!HOLES::Xor, "Nodes straddle cache lines: only FixedF can permute them");
 
 protected:
   size_t Size;
   DArray<uint8_t> Tree;
 
 public:
-  ByteF(uint64_t sequence[], size_t size) : Size(size), Tree(pos(size + 1) + 8) {
+  HoledByteF(uint64_t sequence[], size_t size) : Size(size), Tree(pos(size + 1) + 8) {
     for (size_t i = 1; i <= size; i++)
       bytewrite(&Tree[pos(i)], bytesize(i), sequence[i - 1]);
 
@@ -36,9 +56,11 @@ public:
   }
 
   virtual uint64_t prefix(size_t idx) const {
+    HFT_PROBE(Statistics.Prefix);
     uint64_t sum = 0;
 
     while (idx != 0) {
+      HFT_NODE(&Tree[pos(idx)], 8, holes(idx - 1));
       sum += byteread(&Tree[pos(idx)], bytesize(idx));
       idx = clear_rho(idx);
     }
@@ -47,7 +69,10 @@ public:
   }
 
   virtual void add(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Add);
+
     while (idx <= Size) {
+      HFT_NODE(&Tree[pos(idx)], 8, holes(idx - 1));
       bytewrite_inc(&Tree[pos(idx)], inc);
       idx += mask_rho(idx);
     }
@@ -55,12 +80,14 @@ public:
 
   using FenwickTree::find;
   virtual size_t find(uint64_t *val) const {
+    HFT_PROBE(Statistics.Find);
     size_t node = 0;
 
     for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
       if (node + m > Size)
         continue;
 
+      HFT_NODE(&Tree[pos(node + m)], 8, holes(node + m - 1));
       const uint64_t value = byteread(&Tree[pos(node + m)], bytesize(node + m));
 
       if (*val >= value) {
@@ -74,12 +101,14 @@ public:
 
   using FenwickTree::compFind;
   virtual size_t compFind(uint64_t *val) const {
+    HFT_PROBE(Statistics.CompFind);
     size_t node = 0;
 
     for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
       if (node + m > Size)
         continue;
 
+      HFT_NODE(&Tree[pos(node + m)], 8, holes(node + m - 1));
       const uint64_t value =
           (BOUND << rho(node + m)) - byteread(&Tree[pos(node + m)], bytesize(node + m));
 
@@ -92,27 +121,72 @@ public:
     return node;
   }
 
+  virtual uint64_t prefixAndAdd(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Prefix);
+    uint64_t sum = 0;
+    size_t node = 0;
+
+    for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
+      if (node + m > Size)
+        continue;
+
+      HFT_NODE(&Tree[pos(node + m)], 8, holes(node + m - 1));
+      if (node + m <= idx) {
+        sum += byteread(&Tree[pos(node + m)], bytesize(node + m));
+        node += m;
+      } else
+        bytewrite_inc(&Tree[pos(node + m)], inc);
+    }
+
+    return sum;
+  }
+
+  using FenwickTree::findAndAdd;
+  virtual size_t findAndAdd(uint64_t *val, int64_t inc) {
+    HFT_PROBE(Statistics.Find);
+    size_t node = 0;
+
+    for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
+      if (node + m > Size)
+        continue;
+
+      HFT_NODE(&Tree[pos(node + m)], 8, holes(node + m - 1));
+      const uint64_t value = byteread(&Tree[pos(node + m)], bytesize(node + m));
+
+      if (*val >= value) {
+        node += m;
+        *val -= value;
+      } else
+        bytewrite_inc(&Tree[pos(node + m)], inc);
+    }
+
+    return node;
+  }
+
   virtual size_t size() const { return Size; }
 
   virtual size_t bitCount() const {
-    return sizeof(ByteF<BOUNDSIZE>) * 8 + Tree.bitCount() - sizeof(Tree);
+    return sizeof(HoledByteF<BOUND, HOLES>) * 8 + Tree.bitCount() - sizeof(Tree) * 8;
+  }
+
+  virtual MemoryReport memoryReport() const {
+    const size_t bits = payload(Size, [](size_t height) { return bytesize(1ULL << height) * 8; });
+
+    MemoryReport report = Tree.memoryReport(bits);
+    report.Metadata = sizeof(HoledByteF<BOUND, HOLES>) * 8;
+    return report;
   }
 
+  /**
+   * node() - Bits occupied by the node of index @idx in a tree of @size elements.
+   *
+   */
+  static Span node(size_t, size_t idx) { return {pos(idx) * 8, bytesize(idx) * 8}; }
+
 private:
   static inline size_t bytesize(size_t idx) { return ((rho(idx) + BOUNDSIZE - 1) >> 3) + 1; }
 
-  static inline size_t holes(size_t idx) {
-    // Exhaustive benchmarking shows it is better to use no holes on (relatively) small trees,
-    // but we expect holes to be handy again in (very) big trees
-    if (BOUNDSIZE >= 32)
-      return 0;
-
-#ifdef HFT_DISABLE_TRANSHUGE
-    return (idx >> (18 + (64 - BOUNDSIZE) % 8));
-#else
-    return (idx >> (28 + (64 - BOUNDSIZE) % 8));
-#endif
-  }
+  static inline size_t holes(size_t idx) { return HOLES::count(idx) * ((HOLES::Bits + 7) / 8); }
 
   static inline size_t pos(size_t idx) {
     idx--;
@@ -127,14 +201,14 @@ private:
     return idx * SMALL + (idx >> MEDIUM) + (idx >> LARGE) * MULTIPLIER + holes(idx);
   }
 
-  friend std::ostream &operator<<(std::ostream &os, const ByteF<BOUND> &ft) {
+  friend std::ostream &operator<<(std::ostream &os, const HoledByteF<BOUND, HOLES> &ft) {
     uint64_t nsize = hton((uint64_t)ft.Size);
     os.write((char *)&nsize, sizeof(uint64_t));
 
     return os << ft.Tree;
   }
 
-  friend std::istream &operator>>(std::istream &is, ByteF<BOUND> &ft) {
+  friend std::istream &operator>>(std::istream &is, HoledByteF<BOUND, HOLES> &ft) {
     uint64_t nsize;
     is.read((char *)(&nsize), sizeof(uint64_t));
     ft.Size = ntoh(nsize);
@@ -143,6 +217,15 @@ private:
   }
 };
 
+/**
+ * ByteF - HoledByteF with the default hole policy (see DefaultHoles).
+ *
+ * Its only parameter is the bound, so that it matches a template <size_t> class parameter.
+ *
+ */
+template <size_t BOUND>
+using ByteF = HoledByteF<BOUND, DefaultHoles<byteHoles(ceil_log2_plus1(BOUND)), 8>>;
+
 } // namespace hft::fenwick
 
 #endif // __FENWICK_BYTEF_HPP__
@@ -50,6 +50,7 @@ public:
   }
 
   virtual uint64_t prefix(size_t idx) const {
+    HFT_PROBE(Statistics.Prefix);
     uint64_t sum = 0;
 
     while (idx != 0) {
@@ -57,6 +58,7 @@ public:
       const size_t isize = heightsize(height);
       const size_t pos = Level[height] + (idx >> (1 + height)) * isize;
 
+      HFT_NODE(&Tree[pos], 8);
       sum += byteread(&Tree[pos], isize);
       idx = clear_rho(idx);
     }
@@ -65,11 +67,14 @@ public:
   }
 
   virtual void add(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Add);
+
     while (idx <= Size) {
       const int height = rho(idx);
       const size_t isize = heightsize(height);
       const size_t pos = Level[height] + (idx >> (1 + height)) * isize;
 
+      HFT_NODE(&Tree[pos], 8);
       bytewrite_inc(&Tree[pos], inc);
       idx += mask_rho(idx);
     }
@@ -77,6 +82,7 @@ public:
 
   using FenwickTree::find;
   virtual size_t find(uint64_t *val) const {
+    HFT_PROBE(Statistics.Find);
     size_t node = 0, idx = 0;
 
     for (int height = Levels - 2; height >= 0; --height) {
@@ -88,6 +94,7 @@ public:
       if (pos >= Level[height + 1])
         continue;
 
+      HFT_NODE(&Tree[pos], 8);
       const uint64_t value = byteread(&Tree[pos], isize);
 
       if (*val >= value) {
@@ -102,6 +109,7 @@ public:
 
   using FenwickTree::compFind;
   virtual size_t compFind(uint64_t *val) const {
+    HFT_PROBE(Statistics.CompFind);
     size_t node = 0, idx = 0;
 
     for (size_t height = Levels - 2; height != SIZE_MAX; height--) {
@@ -113,6 +121,7 @@ public:
       if (pos >= Level[height + 1])
         continue;
 
+      HFT_NODE(&Tree[pos], 8);
       const uint64_t value = (BOUND << height) - byteread(&Tree[pos], isize);
 
       if (*val >= value) {
@@ -125,13 +134,88 @@ public:
     return min(node, Size);
   }
 
+  virtual uint64_t prefixAndAdd(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Prefix);
+    uint64_t sum = 0;
+    size_t node = 0, level_idx = 0;
+
+    for (size_t height = Levels - 2; height != SIZE_MAX; height--) {
+      const size_t isize = heightsize(height);
+      const size_t pos = Level[height] + level_idx * isize;
+
+      level_idx <<= 1;
+
+      if (pos >= Level[height + 1])
+        continue;
+
+      HFT_NODE(&Tree[pos], 8);
+      if (node + (1ULL << height) <= idx) {
+        sum += byteread(&Tree[pos], isize);
+        level_idx++;
+        node += 1ULL << height;
+      } else
+        bytewrite_inc(&Tree[pos], inc);
+    }
+
+    return sum;
+  }
+
+  using FenwickTree::findAndAdd;
+  virtual size_t findAndAdd(uint64_t *val, int64_t inc) {
+    HFT_PROBE(Statistics.Find);
+    size_t node = 0, idx = 0;
+
+    for (size_t height = Levels - 2; height != SIZE_MAX; height--) {
+      const size_t isize = heightsize(height);
+      const size_t pos = Level[height] + idx * isize;
+
+      idx <<= 1;
+
+      if (pos >= Level[height + 1])
+        continue;
+
+      HFT_NODE(&Tree[pos], 8);
+      const uint64_t value = byteread(&Tree[pos], isize);
+
+      if (*val >= value) {
+        idx++;
+        *val -= value;
+        node += 1ULL << height;
+      } else
+        bytewrite_inc(&Tree[pos], inc);
+    }
+
+    return min(node, Size);
+  }
+
   virtual size_t size() const { return Size; }
 
   virtual size_t bitCount() const {
-    return sizeof(ByteL<BOUNDSIZE>) * 8 + Tree.bitCount() - sizeof(Tree) +
+    return sizeof(ByteL<BOUND>) * 8 + Tree.bitCount() - sizeof(Tree) * 8 +
            Levels * sizeof(size_t) * 8;
   }
 
+  virtual MemoryReport memoryReport() const {
+    const size_t bits = payload(Size, [](size_t height) { return heightsize(height) * 8; });
+
+    MemoryReport report = Tree.memoryReport(bits);
+    report.Metadata = sizeof(ByteL<BOUND>) * 8 + Levels * sizeof(size_t) * 8;
+    return report;
+  }
+
+  /**
+   * node() - Bits occupied by the node of index @idx in a tree of @size elements.
+   *
+   */
+  static Span node(size_t size, size_t idx) {
+    const size_t height = rho(idx);
+    size_t level = 0;
+    for (size_t i = 1; i <= height; i++)
+      level += ((size + (1ULL << (i - 1))) / (1ULL << i)) * heightsize(i - 1);
+
+    return {(level + (idx >> (1 + height)) * heightsize(height)) * 8, heightsize(height) * 8};
+  }
+
 private:
   static inline size_t heightsize(size_t height) { return ((height + BOUNDSIZE - 1) >> 3) + 1; }
 
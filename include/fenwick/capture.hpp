@@ -0,0 +1,80 @@
+#ifndef __FENWICK_CAPTURE_HPP__
+#define __FENWICK_CAPTURE_HPP__
+
+#include "../trace.hpp"
+#include "fenwick_tree.hpp"
+
+namespace hft::fenwick {
+
+/**
+ * class Capture - Log every operation on a Fenwick tree to a trace file.
+ * @sequence: sequence of integers.
+ * @size: number of elements.
+ * @filename: trace file (see hft::trace).
+ * @T: Traced Fenwick tree (e.g. FixedF<64> or Hybrid<ByteL, BitF, 64, 16>).
+ *
+ * The trace starts with a snapshot of @sequence, so that it can be replayed on any other tree.
+ * Logging is buffered and not thread-safe.
+ *
+ */
+template <typename T> class Capture : public FenwickTree {
+protected:
+  T Tree;
+  mutable trace::Writer Log;
+
+public:
+  Capture(uint64_t sequence[], size_t size, const std::string &filename)
+      : Tree(sequence, size), Log(filename, trace::FENWICK, sequence, size) {}
+
+  virtual uint64_t prefix(size_t idx) const {
+    Log.log(trace::PREFIX, idx);
+    return Tree.prefix(idx);
+  }
+
+  virtual void add(size_t idx, int64_t inc) {
+    Log.log(trace::ADD, idx, inc);
+    Tree.add(idx, inc);
+  }
+
+  using FenwickTree::find;
+  virtual size_t find(uint64_t *val) const {
+    Log.log(trace::FIND, 0, *val);
+    return Tree.find(val);
+  }
+
+  using FenwickTree::compFind;
+  virtual size_t compFind(uint64_t *val) const {
+    Log.log(trace::COMPFIND, 0, *val);
+    return Tree.compFind(val);
+  }
+
+  virtual size_t size() const { return Tree.size(); }
+
+  virtual size_t bitCount() const { return (sizeof(Capture<T>) - sizeof(T)) * 8 + Tree.bitCount(); }
+
+  virtual MemoryReport memoryReport() const {
+    MemoryReport report = Tree.memoryReport();
+    report.Metadata += (sizeof(Capture<T>) - sizeof(T)) * 8;
+    return report;
+  }
+
+  virtual Stats stats() const { return Tree.stats(); }
+
+  virtual void resetStats() { Tree.resetStats(); }
+
+  /**
+   * tree() - The traced tree (operations on it are not logged).
+   *
+   */
+  const T &tree() const { return Tree; }
+
+  /**
+   * flush() - Write the buffered records to the trace file.
+   *
+   */
+  void flush() { Log.flush(); }
+};
+
+} // namespace hft::fenwick
+
+#endif // __FENWICK_CAPTURE_HPP__
@@ -3,9 +3,24 @@
 
 #include "../common.hpp"
 #include "../darray.hpp"
+#include "../stats.hpp"
+#include "holes.hpp"
 
 namespace hft::fenwick {
 
+/**
+ * struct Span - Bits of the array of a tree occupied by a node.
+ * @Bit: Offset of the first bit, from the beginning of the (page-aligned) array.
+ * @Bits: Width of the node.
+ *
+ * Trees with a single array expose the position of their nodes with a static node(size, idx)
+ * member, which the cost model of hft::model relies on.
+ *
+ */
+struct Span {
+  size_t Bit, Bits;
+};
+
 /**
  * FenwickTree - Fenwick Tree data structure interface.
  * @sequence: An integer vector.
@@ -67,6 +82,43 @@ public:
   virtual size_t compFind(uint64_t *val) const = 0;
   size_t compFind(uint64_t val) const { return compFind(&val); }
 
+  /**
+   * prefixAndAdd() - Compute a prefix sum and increment the element following it.
+   * @idx: Length of the prefix sum.
+   * @inc: Value to sum to the element of index @idx + 1.
+   *
+   * Same as prefix(@idx) followed by add(@idx + 1, @inc) (nothing is added if @idx is the size of
+   * the sequence), but the trees share a single top-down traversal: the nodes it skips on its way
+   * to @idx are exactly the ones covering @idx + 1. Returns the prefix sum.
+   *
+   */
+  virtual uint64_t prefixAndAdd(size_t idx, int64_t inc) {
+    const uint64_t sum = prefix(idx);
+    if (idx < size())
+      add(idx + 1, inc);
+
+    return sum;
+  }
+
+  /**
+   * findAndAdd() - Search the closest prefix and increment the element following it.
+   * @val: Prefix to search.
+   * @inc: Value to sum to the element of index find(@val) + 1.
+   *
+   * Same as find(@val) followed by add(find(@val) + 1, @inc), i.e. @inc goes to the element @val
+   * falls into (e.g. the one drawn by a weighted sampling), sharing a single traversal. Nothing is
+   * added if there is no such an element.
+   *
+   */
+  virtual size_t findAndAdd(uint64_t *val, int64_t inc) {
+    const size_t idx = find(val);
+    if (idx < size())
+      add(idx + 1, inc);
+
+    return idx;
+  }
+  size_t findAndAdd(uint64_t val, int64_t inc) { return findAndAdd(&val, inc); }
+
   /**
    * size() - Returns the length of the sequence.
    *
@@ -79,6 +131,39 @@ public:
    */
   virtual size_t bitCount() const = 0;
 
+  /**
+   * memoryReport() - Breakdown of the memory used by this structure.
+   *
+   * Unlike bitCount() it tells apart the bits storing the nodes from the ones lost in holes,
+   * padding and page rounding, and it measures how much memory is actually resident.
+   *
+   */
+  virtual MemoryReport memoryReport() const = 0;
+
+  /**
+   * stats() - Snapshot of the instrumentation counters.
+   *
+   * It is always empty unless HFT_INSTRUMENT is defined (see hft::Stats).
+   *
+   */
+  virtual Stats stats() const {
+#ifdef HFT_INSTRUMENT
+    return Statistics;
+#else
+    return Stats();
+#endif
+  }
+
+  /**
+   * resetStats() - Zero the instrumentation counters.
+   *
+   */
+  virtual void resetStats() {
+#ifdef HFT_INSTRUMENT
+    Statistics = Stats();
+#endif
+  }
+
   /**
    * Each FenwickTree is serializable and deserializable with:
    * - friend std::ostream &operator<<(std::ostream &os, const FenwickTree &ft);
@@ -92,6 +177,25 @@ public:
    * very same data with a ByteL).
    *
    */
+
+protected:
+#ifdef HFT_INSTRUMENT
+  mutable Stats Statistics;
+#endif
+
+  /**
+   * payload() - Number of bits needed to store the nodes of a tree.
+   * @size: Number of nodes.
+   * @width: Callable returning the width (in bits) of a node given its height.
+   *
+   */
+  template <typename Width> static size_t payload(size_t size, Width width) {
+    size_t bits = 0;
+    for (size_t h = 0; (size >> h) != 0; h++)
+      bits += ((size >> h) - (size >> (h + 1))) * width(h);
+
+    return bits;
+  }
 };
 
 } // namespace hft::fenwick
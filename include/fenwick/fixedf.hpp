@@ -6,13 +6,14 @@
 namespace hft::fenwick {
 
 /**
- * class FixedF - no compression and classical node layout.
+ * class HoledFixedF - no compression and classical node layout, with a given hole policy.
  * @sequence: sequence of integers.
  * @size: number of elements.
  * @BOUND: maximum value that @sequence can store.
+ * @HOLES: hole and scattering policy (see Holes).
  *
  */
-template <size_t BOUND> class FixedF : public FenwickTree {
+template <size_t BOUND, typename HOLES> class HoledFixedF : public FenwickTree {
 public:
   static constexpr size_t BOUNDSIZE = ceil_log2_plus1(BOUND);
   static_assert(BOUNDSIZE >= 1 && BOUNDSIZE <= 64, "Leaves can't be stored in a 64-bit word");
@@ -22,7 +23,8 @@ protected:
   DArray<uint64_t> Tree;
 
 public:
-  FixedF(uint64_t sequence[], size_t size) : Size(size), Tree(pos(size) + 1) {
+  HoledFixedF(uint64_t sequence[], size_t size)
+      : Size(size), Tree(HOLES::words(size + holes(size) + 1)) {
     for (size_t j = 1; j <= size; j++)
       Tree[pos(j)] = sequence[j - 1];
 
@@ -33,9 +35,11 @@ public:
   }
 
   virtual uint64_t prefix(size_t idx) const {
+    HFT_PROBE(Statistics.Prefix);
     uint64_t sum = 0;
 
     while (idx != 0) {
+      HFT_NODE(&Tree[pos(idx)], 8, holes(idx));
       sum += Tree[pos(idx)];
       idx = clear_rho(idx);
     }
@@ -44,7 +48,10 @@ public:
   }
 
   virtual void add(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Add);
+
     while (idx <= Size) {
+      HFT_NODE(&Tree[pos(idx)], 8, holes(idx));
       Tree[pos(idx)] += inc;
       idx += mask_rho(idx);
     }
@@ -52,12 +59,14 @@ public:
 
   using FenwickTree::find;
   virtual size_t find(uint64_t *val) const {
+    HFT_PROBE(Statistics.Find);
     size_t node = 0;
 
     for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
       if (node + m > Size)
         continue;
 
+      HFT_NODE(&Tree[pos(node + m)], 8, holes(node + m));
       uint64_t value = Tree[pos(node + m)];
 
       if (*val >= value) {
@@ -71,12 +80,14 @@ public:
 
   using FenwickTree::compFind;
   virtual size_t compFind(uint64_t *val) const {
+    HFT_PROBE(Statistics.CompFind);
     size_t node = 0;
 
     for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
       if (node + m > Size)
         continue;
 
+      HFT_NODE(&Tree[pos(node + m)], 8, holes(node + m));
       uint64_t value = (BOUND << rho(node + m)) - Tree[pos(node + m)];
 
       if (*val >= value) {
@@ -88,25 +99,79 @@ public:
     return node;
   }
 
+  virtual uint64_t prefixAndAdd(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Prefix);
+    uint64_t sum = 0;
+    size_t node = 0;
+
+    for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
+      if (node + m > Size)
+        continue;
+
+      HFT_NODE(&Tree[pos(node + m)], 8, holes(node + m));
+      if (node + m <= idx) {
+        sum += Tree[pos(node + m)];
+        node += m;
+      } else
+        Tree[pos(node + m)] += inc;
+    }
+
+    return sum;
+  }
+
+  using FenwickTree::findAndAdd;
+  virtual size_t findAndAdd(uint64_t *val, int64_t inc) {
+    HFT_PROBE(Statistics.Find);
+    size_t node = 0;
+
+    for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
+      if (node + m > Size)
+        continue;
+
+      HFT_NODE(&Tree[pos(node + m)], 8, holes(node + m));
+      const uint64_t value = Tree[pos(node + m)];
+
+      if (*val >= value) {
+        node += m;
+        *val -= value;
+      } else
+        Tree[pos(node + m)] += inc;
+    }
+
+    return node;
+  }
+
   virtual size_t size() const { return Size; }
 
   virtual size_t bitCount() const {
-    return sizeof(FixedF<BOUNDSIZE>) * 8 + Tree.bitCount() - sizeof(Tree);
+    return sizeof(HoledFixedF<BOUND, HOLES>) * 8 + Tree.bitCount() - sizeof(Tree) * 8;
+  }
+
+  virtual MemoryReport memoryReport() const {
+    MemoryReport report = Tree.memoryReport(Size * 64);
+    report.Metadata = sizeof(HoledFixedF<BOUND, HOLES>) * 8;
+    return report;
   }
 
+  /**
+   * node() - Bits occupied by the node of index @idx in a tree of @size elements.
+   *
+   */
+  static Span node(size_t, size_t idx) { return {pos(idx) * 64, 64}; }
+
 private:
-  static inline size_t holes(size_t idx) { return idx >> 14; }
+  static inline size_t holes(size_t idx) { return HOLES::count(idx) * ((HOLES::Bits + 63) / 64); }
 
-  static inline size_t pos(size_t idx) { return idx + holes(idx); }
+  static inline size_t pos(size_t idx) { return HOLES::scatter(idx + holes(idx)); }
 
-  friend std::ostream &operator<<(std::ostream &os, const FixedF<BOUND> &ft) {
+  friend std::ostream &operator<<(std::ostream &os, const HoledFixedF<BOUND, HOLES> &ft) {
     uint64_t nsize = hton((uint64_t)ft.Size);
     os.write((char *)&nsize, sizeof(uint64_t));
 
     return os << ft.Tree;
   }
 
-  friend std::istream &operator>>(std::istream &is, FixedF<BOUND> &ft) {
+  friend std::istream &operator>>(std::istream &is, HoledFixedF<BOUND, HOLES> &ft) {
     uint64_t nsize;
     is.read((char *)(&nsize), sizeof(uint64_t));
 
@@ -115,6 +180,14 @@ private:
   }
 };
 
+/**
+ * FixedF - HoledFixedF with the default hole policy (see DefaultHoles).
+ *
+ * Its only parameter is the bound, so that it matches a template <size_t> class parameter.
+ *
+ */
+template <size_t BOUND> using FixedF = HoledFixedF<BOUND, DefaultHoles<14, 64>>;
+
 } // namespace hft::fenwick
 
 #endif // __FENWICK_FIXED_HPP__
@@ -46,11 +46,13 @@ public:
   }
 
   virtual uint64_t prefix(size_t idx) const {
+    HFT_PROBE(Statistics.Prefix);
     uint64_t sum = 0;
 
     while (idx != 0) {
       const int height = rho(idx);
       size_t level_idx = idx >> (1 + height);
+      HFT_NODE(&Tree[Level[height] + level_idx], 8);
       sum += Tree[Level[height] + level_idx];
 
       idx = clear_rho(idx);
@@ -60,9 +62,12 @@ public:
   }
 
   virtual void add(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Add);
+
     while (idx <= Size) {
       const int height = rho(idx);
       size_t level_idx = idx >> (1 + height);
+      HFT_NODE(&Tree[Level[height] + level_idx], 8);
       Tree[Level[height] + level_idx] += inc;
 
       idx += mask_rho(idx);
@@ -71,6 +76,7 @@ public:
 
   using FenwickTree::find;
   virtual size_t find(uint64_t *val) const {
+    HFT_PROBE(Statistics.Find);
     size_t node = 0, idx = 0;
 
     for (size_t height = Levels - 2; height != SIZE_MAX; height--) {
@@ -81,6 +87,7 @@ public:
       if (pos >= Level[height + 1])
         continue;
 
+      HFT_NODE(&Tree[pos], 8);
       uint64_t value = Tree[pos];
       if (*val >= value) {
         idx++;
@@ -94,6 +101,7 @@ public:
 
   using FenwickTree::compFind;
   virtual size_t compFind(uint64_t *val) const {
+    HFT_PROBE(Statistics.CompFind);
     size_t node = 0, idx = 0;
 
     for (size_t height = Levels - 2; height != SIZE_MAX; height--) {
@@ -104,6 +112,7 @@ public:
       if (pos >= Level[height + 1])
         continue;
 
+      HFT_NODE(&Tree[pos], 8);
       uint64_t value = (BOUND << height) - Tree[pos];
       if (*val >= value) {
         idx++;
@@ -115,13 +124,84 @@ public:
     return min(node, Size);
   }
 
+  virtual uint64_t prefixAndAdd(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Prefix);
+    uint64_t sum = 0;
+    size_t node = 0, level_idx = 0;
+
+    for (size_t height = Levels - 2; height != SIZE_MAX; height--) {
+      const size_t pos = Level[height] + level_idx;
+
+      level_idx <<= 1;
+
+      if (pos >= Level[height + 1])
+        continue;
+
+      HFT_NODE(&Tree[pos], 8);
+      if (node + (1ULL << height) <= idx) {
+        sum += Tree[pos];
+        level_idx++;
+        node += 1ULL << height;
+      } else
+        Tree[pos] += inc;
+    }
+
+    return sum;
+  }
+
+  using FenwickTree::findAndAdd;
+  virtual size_t findAndAdd(uint64_t *val, int64_t inc) {
+    HFT_PROBE(Statistics.Find);
+    size_t node = 0, idx = 0;
+
+    for (size_t height = Levels - 2; height != SIZE_MAX; height--) {
+      const size_t pos = Level[height] + idx;
+
+      idx <<= 1;
+
+      if (pos >= Level[height + 1])
+        continue;
+
+      HFT_NODE(&Tree[pos], 8);
+      const uint64_t value = Tree[pos];
+
+      if (*val >= value) {
+        idx++;
+        *val -= value;
+        node += 1ULL << height;
+      } else
+        Tree[pos] += inc;
+    }
+
+    return min(node, Size);
+  }
+
   virtual size_t size() const { return Size; }
 
   virtual size_t bitCount() const {
-    return sizeof(FixedL<BOUNDSIZE>) * 8 + Tree.bitCount() - sizeof(Tree) +
+    return sizeof(FixedL<BOUND>) * 8 + Tree.bitCount() - sizeof(Tree) * 8 +
            Levels * sizeof(size_t) * 8;
   }
 
+  virtual MemoryReport memoryReport() const {
+    MemoryReport report = Tree.memoryReport(Size * 64);
+    report.Metadata = sizeof(FixedL<BOUND>) * 8 + Levels * sizeof(size_t) * 8;
+    return report;
+  }
+
+  /**
+   * node() - Bits occupied by the node of index @idx in a tree of @size elements.
+   *
+   */
+  static Span node(size_t size, size_t idx) {
+    const size_t height = rho(idx);
+    size_t level = 0;
+    for (size_t i = 1; i <= height; i++)
+      level += (size + (1ULL << (i - 1))) / (1ULL << i);
+
+    return {(level + (idx >> (1 + height))) * 64, 64};
+  }
+
 private:
   friend std::ostream &operator<<(std::ostream &os, const FixedL<BOUND> &ft) {
     const uint64_t nsize = hton((uint64_t)ft.Size);
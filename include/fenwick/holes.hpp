@@ -0,0 +1,66 @@
+#ifndef __FENWICK_HOLES_HPP__
+#define __FENWICK_HOLES_HPP__
+
+#include "../common.hpp"
+
+namespace hft::fenwick {
+
+/**
+ * struct Holes - Hole insertion and line scattering policy of the classical node layouts.
+ * @SHIFT: A hole every 2^SHIFT nodes (zero: no holes).
+ * @BITS: Size of a hole in bits, rounded up to the unit of the layout (a word in FixedF and BitF,
+ *        a byte in ByteF).
+ * @XOR: Permute the 64-byte lines of each 4 KiB block, XOR-ing their index with that of the block.
+ *
+ * In the classical layout the nodes visited by a query are powers of two apart, so they tend to
+ * fall in the same cache set: holes shift them apart every now and then, the XOR permutation
+ * scatters them over every set a page covers. Only FixedF, whose nodes never straddle two lines,
+ * can be permuted.
+ *
+ * The policy is part of the type of a tree, like its bound: a serialized tree must be read back
+ * with the same policy.
+ *
+ */
+template <size_t SHIFT, size_t BITS, bool XOR = false> struct Holes {
+  static_assert(SHIFT < 64, "Holes can't be farther than 2^63 nodes");
+
+  static constexpr size_t Shift = SHIFT, Bits = BITS;
+  static constexpr bool Xor = XOR;
+
+  /**
+   * count() - Number of holes before the node of index @idx.
+   *
+   */
+  static constexpr size_t count(size_t idx) { return SHIFT == 0 ? 0 : idx >> SHIFT; }
+
+  /**
+   * scatter() - Index of the 64-bit word @word once the lines are permuted.
+   *
+   */
+  static constexpr size_t scatter(size_t word) {
+    return XOR ? word ^ (((word >> 9) & 63) << 3) : word;
+  }
+
+  /**
+   * words() - Words to allocate for @words words: whole blocks, if the lines are permuted.
+   *
+   */
+  static constexpr size_t words(size_t words) {
+    return XOR ? (words + 511) & ~size_t(511) : words;
+  }
+};
+
+/**
+ * DefaultHoles - Policy of a tree that doesn't choose one: a hole of @BITS bits every 2^@SHIFT
+ * nodes, unless HFT_HOLES overrides the spacing (e.g. -DHFT_HOLES=0 removes every hole).
+ *
+ */
+#ifdef HFT_HOLES
+template <size_t SHIFT, size_t BITS> using DefaultHoles = Holes<HFT_HOLES, BITS>;
+#else
+template <size_t SHIFT, size_t BITS> using DefaultHoles = Holes<SHIFT, BITS>;
+#endif
+
+} // namespace hft::fenwick
+
+#endif // __FENWICK_HOLES_HPP__
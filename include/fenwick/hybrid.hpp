@@ -31,6 +31,7 @@ public:
   }
 
   virtual uint64_t prefix(size_t idx) const {
+    HFT_PROBE(Statistics.Prefix);
     const size_t top = idx >> CUT;
     const size_t bottom = idx & BottomSize;
 
@@ -38,6 +39,7 @@ public:
   }
 
   virtual void add(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Add);
     const size_t top = idx >> CUT;
     const size_t bottom = idx & BottomSize;
 
@@ -51,6 +53,7 @@ public:
 
   using FenwickTree::find;
   virtual size_t find(uint64_t *val) const {
+    HFT_PROBE(Statistics.Find);
     const size_t top = TopFenwick.size() != 0 ? TopFenwick.find(val) : 0;
     const size_t bottom = top < BottomForest.size() ? BottomForest[top].find(val) : 0;
 
@@ -59,6 +62,7 @@ public:
 
   using FenwickTree::compFind;
   virtual size_t compFind(uint64_t *val) const {
+    HFT_PROBE(Statistics.CompFind);
     const size_t top = TopFenwick.size() != 0 ? TopFenwick.compFind(val) : 0;
     const size_t bottom = top < BottomForest.size() ? BottomForest[top].compFind(val) : 0;
 
@@ -72,7 +76,67 @@ public:
     for (auto &t : BottomForest)
       bottomSize += t.bitCount();
 
-    return bottomSize + sizeof(Hybrid<BOTTOM, TOP, BOUND, CUT>) + TopFenwick.bitCount();
+    const size_t spare = BottomForest.capacity() - BottomForest.size();
+    return bottomSize + spare * sizeof(BOTTOM<BOUND>) * 8 +
+           sizeof(Hybrid<TOP, BOTTOM, BOUND, CUT>) * 8 - sizeof(TopFenwick) * 8 +
+           TopFenwick.bitCount();
+  }
+
+  virtual MemoryReport memoryReport() const {
+    MemoryReport report = TopFenwick.memoryReport();
+    for (auto &t : BottomForest)
+      report += t.memoryReport();
+
+    const size_t spare = BottomForest.capacity() - BottomForest.size();
+    report.Metadata += spare * sizeof(BOTTOM<BOUND>) * 8 +
+                       sizeof(Hybrid<TOP, BOTTOM, BOUND, CUT>) * 8 - sizeof(TopFenwick) * 8;
+    return report;
+  }
+
+  /**
+   * stats() - Snapshot of the instrumentation counters.
+   *
+   * Calls are the ones of the hybrid tree, every other counter is the sum of the top and the
+   * bottom counters (see topStats() and bottomStats()).
+   *
+   */
+  virtual Stats stats() const {
+    Stats stats = topStats();
+    stats += bottomStats();
+
+#ifdef HFT_INSTRUMENT
+    stats.Prefix.Calls = Statistics.Prefix.Calls;
+    stats.Add.Calls = Statistics.Add.Calls;
+    stats.Find.Calls = Statistics.Find.Calls;
+    stats.CompFind.Calls = Statistics.CompFind.Calls;
+#endif
+
+    return stats;
+  }
+
+  /**
+   * topStats() - Snapshot of the instrumentation counters of the top tree.
+   *
+   */
+  Stats topStats() const { return TopFenwick.stats(); }
+
+  /**
+   * bottomStats() - Snapshot of the instrumentation counters of the bottom trees (summed).
+   *
+   */
+  Stats bottomStats() const {
+    Stats stats;
+    for (auto &t : BottomForest)
+      stats += t.stats();
+
+    return stats;
+  }
+
+  virtual void resetStats() {
+    FenwickTree::resetStats();
+    TopFenwick.resetStats();
+    for (auto &t : BottomForest)
+      t.resetStats();
   }
 
 private:
@@ -94,7 +158,7 @@ private:
     os.write((char *)&nbottom, sizeof(uint64_t));
 
     os << ft.TopFenwick;
-    for (size_t i = 0; i < nbottom; ++i)
+    for (size_t i = 0; i < ft.BottomForest.size(); ++i)
       os << ft.BottomForest[i];
 
     return os;
@@ -103,9 +167,11 @@ private:
   friend std::istream &operator>>(std::istream &is, Hybrid<TOP, BOTTOM, BOUND, CUT> &ft) {
     uint64_t nsize;
     is.read((char *)(&nsize), sizeof(uint64_t));
+    ft.Size = ntoh(nsize);
 
     uint64_t nbottom;
     is.read((char *)(&nbottom), sizeof(uint64_t));
+    nbottom = ntoh(nbottom);
 
     is >> ft.TopFenwick;
 
@@ -115,6 +181,7 @@ private:
       return bottom;
     };
 
+    ft.BottomForest.clear();
     ft.BottomForest.reserve(nbottom);
     for (size_t i = 0; i < nbottom; ++i)
       ft.BottomForest.push_back(readNextBottom());
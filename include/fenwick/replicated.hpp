@@ -0,0 +1,134 @@
+#ifndef __FENWICK_REPLICATED_HPP__
+#define __FENWICK_REPLICATED_HPP__
+
+#include "../replicas.hpp"
+#include "fenwick_tree.hpp"
+#include <sstream>
+
+namespace hft::fenwick {
+
+/**
+ * class Replicated - One copy of a Fenwick tree per NUMA node.
+ * @sequence: sequence of integers.
+ * @size: number of elements.
+ * @replicas: number of copies (by default, one per NUMA node).
+ * @T: Replicated Fenwick tree (e.g. FixedF<64> or Hybrid<ByteL, BitF, 64, 16>).
+ *
+ * Queries are answered by the replica local to the calling thread, while add() only logs the
+ * increment: every replica applies the pending increments in a batch before its next query (see
+ * hft::Replicas). It is meant for read-dominated workloads, where cross-socket DRAM latency is the
+ * dominant cost of a query.
+ *
+ */
+template <typename T> class Replicated : public FenwickTree {
+private:
+  struct Add {
+    size_t Idx;
+    int64_t Inc;
+  };
+
+  static uint64_t apply(T &tree, const Add &op) {
+    tree.add(op.Idx, op.Inc);
+    return 0;
+  }
+
+protected:
+  size_t Size;
+  mutable Replicas<T, Add, apply> Copies;
+
+public:
+  Replicated(uint64_t sequence[], size_t size, size_t replicas = numa::nodes())
+      : Size(size), Copies(replicas, [&] { return make_unique<T>(sequence, size); }) {}
+
+  virtual uint64_t prefix(size_t idx) const {
+    return Copies.read([&](const T &tree) { return tree.prefix(idx); });
+  }
+
+  virtual void add(size_t idx, int64_t inc) { Copies.post({idx, inc}); }
+
+  using FenwickTree::find;
+  virtual size_t find(uint64_t *val) const {
+    return Copies.read([&](const T &tree) { return tree.find(val); });
+  }
+
+  using FenwickTree::compFind;
+  virtual size_t compFind(uint64_t *val) const {
+    return Copies.read([&](const T &tree) { return tree.compFind(val); });
+  }
+
+  virtual size_t size() const { return Size; }
+
+  virtual size_t bitCount() const {
+    size_t replicas = 0;
+    for (size_t r = 0; r < Copies.size(); r++)
+      replicas += Copies[r].bitCount();
+
+    return sizeof(Replicated<T>) * 8 + replicas;
+  }
+
+  virtual MemoryReport memoryReport() const {
+    MemoryReport report;
+    for (size_t r = 0; r < Copies.size(); r++)
+      report += Copies[r].memoryReport();
+
+    report.Metadata += sizeof(Replicated<T>) * 8;
+    return report;
+  }
+
+  virtual Stats stats() const {
+    Stats stats;
+    for (size_t r = 0; r < Copies.size(); r++)
+      stats += Copies[r].stats();
+
+    return stats;
+  }
+
+  virtual void resetStats() {
+    for (size_t r = 0; r < Copies.size(); r++)
+      Copies[r].resetStats();
+  }
+
+  /**
+   * replicas() - Number of copies of the tree.
+   *
+   */
+  size_t replicas() const { return Copies.size(); }
+
+  /**
+   * replica() - Bring every copy up to date and return one of them.
+   * @r: Index of the replica.
+   *
+   */
+  const T &replica(size_t r) const {
+    Copies.flush();
+    return Copies[r];
+  }
+
+private:
+  friend std::ostream &operator<<(std::ostream &os, const Replicated<T> &ft) {
+    return os << ft.replica(0);
+  }
+
+  friend std::istream &operator>>(std::istream &is, Replicated<T> &ft) {
+    T tree(nullptr, 0);
+    is >> tree;
+
+    std::stringstream buffer;
+    buffer << tree;
+    const std::string serialized = buffer.str();
+
+    ft.Size = tree.size();
+    ft.Copies.rebuild(ft.Copies.size(), [&] {
+      std::istringstream in(serialized);
+      auto copy = make_unique<T>(nullptr, 0);
+      in >> *copy;
+      return copy;
+    });
+
+    return is;
+  }
+};
+
+} // namespace hft::fenwick
+
+#endif // __FENWICK_REPLICATED_HPP__
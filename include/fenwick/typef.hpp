@@ -18,7 +18,7 @@ public:
   static_assert(BOUNDSIZE >= 1 && BOUNDSIZE <= 64, "Leaves can't be stored in a 64-bit word");
 
 protected:
-  const size_t Size;
+  size_t Size;
   DArray<uint8_t> Tree;
 
 public:
@@ -79,10 +79,12 @@ public:
   }
 
   virtual uint64_t prefix(size_t idx) const {
+    HFT_PROBE(Statistics.Prefix);
     uint64_t sum = 0;
 
     while (idx != 0) {
       const size_t bytepos = pos(idx);
+      HFT_NODE(&Tree[bytepos], bytesize(rho(idx)));
 
       switch (BOUNDSIZE + rho(idx)) {
       case 17 ... 64:
@@ -102,8 +104,11 @@ public:
   }
 
   virtual void add(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Add);
+
     while (idx <= Size) {
       const size_t bytepos = pos(idx);
+      HFT_NODE(&Tree[bytepos], bytesize(rho(idx)));
 
       switch (BOUNDSIZE + rho(idx)) {
       case 17 ... 64:
@@ -122,6 +127,7 @@ public:
 
   using FenwickTree::find;
   virtual size_t find(uint64_t *val) const {
+    HFT_PROBE(Statistics.Find);
     size_t node = 0;
 
     for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
@@ -129,6 +135,7 @@ public:
         continue;
 
       const size_t bytepos = pos(node + m);
+      HFT_NODE(&Tree[bytepos], bytesize(rho(node + m)));
       const int bitlen = BOUNDSIZE + rho(node + m);
 
       uint64_t value;
@@ -154,6 +161,7 @@ public:
 
   using FenwickTree::compFind;
   virtual size_t compFind(uint64_t *val) const {
+    HFT_PROBE(Statistics.CompFind);
     size_t node = 0;
 
     for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
@@ -161,6 +169,7 @@ public:
         continue;
 
       const size_t bytepos = pos(node + m);
+      HFT_NODE(&Tree[bytepos], bytesize(rho(node + m)));
       const int height = rho(node + m);
 
       uint64_t value = BOUND << height;
@@ -184,13 +193,115 @@ public:
     return node;
   }
 
+  virtual uint64_t prefixAndAdd(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Prefix);
+    uint64_t sum = 0;
+    size_t node = 0;
+
+    for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
+      if (node + m > Size)
+        continue;
+
+      const size_t bytepos = pos(node + m);
+      HFT_NODE(&Tree[bytepos], bytesize(rho(node + m)));
+
+      if (node + m > idx) {
+        switch (BOUNDSIZE + rho(node + m)) {
+        case 17 ... 64:
+          *reinterpret_cast<auint64_t *>(&Tree[bytepos]) += inc;
+          break;
+        case 9 ... 16:
+          *reinterpret_cast<auint16_t *>(&Tree[bytepos]) += inc;
+          break;
+        default:
+          *reinterpret_cast<auint8_t *>(&Tree[bytepos]) += inc;
+        }
+        continue;
+      }
+
+      uint64_t value;
+      switch (BOUNDSIZE + rho(node + m)) {
+      case 17 ... 64:
+        value = *reinterpret_cast<auint64_t *>(&Tree[bytepos]);
+        break;
+      case 9 ... 16:
+        value = *reinterpret_cast<auint16_t *>(&Tree[bytepos]);
+        break;
+      default:
+        value = *reinterpret_cast<auint8_t *>(&Tree[bytepos]);
+      }
+
+      sum += value;
+      node += m;
+    }
+
+    return sum;
+  }
+
+  using FenwickTree::findAndAdd;
+  virtual size_t findAndAdd(uint64_t *val, int64_t inc) {
+    HFT_PROBE(Statistics.Find);
+    size_t node = 0;
+
+    for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
+      if (node + m > Size)
+        continue;
+
+      const size_t bytepos = pos(node + m);
+      HFT_NODE(&Tree[bytepos], bytesize(rho(node + m)));
+
+      uint64_t value;
+      switch (BOUNDSIZE + rho(node + m)) {
+      case 17 ... 64:
+        value = *reinterpret_cast<auint64_t *>(&Tree[bytepos]);
+        break;
+      case 9 ... 16:
+        value = *reinterpret_cast<auint16_t *>(&Tree[bytepos]);
+        break;
+      default:
+        value = *reinterpret_cast<auint8_t *>(&Tree[bytepos]);
+      }
+
+      if (*val >= value) {
+        node += m;
+        *val -= value;
+        continue;
+      }
+
+      switch (BOUNDSIZE + rho(node + m)) {
+      case 17 ... 64:
+        *reinterpret_cast<auint64_t *>(&Tree[bytepos]) += inc;
+        break;
+      case 9 ... 16:
+        *reinterpret_cast<auint16_t *>(&Tree[bytepos]) += inc;
+        break;
+      default:
+        *reinterpret_cast<auint8_t *>(&Tree[bytepos]) += inc;
+      }
+    }
+
+    return node;
+  }
+
   virtual size_t size() const { return Size; }
 
   virtual size_t bitCount() const {
-    return sizeof(TypeF<BOUNDSIZE>) * 8 + Tree.bitCount() - sizeof(Tree);
+    return sizeof(TypeF<BOUND>) * 8 + Tree.bitCount() - sizeof(Tree) * 8;
+  }
+
+  virtual MemoryReport memoryReport() const {
+    const size_t bits = payload(Size, [](size_t height) { return bytesize(height) * 8; });
+
+    MemoryReport report = Tree.memoryReport(bits);
+    report.Metadata = sizeof(TypeF<BOUND>) * 8;
+    return report;
   }
 
 private:
+  inline static size_t bytesize(size_t height) {
+    return BOUNDSIZE + height <= 8 ? 1 : BOUNDSIZE + height <= 16 ? 2 : 8;
+  }
+
   inline static size_t pos(size_t idx) {
     idx--;
     return idx + (idx >> (BOUNDSIZE <= 8 ? (8 - BOUNDSIZE + 1) : 0)) +
@@ -18,7 +18,7 @@ public:
   static_assert(BOUNDSIZE >= 1 && BOUNDSIZE <= 64, "Leaves can't be stored in a 64-bit word");
 
 protected:
-  const size_t Size, Levels;
+  size_t Size, Levels;
   unique_ptr<size_t[]> Level;
 
   DArray<uint8_t> Tree8;
@@ -68,6 +68,7 @@ public:
   }
 
   virtual uint64_t prefix(size_t idx) const {
+    HFT_PROBE(Statistics.Prefix);
     uint64_t sum = 0;
 
     while (idx != 0) {
@@ -77,12 +78,15 @@ public:
 
       switch (height + BOUNDSIZE) {
       case 17 ... 64:
+        HFT_NODE(&Tree64[tree_idx], 8);
         sum += Tree64[tree_idx];
         break;
       case 9 ... 16:
+        HFT_NODE(&Tree16[tree_idx], 2);
         sum += Tree16[tree_idx];
         break;
       default:
+        HFT_NODE(&Tree8[tree_idx], 1);
         sum += Tree8[tree_idx];
       }
 
@@ -93,6 +97,8 @@ public:
   }
 
   virtual void add(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Add);
+
     while (idx <= Size) {
       const int height = rho(idx);
       const size_t level_idx = idx >> (1 + height);
@@ -100,12 +106,15 @@ public:
 
       switch (height + BOUNDSIZE) {
       case 17 ... 64:
+        HFT_NODE(&Tree64[tree_idx], 8);
         Tree64[tree_idx] += inc;
         break;
       case 9 ... 16:
+        HFT_NODE(&Tree16[tree_idx], 2);
         Tree16[tree_idx] += inc;
         break;
       default:
+        HFT_NODE(&Tree8[tree_idx], 1);
         Tree8[tree_idx] += inc;
       }
 
@@ -115,6 +124,7 @@ public:
 
   using FenwickTree::find;
   virtual size_t find(uint64_t *val) const {
+    HFT_PROBE(Statistics.Find);
     size_t node = 0, idx = 0;
 
     for (size_t height = Levels - 2; height != SIZE_MAX; height--) {
@@ -122,21 +132,22 @@ public:
 
       idx <<= 1;
 
+      // levels of the same type share an array: the bound is the size of the sequence
+      if (node + (1ULL << height) > Size)
+        continue;
+
       uint64_t value = 0;
       switch (height + BOUNDSIZE) {
       case 17 ... 64:
-        if (tree_idx >= Tree64.size())
-          continue;
+        HFT_NODE(&Tree64[tree_idx], 8);
         value += Tree64[tree_idx];
         break;
       case 9 ... 16:
-        if (tree_idx >= Tree16.size())
-          continue;
+        HFT_NODE(&Tree16[tree_idx], 2);
         value += Tree16[tree_idx];
         break;
       default:
-        if (tree_idx >= Tree8.size())
-          continue;
+        HFT_NODE(&Tree8[tree_idx], 1);
         value += Tree8[tree_idx];
       }
 
@@ -152,6 +163,7 @@ public:
 
   using FenwickTree::compFind;
   virtual size_t compFind(uint64_t *val) const {
+    HFT_PROBE(Statistics.CompFind);
     size_t node = 0, idx = 0;
 
     for (size_t height = Levels - 2; height != SIZE_MAX; height--) {
@@ -159,21 +171,22 @@ public:
 
       idx <<= 1;
 
+      // levels of the same type share an array: the bound is the size of the sequence
+      if (node + (1ULL << height) > Size)
+        continue;
+
       uint64_t value = BOUND << height;
       switch (height + BOUNDSIZE) {
       case 17 ... 64:
-        if (tree_idx >= Tree64.size())
-          continue;
+        HFT_NODE(&Tree64[tree_idx], 8);
         value -= Tree64[tree_idx];
         break;
       case 9 ... 16:
-        if (tree_idx >= Tree16.size())
-          continue;
+        HFT_NODE(&Tree16[tree_idx], 2);
         value -= Tree16[tree_idx];
         break;
       default:
-        if (tree_idx >= Tree8.size())
-          continue;
+        HFT_NODE(&Tree8[tree_idx], 1);
         value -= Tree8[tree_idx];
       }
 
@@ -187,11 +200,123 @@ public:
     return min(node, Size);
   }
 
+  virtual uint64_t prefixAndAdd(size_t idx, int64_t inc) {
+    HFT_PROBE(Statistics.Prefix);
+    uint64_t sum = 0;
+    size_t node = 0, level_idx = 0;
+
+    for (size_t height = Levels - 2; height != SIZE_MAX; height--) {
+      const size_t tree_idx = Level[height] + level_idx;
+
+      level_idx <<= 1;
+
+      // levels of the same type share an array: the bound is the size of the sequence
+      if (node + (1ULL << height) > Size)
+        continue;
+
+      if (node + (1ULL << height) > idx) {
+        switch (height + BOUNDSIZE) {
+        case 17 ... 64:
+          HFT_NODE(&Tree64[tree_idx], 8);
+          Tree64[tree_idx] += inc;
+          break;
+        case 9 ... 16:
+          HFT_NODE(&Tree16[tree_idx], 2);
+          Tree16[tree_idx] += inc;
+          break;
+        default:
+          HFT_NODE(&Tree8[tree_idx], 1);
+          Tree8[tree_idx] += inc;
+        }
+        continue;
+      }
+
+      switch (height + BOUNDSIZE) {
+      case 17 ... 64:
+        HFT_NODE(&Tree64[tree_idx], 8);
+        sum += Tree64[tree_idx];
+        break;
+      case 9 ... 16:
+        HFT_NODE(&Tree16[tree_idx], 2);
+        sum += Tree16[tree_idx];
+        break;
+      default:
+        HFT_NODE(&Tree8[tree_idx], 1);
+        sum += Tree8[tree_idx];
+      }
+
+      level_idx++;
+      node += 1ULL << height;
+    }
+
+    return sum;
+  }
+
+  using FenwickTree::findAndAdd;
+  virtual size_t findAndAdd(uint64_t *val, int64_t inc) {
+    HFT_PROBE(Statistics.Find);
+    size_t node = 0, idx = 0;
+
+    for (size_t height = Levels - 2; height != SIZE_MAX; height--) {
+      const size_t tree_idx = Level[height] + idx;
+
+      idx <<= 1;
+
+      // levels of the same type share an array: the bound is the size of the sequence
+      if (node + (1ULL << height) > Size)
+        continue;
+
+      uint64_t value = 0;
+      switch (height + BOUNDSIZE) {
+      case 17 ... 64:
+        HFT_NODE(&Tree64[tree_idx], 8);
+        value = Tree64[tree_idx];
+        break;
+      case 9 ... 16:
+        HFT_NODE(&Tree16[tree_idx], 2);
+        value = Tree16[tree_idx];
+        break;
+      default:
+        HFT_NODE(&Tree8[tree_idx], 1);
+        value = Tree8[tree_idx];
+      }
+
+      if (*val >= value) {
+        idx++;
+        *val -= value;
+        node += 1ULL << height;
+        continue;
+      }
+
+      switch (height + BOUNDSIZE) {
+      case 17 ... 64:
+        Tree64[tree_idx] += inc;
+        break;
+      case 9 ... 16:
+        Tree16[tree_idx] += inc;
+        break;
+      default:
+        Tree8[tree_idx] += inc;
+      }
+    }
+
+    return node;
+  }
+
   virtual size_t size() const { return Size; }
 
   virtual size_t bitCount() const {
-    return sizeof(TypeL<BOUNDSIZE>) * 8 + Tree8.bitCount() - sizeof(Tree8) + Tree16.bitCount() -
-           sizeof(Tree16) + Tree64.bitCount() - sizeof(Tree64) + Levels * sizeof(size_t) * 8;
+    return sizeof(TypeL<BOUND>) * 8 + Tree8.bitCount() - sizeof(Tree8) * 8 + Tree16.bitCount() -
+           sizeof(Tree16) * 8 + Tree64.bitCount() - sizeof(Tree64) * 8 +
+           Levels * sizeof(size_t) * 8;
+  }
+
+  virtual MemoryReport memoryReport() const {
+    MemoryReport report = Tree8.memoryReport(Tree8.size() * 8);
+    report += Tree16.memoryReport(Tree16.size() * 16);
+    report += Tree64.memoryReport(Tree64.size() * 64);
+    report.Metadata = sizeof(TypeL<BOUND>) * 8 + Levels * sizeof(size_t) * 8;
+    return report;
   }
 
 private:
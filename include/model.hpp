@@ -0,0 +1,270 @@
+#ifndef __MODEL_HPP__
+#define __MODEL_HPP__
+
+#include "common.hpp"
+#include "fenwick.hpp"
+#include "trace.hpp"
+#include <fstream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+namespace hft::model {
+
+/**
+ * struct Hierarchy - Sizes of the memory hierarchy the model predicts misses for.
+ * @Line: Bytes of a cache line.
+ * @Page: Bytes of a page (the translation unit of the TLB).
+ * @Cache: Bytes of the L1 data cache, of the L2 and of the L3.
+ * @Ways: Associativity of the L1 data cache, of the L2 and of the L3 (see Simulator).
+ * @Tlb: Entries of the (second-level) data TLB.
+ * @TlbWays: Associativity of the TLB (see Simulator).
+ *
+ */
+struct Hierarchy {
+  size_t Line = 64, Page = 4096;
+  size_t Cache[3] = {32 << 10, 1 << 20, 8 << 20};
+  size_t Ways[3] = {8, 16, 16};
+  size_t Tlb = 1536, TlbWays = 12;
+
+  /**
+   * host() - Hierarchy of the running machine.
+   *
+   * Caches come from sysconf(), the page size from the page policy of DArray (transparent huge
+   * pages count as huge unless the kernel disables them). The TLB is not exposed by the kernel:
+   * the default of 1536 entries, 12 ways (a recent x86 second-level TLB) is kept.
+   *
+   */
+  static Hierarchy host() {
+    Hierarchy hw;
+    const long caches[] = {sysconf(_SC_LEVEL1_DCACHE_SIZE), sysconf(_SC_LEVEL2_CACHE_SIZE),
+                           sysconf(_SC_LEVEL3_CACHE_SIZE)};
+    const long ways[] = {sysconf(_SC_LEVEL1_DCACHE_ASSOC), sysconf(_SC_LEVEL2_CACHE_ASSOC),
+                         sysconf(_SC_LEVEL3_CACHE_ASSOC)};
+    for (size_t i = 0; i < 3; i++) {
+      if (caches[i] > 0)
+        hw.Cache[i] = caches[i];
+      if (ways[i] > 0)
+        hw.Ways[i] = ways[i];
+    }
+
+    if (sysconf(_SC_LEVEL1_DCACHE_LINESIZE) > 0)
+      hw.Line = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+
+#if defined(HFT_FORCE_HUGETLBPAGE)
+    hw.Page = 2 << 20;
+#elif defined(HFT_DISABLE_TRANSHUGE)
+    hw.Page = sysconf(_SC_PAGESIZE);
+#else
+    std::string thp;
+    std::getline(std::ifstream("/sys/kernel/mm/transparent_hugepage/enabled"), thp);
+    hw.Page = thp.empty() || thp.find("[never]") != std::string::npos ? sysconf(_SC_PAGESIZE)
+                                                                        : 2 << 20;
+#endif
+    return hw;
+  }
+};
+
+/**
+ * struct Cost - Expected cost of an operation.
+ * @Nodes: Nodes visited.
+ * @Lines: Distinct cache lines touched.
+ * @Pages: Distinct pages touched.
+ * @L1: Lines missing from the L1 data cache.
+ * @L2: Lines missing from the L2.
+ * @L3: Lines missing from the L3.
+ * @Tlb: Pages missing from the TLB.
+ *
+ */
+struct Cost {
+  double Nodes = 0, Lines = 0, Pages = 0, L1 = 0, L2 = 0, L3 = 0, Tlb = 0;
+};
+
+/**
+ * modelled - Whether the node layout of a tree is exposed by a static T::node() (see Span).
+ *
+ * Trees made of more than one array (Hybrid, TypeF, TypeL) are not modelled.
+ *
+ */
+template <typename T, typename = void> inline constexpr bool modelled = false;
+template <typename T>
+inline constexpr bool
+    modelled<T, std::void_t<decltype(T::node(size_t(), size_t()))>> = true;
+
+/**
+ * path() - Indices of the nodes visited by an operation, in order.
+ * @size: Number of elements of the tree.
+ * @op: trace::PREFIX, trace::ADD, trace::FIND or trace::COMPFIND.
+ * @arg: Index of prefix() and add(), or the index returned by find() and compFind().
+ *
+ * Every layout visits the same logical nodes: find() descends through the nodes (r & ~(2m-1)) + m
+ * not beyond @size, for every power of two m, where r is its result.
+ *
+ */
+inline std::vector<size_t> path(size_t size, trace::Op op, size_t arg) {
+  std::vector<size_t> nodes;
+  switch (op) {
+  case trace::PREFIX:
+    for (size_t idx = arg; idx != 0; idx = clear_rho(idx))
+      nodes.push_back(idx);
+    break;
+  case trace::ADD:
+    for (size_t idx = arg; idx != 0 && idx <= size; idx += mask_rho(idx))
+      nodes.push_back(idx);
+    break;
+  default:
+    for (size_t m = size ? mask_lambda(size) : 0; m != 0; m >>= 1) {
+      const size_t idx = (arg & ~(2 * m - 1)) + m;
+      if (idx <= size)
+        nodes.push_back(idx);
+    }
+  }
+  return nodes;
+}
+
+namespace internal {
+
+// bytes actually read to access a node: nodes are loaded with (at least) a 64-bit load
+inline std::pair<size_t, size_t> bytes(fenwick::Span span) {
+  const size_t first = span.Bit / 8;
+  return {first, max(first + 8, (span.Bit + span.Bits + 7) / 8)};
+}
+
+/**
+ * hot() - Blocks of @block bytes kept by an ideal cache of @capacity blocks.
+ *
+ * Nodes of greater height are visited more often: the cache is filled by whole heights, from the
+ * root down, as long as they fit.
+ *
+ */
+template <typename T> std::vector<bool> hot(size_t size, size_t block, size_t capacity) {
+  std::vector<bool> kept;
+  std::vector<size_t> fresh;
+  size_t used = 0;
+
+  for (size_t height = size ? lambda(size) + 1 : 0; height-- > 0;) {
+    fresh.clear();
+    for (size_t idx = 1ULL << height; idx <= size; idx += 2ULL << height) {
+      const auto [first, end] = bytes(T::node(size, idx));
+      for (size_t b = first / block; b <= (end - 1) / block; b++) {
+        if ((b >= kept.size() || !kept[b]) && (fresh.empty() || fresh.back() != b))
+          fresh.push_back(b);
+      }
+    }
+
+    if (used + fresh.size() > capacity)
+      break;
+
+    used += fresh.size();
+    for (size_t b : fresh) {
+      if (b >= kept.size())
+        kept.resize(max(b + 1, 2 * kept.size()));
+      kept[b] = true;
+    }
+  }
+
+  return kept;
+}
+
+inline size_t missing(const std::vector<size_t> &blocks, const std::vector<bool> &kept) {
+  size_t count = 0;
+  for (size_t b : blocks)
+    count += b >= kept.size() || !kept[b];
+  return count;
+}
+
+} // namespace internal
+
+/**
+ * predict() - Expected cost of an operation over a set of arguments.
+ * @size: Number of elements of the tree.
+ * @op: trace::PREFIX, trace::ADD, trace::FIND or trace::COMPFIND.
+ * @args: Arguments of the operations (see path()).
+ * @count: Number of arguments.
+ * @hw: Memory hierarchy.
+ *
+ * Positions come from T::node(), that is from the very position functions of the tree (pos(),
+ * holes(), Level, heightsize() and so on); the array of the tree is page-aligned, so lines and
+ * pages are exact. Misses are those of a warm, fully-associative cache that keeps the top of the
+ * tree (see internal::hot()): conflicts and cold misses are not modelled.
+ *
+ */
+template <typename T>
+Cost predict(size_t size, trace::Op op, const size_t args[], size_t count,
+             const Hierarchy &hw = Hierarchy::host()) {
+  static_assert(modelled<T>, "The layout of the tree is not exposed by T::node()");
+
+  std::vector<bool> caches[3];
+  for (size_t l = 0; l < 3; l++)
+    caches[l] = internal::hot<T>(size, hw.Line, hw.Cache[l] / hw.Line);
+  const std::vector<bool> tlb = internal::hot<T>(size, hw.Page, hw.Tlb);
+
+  Cost cost;
+  std::vector<size_t> lines, pages;
+  for (size_t i = 0; i < count; i++) {
+    lines.clear();
+    pages.clear();
+
+    const std::vector<size_t> nodes = path(size, op, args[i]);
+    for (size_t idx : nodes) {
+      const auto [first, end] = internal::bytes(T::node(size, idx));
+      for (size_t line = first / hw.Line; line <= (end - 1) / hw.Line; line++)
+        lines.push_back(line);
+      for (size_t page = first / hw.Page; page <= (end - 1) / hw.Page; page++)
+        pages.push_back(page);
+    }
+
+    std::sort(lines.begin(), lines.end());
+    lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+    std::sort(pages.begin(), pages.end());
+    pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+
+    cost.Nodes += nodes.size();
+    cost.Lines += lines.size();
+    cost.Pages += pages.size();
+    cost.L1 += internal::missing(lines, caches[0]);
+    cost.L2 += internal::missing(lines, caches[1]);
+    cost.L3 += internal::missing(lines, caches[2]);
+    cost.Tlb += internal::missing(pages, tlb);
+  }
+
+  const double c = 1. / max<size_t>(count, 1);
+  for (double *field : {&cost.Nodes, &cost.Lines, &cost.Pages, &cost.L1, &cost.L2, &cost.L3,
+                        &cost.Tlb})
+    *field *= c;
+  return cost;
+}
+
+/**
+ * predict() - Expected cost of an operation with uniformly distributed arguments.
+ * @size: Number of elements of the tree.
+ * @op: trace::PREFIX, trace::ADD, trace::FIND or trace::COMPFIND.
+ * @hw: Memory hierarchy.
+ * @samples: Largest number of arguments (every argument is used if there are fewer).
+ *
+ */
+template <typename T>
+Cost predict(size_t size, trace::Op op, const Hierarchy &hw = Hierarchy::host(),
+             size_t samples = 1 << 16) {
+  // find() can return 0, prefix() and add() start from 1
+  const size_t first = op == trace::PREFIX || op == trace::ADD ? 1 : 0;
+  std::vector<size_t> args;
+
+  if (size + 1 - first <= samples) {
+    for (size_t arg = first; arg <= size; arg++)
+      args.push_back(arg);
+  } else {
+    std::mt19937_64 re(0);
+    std::uniform_int_distribution<size_t> dist(first, size);
+    for (size_t i = 0; i < samples; i++)
+      args.push_back(dist(re));
+  }
+
+  return predict<T>(size, op, args.data(), args.size(), hw);
+}
+
+} // namespace hft::model
+
+#endif // __MODEL_HPP__
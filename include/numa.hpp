@@ -0,0 +1,216 @@
+#ifndef __NUMA_HPP__
+#define __NUMA_HPP__
+
+#include "common.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <string>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace hft::numa {
+
+/**
+ * cpulist() - Parse a kernel cpu/node list.
+ * @list: A list in the kernel format (e.g. "0-3,8,10-11").
+ *
+ * Returns the expanded list of identifiers, an empty list if @list is empty or malformed.
+ *
+ */
+inline std::vector<int> cpulist(const std::string &list) {
+  std::vector<int> ids;
+
+  // no exceptions (std::stoi), so that the library builds with -fno-exceptions
+  const char *p = list.c_str();
+  while (*p != '\0') {
+    char *end;
+    const long first = std::strtol(p, &end, 10);
+    if (end == p)
+      return ids;
+
+    long last = first;
+    p = end;
+    if (*p == '-') {
+      last = std::strtol(++p, &end, 10);
+      if (end == p)
+        return ids;
+      p = end;
+    }
+
+    for (long id = first; id <= last; id++)
+      ids.push_back(id);
+
+    while (*p == ',' || *p == '\n')
+      p++;
+  }
+
+  return ids;
+}
+
+/**
+ * online() - Identifiers of the online NUMA nodes.
+ *
+ * Machines (or containers) without a NUMA topology in sysfs are reported as a single node 0.
+ *
+ */
+inline const std::vector<int> &online() {
+  static const std::vector<int> ids = [] {
+    std::string list;
+    std::ifstream file("/sys/devices/system/node/online");
+    std::getline(file, list);
+
+    std::vector<int> parsed = cpulist(list);
+    return parsed.empty() ? std::vector<int>{0} : parsed;
+  }();
+
+  return ids;
+}
+
+/**
+ * nodes() - Number of online NUMA nodes (at least one).
+ *
+ */
+inline size_t nodes() { return online().size(); }
+
+/**
+ * cpus() - CPUs belonging to a given NUMA node.
+ * @node: Index (not identifier) of an online node, from 0 to nodes()-1.
+ *
+ * If the topology is unknown every online CPU is considered local to @node.
+ *
+ */
+inline std::vector<int> cpus(size_t node) {
+  std::string list;
+  std::ifstream file("/sys/devices/system/node/node" + std::to_string(online()[node]) + "/cpulist");
+  std::getline(file, list);
+
+  std::vector<int> ids = cpulist(list);
+  if (ids.empty()) {
+    for (unsigned int cpu = 0; cpu < std::thread::hardware_concurrency(); cpu++)
+      ids.push_back(cpu);
+  }
+
+  return ids;
+}
+
+/**
+ * node() - Index of the NUMA node of the CPU running the calling thread.
+ *
+ * Returns 0 on single-node machines.
+ *
+ */
+inline size_t node() {
+  static const std::vector<size_t> map = [] {
+    std::vector<size_t> parsed;
+    for (size_t i = 0; i < nodes(); i++) {
+      for (int cpu : cpus(i)) {
+        if ((size_t)cpu >= parsed.size())
+          parsed.resize(cpu + 1, 0);
+        parsed[cpu] = i;
+      }
+    }
+
+    return parsed;
+  }();
+
+  if (nodes() < 2)
+    return 0;
+
+  const int cpu = sched_getcpu();
+  return cpu >= 0 && (size_t)cpu < map.size() ? map[cpu] : 0;
+}
+
+/**
+ * pin() - Restrict the calling thread to the CPUs of a NUMA node.
+ * @node: Index of an online node, from 0 to nodes()-1.
+ *
+ * Returns false if the affinity cannot be changed (e.g. restricted by a cgroup).
+ *
+ */
+inline bool pin(size_t node) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+
+  for (int cpu : cpus(node))
+    if (cpu < CPU_SETSIZE)
+      CPU_SET(cpu, &set);
+
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+/**
+ * interleave() - Interleave the pages of a memory region across every online node.
+ * @mem: Page-aligned starting address.
+ * @length: Length (in bytes) of the region.
+ *
+ * It must be called before the pages are touched: the policy is applied on fault. It does nothing
+ * on single-node machines, where the default local allocation is already optimal.
+ *
+ */
+inline void interleave(void *mem, size_t length) {
+  if (nodes() < 2)
+    return;
+
+  unsigned long mask[16] = {};
+  for (int id : online())
+    if (id < 16 * 64)
+      mask[id / 64] |= 1UL << (id % 64);
+
+  long res = syscall(SYS_mbind, mem, length, MPOL_INTERLEAVE, mask, 16 * 64, 0);
+  assert(res == 0 && "mbind failed");
+  (void)res;
+}
+
+/**
+ * prefault() - Fault in the pages of a memory region with many threads.
+ * @mem: Page-aligned starting address.
+ * @length: Length (in bytes) of the region.
+ * @pagesize: Distance (in bytes) between two touched addresses.
+ *
+ * The region is split in contiguous chunks, one per hardware thread, and every worker is pinned to
+ * the NUMA nodes in a round-robin fashion. Unless a different memory policy was set, each chunk is
+ * therefore allocated on the node of the thread touching it. Small regions are touched by the
+ * calling thread alone.
+ *
+ * The region must be freshly mapped anonymous memory: its content is assumed to be zero.
+ *
+ */
+inline void prefault(void *mem, size_t length, size_t pagesize) {
+  constexpr size_t MIN_CHUNK = 64 * 4096;
+  const size_t pages = (length + pagesize - 1) / pagesize;
+  const size_t workers =
+      min<size_t>(max(1U, std::thread::hardware_concurrency()), max<size_t>(1, length / MIN_CHUNK));
+
+  auto touch = [=](size_t from, size_t to) {
+    volatile uint8_t *const page = static_cast<uint8_t *>(mem);
+    for (size_t i = from; i < to; i++)
+      page[i * pagesize] = 0;
+  };
+
+  if (workers == 1) {
+    touch(0, pages);
+    return;
+  }
+
+  std::vector<std::thread> pool;
+  const size_t chunk = (pages + workers - 1) / workers;
+  for (size_t t = 0; t < workers; t++) {
+    pool.emplace_back([=] {
+      if (nodes() > 1)
+        pin(t % nodes());
+
+      touch(min(pages, t * chunk), min(pages, (t + 1) * chunk));
+    });
+  }
+
+  for (auto &worker : pool)
+    worker.join();
+}
+
+} // namespace hft::numa
+
+#endif // __NUMA_HPP__
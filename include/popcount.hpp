@@ -0,0 +1,231 @@
+#ifndef __POPCOUNT_HPP__
+#define __POPCOUNT_HPP__
+
+#include "common.hpp"
+#include "cpu.hpp"
+
+#ifdef HFT_X86
+#include <immintrin.h>
+#endif
+
+namespace hft {
+
+/**
+ * Kernels counting the 1-bits of an array of words, and looking for the word holding the 1-bit of
+ * a given rank. Every word is XOR-ed with @flip first: ~0 counts the 0-bits instead.
+ *
+ * The AVX2 kernels count the bits of four words at a time with a nibble lookup table (Muła's
+ * algorithm), the AVX-512 ones of eight words with VPOPCNTQ. popcount() and select_word() run the
+ * widest one the CPU supports (see cpu::Kernels) on long enough arrays. Harley-Seal carry-save
+ * adders only pay off on arrays of several hundred words, far longer than a stride. Outside x86
+ * only the scalar kernels exist.
+ *
+ */
+namespace simd {
+
+/**
+ * AVX2_WORDS, AVX512_WORDS - Shortest arrays handed to the vector kernels.
+ *
+ * Below them, a POPCNT per word has a lower latency than loading and reducing vectors (see
+ * benchmark/kernels.cpp).
+ *
+ */
+constexpr size_t AVX2_WORDS = 32, AVX512_WORDS = 16;
+
+inline uint64_t popcount_scalar(const uint64_t *words, size_t count, uint64_t flip) {
+  uint64_t ones = 0;
+  for (size_t i = 0; i < count; i++)
+    ones += popcount(words[i] ^ flip);
+
+  return ones;
+}
+
+inline size_t select_word_scalar(const uint64_t *words, size_t count, uint64_t *rank,
+                                 uint64_t flip) {
+  for (size_t i = 0; i < count; i++) {
+    const uint64_t ones = popcount(words[i] ^ flip);
+    if (*rank < ones)
+      return i;
+
+    *rank -= ones;
+  }
+
+  return count;
+}
+
+#ifdef HFT_X86
+// 1-bits of each of the four words of a vector
+__attribute__((target("avx2"))) inline __m256i popcount_lanes_avx2(__m256i words) {
+  const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1,
+                                          2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+
+  const __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(words, nibble));
+  const __m256i high =
+      _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(words, 4), nibble));
+
+  return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2"))) inline uint64_t popcount_avx2(const uint64_t *words, size_t count,
+                                                               uint64_t flip) {
+  const __m256i mask = _mm256_set1_epi64x(flip);
+  __m256i sum = _mm256_setzero_si256();
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i));
+    sum = _mm256_add_epi64(sum, popcount_lanes_avx2(_mm256_xor_si256(chunk, mask)));
+  }
+
+  alignas(32) uint64_t lanes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), sum);
+
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + popcount_scalar(words + i, count - i, flip);
+}
+
+__attribute__((target("avx2"))) inline size_t select_word_avx2(const uint64_t *words, size_t count,
+                                                                uint64_t *rank, uint64_t flip) {
+  const __m256i mask = _mm256_set1_epi64x(flip);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i));
+
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes),
+                       popcount_lanes_avx2(_mm256_xor_si256(chunk, mask)));
+
+    const uint64_t ones = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    if (*rank >= ones) {
+      *rank -= ones;
+      continue;
+    }
+
+    for (size_t j = 0;; j++) {
+      if (*rank < lanes[j])
+        return i + j;
+      *rank -= lanes[j];
+    }
+  }
+
+  return i + select_word_scalar(words + i, count - i, rank, flip);
+}
+
+// sum of the eight words of a vector (GCC 12 warns about the shuffles of _mm512_reduce_add_epi64)
+__attribute__((target("avx512f"))) inline uint64_t sum_lanes_avx512(__m512i words) {
+  alignas(64) uint64_t lanes[8];
+  _mm512_store_si512(lanes, words);
+
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) inline uint64_t
+popcount_avx512(const uint64_t *words, size_t count, uint64_t flip) {
+  const __m512i mask = _mm512_set1_epi64(flip);
+  __m512i sum = _mm512_setzero_si512();
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m512i chunk = _mm512_loadu_si512(words + i);
+    sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(_mm512_xor_si512(chunk, mask)));
+  }
+
+  if (i < count) {
+    const __mmask8 tail = (1U << (count - i)) - 1;
+    const __m512i chunk = _mm512_maskz_loadu_epi64(tail, words + i);
+    sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(_mm512_maskz_xor_epi64(tail, chunk, mask)));
+  }
+
+  return sum_lanes_avx512(sum);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) inline size_t
+select_word_avx512(const uint64_t *words, size_t count, uint64_t *rank, uint64_t flip) {
+  const __m512i mask = _mm512_set1_epi64(flip);
+
+  for (size_t i = 0; i < count; i += 8) {
+    const __mmask8 valid = count - i >= 8 ? 0xff : (1U << (count - i)) - 1;
+    const __m512i chunk = _mm512_maskz_loadu_epi64(valid, words + i);
+    const __m512i ones = _mm512_popcnt_epi64(_mm512_maskz_xor_epi64(valid, chunk, mask));
+
+    const uint64_t total = sum_lanes_avx512(ones);
+    if (*rank >= total) {
+      *rank -= total;
+      continue;
+    }
+
+    alignas(64) uint64_t lanes[8];
+    _mm512_store_si512(lanes, ones);
+    for (size_t j = 0;; j++) {
+      if (*rank < lanes[j])
+        return i + j;
+      *rank -= lanes[j];
+    }
+  }
+
+  return count;
+}
+#endif
+
+} // namespace simd
+
+/**
+ * popcount() - Number of 1-bits of an array of words.
+ * @words: Array of words.
+ * @count: Length of the array.
+ * @flip: Mask XOR-ed with every word (~0 counts the 0-bits).
+ *
+ */
+inline uint64_t popcount(const uint64_t *words, size_t count, uint64_t flip = 0) {
+  switch (cpu::Kernels) {
+#ifdef HFT_X86
+  case cpu::AVX512:
+    if (count >= simd::AVX512_WORDS)
+      return simd::popcount_avx512(words, count, flip);
+    break;
+  case cpu::AVX2:
+    if (count >= simd::AVX2_WORDS)
+      return simd::popcount_avx2(words, count, flip);
+    break;
+#endif
+  default:
+    break;
+  }
+
+  return simd::popcount_scalar(words, count, flip);
+}
+
+/**
+ * select_word() - Index of the word holding the 1-bit of a given rank.
+ * @words: Array of words.
+ * @count: Length of the array.
+ * @rank: Rank of the 1-bit, changed into its rank within the returned word.
+ * @flip: Mask XOR-ed with every word (~0 looks for a 0-bit).
+ *
+ * This function returns @count if the array holds no more than @rank 1-bits; @rank is then
+ * decreased by all of them.
+ *
+ */
+inline size_t select_word(const uint64_t *words, size_t count, uint64_t *rank, uint64_t flip = 0) {
+  switch (cpu::Kernels) {
+#ifdef HFT_X86
+  case cpu::AVX512:
+    if (count >= simd::AVX512_WORDS)
+      return simd::select_word_avx512(words, count, rank, flip);
+    break;
+  case cpu::AVX2:
+    if (count >= simd::AVX2_WORDS)
+      return simd::select_word_avx2(words, count, rank, flip);
+    break;
+#endif
+  default:
+    break;
+  }
+
+  return simd::select_word_scalar(words, count, rank, flip);
+}
+
+} // namespace hft
+
+#endif // __POPCOUNT_HPP__
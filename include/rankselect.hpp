@@ -1,4 +1,11 @@
 #include "rankselect/rank_select.hpp"
 
+#include "rankselect/counted.hpp"
+#include "rankselect/line.hpp"
 #include "rankselect/stride.hpp"
 #include "rankselect/word.hpp"
+
+#include "rankselect/replicated.hpp"
+
+#include "rankselect/capture.hpp"
+#include "rankselect/hinted.hpp"
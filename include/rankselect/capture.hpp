@@ -0,0 +1,117 @@
+#ifndef __RANKSELECT_CAPTURE_HPP__
+#define __RANKSELECT_CAPTURE_HPP__
+
+#include "../trace.hpp"
+#include "rank_select.hpp"
+
+namespace hft::ranking {
+
+/**
+ * Capture - Log every operation on a rank & select data structure to a trace file.
+ * @bitvector: A bitvector of 64-bit words.
+ * @size: The length (in words) of the bitvector.
+ * @filename: trace file (see hft::trace).
+ * @T: Traced data structure (e.g. Stride<ByteL, 8>).
+ *
+ * The trace starts with a snapshot of @bitvector, so that it can be replayed on any other data
+ * structure. Logging is buffered and not thread-safe.
+ *
+ */
+template <typename T> class Capture : public RankSelect {
+protected:
+  T Bv;
+  mutable trace::Writer Log;
+
+public:
+  Capture(uint64_t bitvector[], size_t size, const std::string &filename)
+      : Bv(bitvector, size), Log(filename, trace::RANKSELECT, bitvector, size) {}
+
+  virtual const uint64_t *bitvector() const { return Bv.bitvector(); }
+
+  virtual const uint64_t *wordAt(size_t index) const { return Bv.wordAt(index); }
+
+  virtual size_t size() const { return Bv.size(); }
+
+  // the batches are logged one query at a time
+  using RankSelect::rank;
+  using RankSelect::select;
+  using RankSelect::selectZero;
+
+  virtual uint64_t rank(size_t pos) const {
+    Log.log(trace::RANK, pos);
+    return Bv.rank(pos);
+  }
+
+  virtual uint64_t rank(size_t from, size_t to) const {
+    Log.log(trace::RANKRANGE, from, to);
+    return Bv.rank(from, to);
+  }
+
+  virtual uint64_t rankZero(size_t pos) const {
+    Log.log(trace::RANKZERO, pos);
+    return Bv.rankZero(pos);
+  }
+
+  virtual uint64_t rankZero(size_t from, size_t to) const {
+    Log.log(trace::RANKZERORANGE, from, to);
+    return Bv.rankZero(from, to);
+  }
+
+  virtual size_t select(uint64_t rank) const {
+    Log.log(trace::SELECT, 0, rank);
+    return Bv.select(rank);
+  }
+
+  virtual size_t selectZero(uint64_t rank) const {
+    Log.log(trace::SELECTZERO, 0, rank);
+    return Bv.selectZero(rank);
+  }
+
+  virtual uint64_t update(size_t index, uint64_t word) {
+    Log.log(trace::UPDATE, index, word);
+    return Bv.update(index, word);
+  }
+
+  virtual bool set(size_t index) {
+    Log.log(trace::SET, index);
+    return Bv.set(index);
+  }
+
+  virtual bool clear(size_t index) {
+    Log.log(trace::CLEAR, index);
+    return Bv.clear(index);
+  }
+
+  virtual bool toggle(size_t index) {
+    Log.log(trace::TOGGLE, index);
+    return Bv.toggle(index);
+  }
+
+  virtual size_t bitCount() const { return (sizeof(Capture<T>) - sizeof(T)) * 8 + Bv.bitCount(); }
+
+  virtual MemoryReport memoryReport() const {
+    MemoryReport report = Bv.memoryReport();
+    report.Metadata += (sizeof(Capture<T>) - sizeof(T)) * 8;
+    return report;
+  }
+
+  virtual Stats stats() const { return Bv.stats(); }
+
+  virtual void resetStats() { Bv.resetStats(); }
+
+  /**
+   * traced() - The traced data structure (operations on it are not logged).
+   *
+   */
+  const T &traced() const { return Bv; }
+
+  /**
+   * flush() - Write the buffered records to the trace file.
+   *
+   */
+  void flush() { Log.flush(); }
+};
+
+} // namespace hft::ranking
+
+#endif // __RANKSELECT_CAPTURE_HPP__
@@ -0,0 +1,359 @@
+#ifndef __RANKSELECT_COUNTED_HPP__
+#define __RANKSELECT_COUNTED_HPP__
+
+#include "../popcount.hpp"
+#include "strided.hpp"
+
+namespace hft::ranking {
+
+/**
+ * Counted - Stride with the cumulative counts of its words.
+ * @bitvector: A bitvector of 64-bit words.
+ * @size: The length (in words) of the bitvector.
+ * @T: Underlining Fenwick tree with an ungiven <size_t> bound.
+ * @WORDS: Length (in words) of a stride, up to 512.
+ *
+ * Next to every word a 16-bit counter holds the number of 1-bits preceding it in its stride, so
+ * that nothing is scanned beyond the Fenwick tree: a rank is a counter plus a popcount, a select
+ * looks for the last counter not exceeding the rank (a branchless loop the compiler vectorizes)
+ * and then selects in a single word. Setting or clearing a bit changes the counters following it
+ * in the stride. The counters take 16 bits per word, i.e. a quarter of the bitvector: in exchange
+ * strides of 64 words or more keep ranks in constant time with a tiny tree.
+ *
+ */
+template <template <size_t> class T, size_t WORDS>
+class Counted : public Strided<Counted<T, WORDS>, WORDS> {
+  static_assert(WORDS >= 1 && WORDS <= 512, "the counts of a stride must fit in 16 bits");
+  friend class Strided<Counted<T, WORDS>, WORDS>;
+  using Base = Strided<Counted<T, WORDS>, WORDS>;
+  using Base::BATCH;
+#ifdef HFT_INSTRUMENT
+  using Base::Statistics;
+#endif
+
+private:
+  static constexpr size_t BOUND = 64 * WORDS;
+  T<BOUND> Fenwick;
+  DArray<uint64_t> Vector;
+  DArray<uint16_t> Counts;
+
+public:
+  Counted(uint64_t bitvector[], size_t size)
+      : Fenwick(buildFenwick(bitvector, size)), Vector(DArray<uint64_t>(size)),
+        Counts(buildCounts(bitvector, size)) {
+    std::copy_n(bitvector, size, Vector.get());
+  }
+
+  Counted(DArray<uint64_t> bitvector, size_t size)
+      : Fenwick(buildFenwick(bitvector.get(), size)), Vector(std::move(bitvector)),
+        Counts(buildCounts(Vector.get(), size)) {}
+
+  virtual const uint64_t *bitvector() const { return Vector.get(); }
+
+  virtual size_t size() const { return Vector.size() * 64; }
+
+  virtual uint64_t rank(size_t pos) const {
+    const uint64_t ones = Fenwick.prefix(stride(pos));
+    if (pos / 64 >= Vector.size())
+      return ones;
+
+    return ones + Counts[pos / 64] + popcount(Vector[pos / 64] & ((1ULL << (pos % 64)) - 1));
+  }
+
+  virtual uint64_t rank(size_t from, size_t to) const { return rank(to) - rank(from); }
+
+  virtual uint64_t rankZero(size_t pos) const { return pos - rank(pos); }
+
+  virtual uint64_t rankZero(size_t from, size_t to) const { return (to - from) - rank(from, to); }
+
+  virtual size_t select(uint64_t rank) const {
+    size_t idx = Fenwick.find(&rank);
+    HFT_COUNT(Statistics.Selects, 1);
+
+    return scan(idx, rank, 0);
+  }
+
+  virtual size_t selectZero(uint64_t rank) const {
+    size_t idx = Fenwick.compFind(&rank);
+    HFT_COUNT(Statistics.Selects, 1);
+
+    return scan(idx, rank, ~uint64_t(0));
+  }
+
+  virtual void rank(const size_t pos[], uint64_t ranks[], size_t count) const {
+    for (size_t i = 0; i < count; i += BATCH) {
+      const size_t end = min(count, i + BATCH);
+
+      for (size_t j = i; j < end; j++) {
+        if (pos[j] / 64 < Vector.size()) {
+          prefetch(&Vector[pos[j] / 64]);
+          prefetch(&Counts[pos[j] / 64]);
+        }
+      }
+
+      for (size_t j = i; j < end; j++)
+        ranks[j] = Fenwick.prefix(stride(pos[j]));
+
+      for (size_t j = i; j < end; j++) {
+        if (pos[j] / 64 < Vector.size())
+          ranks[j] += Counts[pos[j] / 64] +
+                      popcount(Vector[pos[j] / 64] & ((1ULL << (pos[j] % 64)) - 1));
+      }
+    }
+  }
+
+  virtual void select(const uint64_t rank[], size_t pos[], size_t count) const {
+    uint64_t residual[BATCH];
+
+    for (size_t i = 0; i < count; i += BATCH) {
+      const size_t end = min(count, i + BATCH);
+
+      for (size_t j = i; j < end; j++) {
+        residual[j - i] = rank[j];
+        pos[j] = Fenwick.find(&residual[j - i]);
+        prefetchCounts(pos[j]);
+      }
+
+      HFT_COUNT(Statistics.Selects, end - i);
+      for (size_t j = i; j < end; j++)
+        pos[j] = scan(pos[j], residual[j - i], 0);
+    }
+  }
+
+  virtual void selectZero(const uint64_t rank[], size_t pos[], size_t count) const {
+    uint64_t residual[BATCH];
+
+    for (size_t i = 0; i < count; i += BATCH) {
+      const size_t end = min(count, i + BATCH);
+
+      for (size_t j = i; j < end; j++) {
+        residual[j - i] = rank[j];
+        pos[j] = Fenwick.compFind(&residual[j - i]);
+        prefetchCounts(pos[j]);
+      }
+
+      HFT_COUNT(Statistics.Selects, end - i);
+      for (size_t j = i; j < end; j++)
+        pos[j] = scan(pos[j], residual[j - i], ~uint64_t(0));
+    }
+  }
+
+  virtual uint64_t update(size_t index, uint64_t word) {
+    uint64_t old = Vector[index];
+    Vector[index] = word;
+
+    const int delta = popcount(word) - popcount(old);
+    addCounts(index, delta);
+    Fenwick.add(index / WORDS + 1, delta);
+
+    return old;
+  }
+
+  virtual bool set(size_t index) {
+    uint64_t old = Vector[index / 64];
+    Vector[index / 64] |= uint64_t(1) << (index % 64);
+
+    if (Vector[index / 64] != old) {
+      addCounts(index / 64, 1);
+      Fenwick.add(index / (WORDS * 64) + 1, 1);
+      return false;
+    }
+
+    return true;
+  }
+
+  virtual bool clear(size_t index) {
+    uint64_t old = Vector[index / 64];
+    Vector[index / 64] &= ~(uint64_t(1) << (index % 64));
+
+    if (Vector[index / 64] != old) {
+      addCounts(index / 64, -1);
+      Fenwick.add(index / (WORDS * 64) + 1, -1);
+      return true;
+    }
+
+    return false;
+  }
+
+  virtual bool toggle(size_t index) {
+    uint64_t old = Vector[index / 64];
+    Vector[index / 64] ^= uint64_t(1) << (index % 64);
+    bool was_set = Vector[index / 64] < old;
+    addCounts(index / 64, was_set ? -1 : 1);
+    Fenwick.add(index / (WORDS * 64) + 1, was_set ? -1 : 1);
+
+    return was_set;
+  }
+
+  virtual uint64_t rankAndSet(size_t pos) {
+    const uint64_t old = Vector[pos / 64];
+    Vector[pos / 64] |= uint64_t(1) << (pos % 64);
+
+    // only the counters after the word change
+    const size_t idx = pos / (64 * WORDS);
+    const uint64_t ones = Counts[pos / 64] + popcount(old & ((1ULL << (pos % 64)) - 1));
+
+    if (Vector[pos / 64] == old)
+      return Fenwick.prefix(idx) + ones;
+
+    addCounts(pos / 64, 1);
+    return Fenwick.prefixAndAdd(idx, 1) + ones;
+  }
+
+  virtual size_t selectAndClear(uint64_t rank) {
+    const size_t idx = Fenwick.findAndAdd(&rank, -1);
+    HFT_COUNT(Statistics.Selects, 1);
+
+    // the tree found the stride holding the bit, and took it into account already
+    const size_t pos = scan(idx, rank, 0);
+    if (pos != SIZE_MAX) {
+      Vector[pos / 64] &= ~(uint64_t(1) << (pos % 64));
+      addCounts(pos / 64, -1);
+    }
+
+    return pos;
+  }
+
+  virtual size_t bitCount() const {
+    return sizeof(Counted<T, WORDS>) * 8 + Vector.bitCount() - sizeof(Vector) * 8 +
+           Counts.bitCount() - sizeof(Counts) * 8 + Fenwick.bitCount() - sizeof(Fenwick) * 8;
+  }
+
+  virtual Stats stats() const {
+    Stats stats = Fenwick.stats();
+
+#ifdef HFT_INSTRUMENT
+    stats.Selects = Statistics.Selects;
+    stats.Scanned = Statistics.Scanned;
+#endif
+
+    return stats;
+  }
+
+  virtual void resetStats() {
+    RankSelect::resetStats();
+    Fenwick.resetStats();
+  }
+
+  /**
+   * memoryReport() - Breakdown of the memory used by this structure.
+   *
+   * The counters are accounted as payload, like the nodes of the tree.
+   *
+   */
+  virtual MemoryReport memoryReport() const {
+    MemoryReport report = Fenwick.memoryReport();
+    report += Vector.memoryReport(Vector.size() * 64);
+    report += Counts.memoryReport(Counts.size() * 16);
+    report.Metadata += sizeof(Counted<T, WORDS>) * 8 - sizeof(Fenwick) * 8;
+    return report;
+  }
+
+private:
+  size_t used() const { return Vector.size(); }
+
+  void rebuild() {
+    Fenwick = buildFenwick(Vector.get(), Vector.size());
+    Counts = buildCounts(Vector.get(), Vector.size());
+  }
+
+  // the counters after @lo change
+  void recount(size_t idx, size_t lo) {
+    for (size_t i = lo + 1; i < min(Vector.size(), idx * WORDS + WORDS); i++)
+      Counts[i] = i % WORDS ? Counts[i - 1] + popcount(Vector[i - 1]) : 0;
+  }
+
+  // strides preceding the bit @pos (all of them at the end of the bitvector, which has no counter)
+  size_t stride(size_t pos) const {
+    return pos / 64 < Vector.size() ? pos / (64 * WORDS) : Vector.size() / WORDS + 1;
+  }
+
+  // add @delta to the counters of the words following @index in its stride
+  void addCounts(size_t index, int delta) {
+    const size_t last = min(Vector.size(), (index / WORDS + 1) * WORDS);
+    for (size_t i = index + 1; i < last; i++)
+      Counts[i] += delta;
+  }
+
+  void prefetchCounts(size_t idx) const {
+    if (idx * WORDS < Vector.size())
+      prefetch(&Counts[idx * WORDS], (min(Vector.size(), idx * WORDS + WORDS) - idx * WORDS) * 2);
+  }
+
+  // last 1-bit up to @pos in the words XOR-ed with @flip, the counters tell if the stride has one
+  size_t prev(size_t pos, uint64_t flip) const {
+    size_t i = pos / 64;
+    const size_t idx = pos / (64 * WORDS), first = idx * WORDS;
+    uint64_t word = (Vector[i] ^ flip) & (UINT64_MAX >> (63 - pos % 64));
+    if (word == 0 && (flip ? 64 * (i - first) - Counts[i] : Counts[i]) > 0) {
+      while ((word = Vector[--i] ^ flip) == 0)
+        ;
+    }
+    if (word)
+      return i * 64 + 63 - __builtin_clzll(word);
+
+    const uint64_t ones = Fenwick.prefix(idx), bits = flip ? first * 64 - ones : ones;
+    if (bits == 0)
+      return SIZE_MAX;
+
+    return flip ? selectZero(bits - 1) : select(bits - 1);
+  }
+
+  // position of the @rank-th 1-bit of the words (XOR-ed with @flip) of the stride @idx
+  size_t scan(size_t idx, uint64_t rank, uint64_t flip) const {
+    const size_t first = idx * WORDS;
+    if (first >= Vector.size())
+      return SIZE_MAX;
+
+    // counts are non-decreasing: the word is the last one whose count doesn't exceed @rank
+    const size_t words = min(WORDS, Vector.size() - first);
+    const uint16_t *counts = &Counts[first];
+    const uint16_t target = rank;
+    size_t i = 0;
+    if (flip) {
+      for (size_t j = 1; j < words; j++)
+        i += uint16_t(64 * j - counts[j]) <= target;
+    } else {
+      for (size_t j = 1; j < words; j++)
+        i += counts[j] <= target;
+    }
+
+    HFT_COUNT(Statistics.Scanned, 1);
+    rank -= flip ? 64 * i - counts[i] : counts[i];
+    const uint64_t word = Vector[first + i] ^ flip;
+    if (rank >= uint64_t(popcount(word)))
+      return SIZE_MAX;
+
+    return (first + i) * 64 + select64(word, rank);
+  }
+
+  static T<BOUND> buildFenwick(const uint64_t bitvector[], size_t size) {
+    uint64_t *sequence = new uint64_t[size / WORDS + 1]();
+    for (size_t i = 0; i < size; i++)
+      sequence[i / WORDS] += popcount(bitvector[i]);
+
+    T<BOUND> tree(sequence, size / WORDS + 1);
+    delete[] sequence;
+    return tree;
+  }
+
+  static DArray<uint16_t> buildCounts(const uint64_t bitvector[], size_t size) {
+    DArray<uint16_t> counts(size);
+    for (size_t i = 0; i < size; i++)
+      counts[i] = i % WORDS ? counts[i - 1] + popcount(bitvector[i - 1]) : 0;
+
+    return counts;
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const Counted<T, WORDS> &bv) {
+    return os << bv.Fenwick << bv.Vector << bv.Counts;
+  }
+
+  friend std::istream &operator>>(std::istream &is, Counted<T, WORDS> &bv) {
+    return is >> bv.Fenwick >> bv.Vector >> bv.Counts;
+  }
+};
+
+} // namespace hft::ranking
+
+#endif // __RANKSELECT_COUNTED_HPP__
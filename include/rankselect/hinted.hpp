@@ -0,0 +1,282 @@
+#ifndef __RANKSELECT_HINTED_HPP__
+#define __RANKSELECT_HINTED_HPP__
+
+#include "../popcount.hpp"
+#include "rank_select.hpp"
+#include <vector>
+
+namespace hft::ranking {
+
+/**
+ * Hinted - Sampled select index on top of a rank & select data structure.
+ * @bitvector: A bitvector of 64-bit words.
+ * @size: The length (in words) of the bitvector.
+ * @sample: A hint is kept for every @sample-th 1-bit, and for every @sample-th 0-bit.
+ * @reach: Words scanned from a hint before falling back to the underlying select.
+ * @region: Words sharing a version counter.
+ * @T: Underlying rank & select data structure.
+ *
+ * A hint records the word holding a sampled bit and the number of bits of the same kind before
+ * it. A select then starts from the hint of its rank and scans at most @reach words instead of
+ * searching the Fenwick tree from the root; when it can't, it asks the underlying structure.
+ *
+ * Hints are maintained lazily, so that updates cost nothing more than a couple of increments:
+ * - every change bumps a global clock, a hint taken at the current clock is used as it is;
+ * - every change bumps the version of its region, a hint whose region didn't change only needs
+ *   the bits before the region (a rank, i.e. a bottom-up prefix instead of a top-down find);
+ * - any other hint is taken again, from a select of its sampled bit.
+ *
+ * Reads update the hints, so not even queries are thread-safe.
+ *
+ */
+template <typename T> class Hinted : public RankSelect {
+private:
+  struct Hint {
+    uint64_t Bits = 0, Clock = UINT64_MAX; // bits of the kind before Word, as of Clock
+    size_t Word = SIZE_MAX;
+    uint32_t Local = 0, Version = 0; // of which in the region of Word, as of its Version
+  };
+
+  T Bv;
+  size_t Words, Sample, Reach, Region;
+  std::vector<uint32_t> Versions;
+  uint64_t Clock = 0;
+  mutable std::vector<Hint> Ones, Zeroes;
+
+public:
+  Hinted(uint64_t bitvector[], size_t size, size_t sample = 2048, size_t reach = 64,
+         size_t region = 1024)
+      : Bv(bitvector, size), Words(size), Sample(sample), Reach(reach), Region(region),
+        Versions(size / region + 1) {}
+
+  virtual const uint64_t *bitvector() const { return Bv.bitvector(); }
+
+  virtual const uint64_t *wordAt(size_t index) const { return Bv.wordAt(index); }
+
+  virtual size_t size() const { return Bv.size(); }
+
+  using RankSelect::select;
+  using RankSelect::selectZero;
+
+  virtual uint64_t rank(size_t pos) const { return Bv.rank(pos); }
+
+  virtual uint64_t rank(size_t from, size_t to) const { return Bv.rank(from, to); }
+
+  virtual uint64_t rankZero(size_t pos) const { return Bv.rankZero(pos); }
+
+  virtual uint64_t rankZero(size_t from, size_t to) const { return Bv.rankZero(from, to); }
+
+  virtual void rank(const size_t pos[], uint64_t ranks[], size_t count) const {
+    Bv.rank(pos, ranks, count);
+  }
+
+  virtual size_t select(uint64_t rank) const { return find(rank, false); }
+
+  virtual size_t selectZero(uint64_t rank) const { return find(rank, true); }
+
+  virtual size_t nextOne(size_t pos) const { return Bv.nextOne(pos); }
+
+  virtual size_t nextZero(size_t pos) const { return Bv.nextZero(pos); }
+
+  virtual size_t prevOne(size_t pos) const { return Bv.prevOne(pos); }
+
+  virtual size_t prevZero(size_t pos) const { return Bv.prevZero(pos); }
+
+  virtual uint64_t update(size_t index, uint64_t word) {
+    const uint64_t old = Bv.update(index, word);
+    if (old != word)
+      changed(index);
+
+    return old;
+  }
+
+  virtual bool set(size_t index) {
+    const bool was_set = Bv.set(index);
+    if (!was_set)
+      changed(index / 64);
+
+    return was_set;
+  }
+
+  virtual bool clear(size_t index) {
+    const bool was_set = Bv.clear(index);
+    if (was_set)
+      changed(index / 64);
+
+    return was_set;
+  }
+
+  virtual bool toggle(size_t index) {
+    changed(index / 64);
+    return Bv.toggle(index);
+  }
+
+  virtual uint64_t rankAndSet(size_t pos) {
+    if (!(*Bv.wordAt(pos / 64) >> (pos % 64) & 1))
+      changed(pos / 64);
+
+    return Bv.rankAndSet(pos);
+  }
+
+  virtual size_t selectAndClear(uint64_t rank) {
+    const size_t pos = Bv.selectAndClear(rank);
+    if (pos != SIZE_MAX)
+      changed(pos / 64);
+
+    return pos;
+  }
+
+  virtual void updateRange(size_t from, const uint64_t words[], size_t count) {
+    Bv.updateRange(from, words, count);
+    changed(from, from + count);
+  }
+
+  virtual void fillRange(size_t from, size_t to) {
+    Bv.fillRange(from, to);
+    if (from < to)
+      changed(from / 64, (to - 1) / 64 + 1);
+  }
+
+  virtual void clearRange(size_t from, size_t to) {
+    Bv.clearRange(from, to);
+    if (from < to)
+      changed(from / 64, (to - 1) / 64 + 1);
+  }
+
+  virtual void combine(const RankSelect &oth, BitOp op) {
+    Bv.combine(oth, op);
+    changed(0, Words);
+  }
+
+  virtual size_t bitCount() const {
+    return (sizeof(Hinted<T>) - sizeof(T)) * 8 + Bv.bitCount() + metadata();
+  }
+
+  /**
+   * memoryReport() - Breakdown of the memory used by this structure.
+   *
+   * The hints and the version counters are accounted as metadata.
+   *
+   */
+  virtual MemoryReport memoryReport() const {
+    MemoryReport report = Bv.memoryReport();
+    report.Metadata += (sizeof(Hinted<T>) - sizeof(T)) * 8 + metadata();
+    return report;
+  }
+
+  virtual Stats stats() const {
+    Stats stats = Bv.stats();
+
+#ifdef HFT_INSTRUMENT
+    stats += Statistics;
+#endif
+
+    return stats;
+  }
+
+  virtual void resetStats() {
+    RankSelect::resetStats();
+    Bv.resetStats();
+  }
+
+  /**
+   * hinted() - The underlying data structure (changing it leaves stale hints behind).
+   *
+   */
+  const T &hinted() const { return Bv; }
+
+private:
+  size_t metadata() const {
+    return (Versions.capacity() * sizeof(uint32_t) +
+            (Ones.capacity() + Zeroes.capacity()) * sizeof(Hint)) *
+           8;
+  }
+
+  void changed(size_t word) {
+    Clock++;
+    Versions[word / Region]++;
+  }
+
+  // the words [@first, @last) changed
+  void changed(size_t first, size_t last) {
+    Clock++;
+    for (size_t region = first / Region; first < last && region <= (last - 1) / Region; region++)
+      Versions[region]++;
+  }
+
+  // bits of the kind before the word @word
+  uint64_t before(size_t word, bool zero) const {
+    return zero ? Bv.rankZero(word * 64) : Bv.rank(word * 64);
+  }
+
+  // take again the hint of the @i-th sampled bit, false if there is no such a bit
+  bool retake(Hint &hint, size_t i, bool zero) const {
+    const size_t pos = zero ? Bv.selectZero(i * Sample) : Bv.select(i * Sample);
+    if (pos == SIZE_MAX)
+      return false;
+
+    const uint64_t word = *Bv.wordAt(pos / 64) ^ (zero ? UINT64_MAX : 0);
+    hint.Word = pos / 64;
+    hint.Bits = i * Sample - popcount(word & ((1ULL << (pos % 64)) - 1));
+    hint.Clock = Clock;
+    hint.Local = hint.Bits - before(hint.Word / Region * Region, zero);
+    hint.Version = Versions[hint.Word / Region];
+    return true;
+  }
+
+  // select_word() on the @count words from @first, one at a time if they are not contiguous
+  size_t scan(size_t first, size_t count, uint64_t *rank, uint64_t flip) const {
+    const uint64_t *words = Bv.wordAt(first);
+    if (Bv.wordAt(first + count - 1) == words + count - 1)
+      return select_word(words, count, rank, flip);
+
+    for (size_t j = 0; j < count; j++) {
+      const uint64_t ones = popcount(*Bv.wordAt(first + j) ^ flip);
+      if (*rank < ones)
+        return j;
+
+      *rank -= ones;
+    }
+
+    return count;
+  }
+
+  size_t find(uint64_t rank, bool zero) const {
+    if (rank >= Words * 64)
+      return SIZE_MAX;
+
+    std::vector<Hint> &hints = zero ? Zeroes : Ones;
+    const size_t i = rank / Sample;
+    if (i >= hints.size())
+      hints.resize(i + 1);
+
+    Hint &hint = hints[i];
+    if (hint.Word == SIZE_MAX || Versions[hint.Word / Region] != hint.Version) {
+      if (!retake(hint, i, zero))
+        return SIZE_MAX;
+    } else if (hint.Clock != Clock) {
+      hint.Bits = before(hint.Word / Region * Region, zero) + hint.Local;
+      hint.Clock = Clock;
+    }
+
+    // bits inserted before the hint may have moved @rank behind it
+    if (rank < hint.Bits)
+      return zero ? Bv.selectZero(rank) : Bv.select(rank);
+
+    const uint64_t flip = zero ? UINT64_MAX : 0;
+    const size_t reach = min(Reach, Words - hint.Word);
+    uint64_t residual = rank - hint.Bits;
+    const size_t j = scan(hint.Word, reach, &residual, flip);
+    if (j == reach)
+      return zero ? Bv.selectZero(rank) : Bv.select(rank);
+
+    HFT_COUNT(Statistics.Selects, 1);
+    HFT_COUNT(Statistics.Hits, 1);
+    HFT_COUNT(Statistics.Scanned, j + 1);
+    return (hint.Word + j) * 64 + select64(*Bv.wordAt(hint.Word + j) ^ flip, residual);
+  }
+};
+
+} // namespace hft::ranking
+
+#endif // __RANKSELECT_HINTED_HPP__
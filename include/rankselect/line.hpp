@@ -0,0 +1,328 @@
+#ifndef __RANKSELECT_LINE_HPP__
+#define __RANKSELECT_LINE_HPP__
+
+#include "rank_select.hpp"
+
+namespace hft::ranking {
+
+/**
+ * Line - Counters interleaved with the bitvector, one cache line at a time.
+ * @bitvector: A bitvector of 64-bit words.
+ * @size: The length (in words) of the bitvector.
+ * @T: Underlining Fenwick tree with an ungiven <size_t> bound.
+ *
+ * Every 64-byte line holds a header word followed by WORDS = 7 words of the bitvector. The header
+ * packs seven 9-bit counters, rank9 style: the j-th one is the number of 1-bits in the words of
+ * the line before the j-th (so the first one is always zero). The Fenwick tree only counts the
+ * 1-bits of whole lines, so it is seven times smaller than the one of Word, and the words a query
+ * ends in share the line of their counters: a rank is a tree traversal plus a single miss.
+ *
+ * Since the words are not contiguous anymore, bitvector() returns nullptr: read them through
+ * wordAt() (the i-th word is the (i % 7)-th of the (i / 7)-th line, after its counters).
+ *
+ */
+template <template <size_t> class T> class Line : public RankSelect {
+public:
+  static constexpr size_t WORDS = 7;
+
+private:
+  static constexpr size_t BOUND = 64 * WORDS;
+  // 1 in the lowest bit of every counter
+  static constexpr uint64_t ONES_STEP_9 = 0x0040201008040201ULL;
+
+  size_t Words;
+  T<BOUND> Fenwick;
+  DArray<uint64_t> Lines;
+
+public:
+  Line(const uint64_t bitvector[], size_t size)
+      : Words(size), Fenwick(buildFenwick(bitvector, size)),
+        Lines(DArray<uint64_t>((size / WORDS + 1) * 8)) {
+    for (size_t i = 0; i < size / WORDS + 1; i++) {
+      uint64_t counters = 0, ones = 0;
+      for (size_t j = 0; j < WORDS && i * WORDS + j < size; j++) {
+        counters |= ones << (9 * j);
+        ones += popcount(bitvector[i * WORDS + j]);
+        Lines[i * 8 + j + 1] = bitvector[i * WORDS + j];
+      }
+
+      // the counters of the words past the end keep the 1-bits of the whole line
+      for (size_t j = size - min(size, i * WORDS); j < WORDS; j++)
+        counters |= ones << (9 * j);
+
+      Lines[i * 8] = counters;
+    }
+  }
+
+  Line(DArray<uint64_t> bitvector, size_t size) : Line(bitvector.get(), size) {}
+
+  virtual const uint64_t *bitvector() const { return nullptr; }
+
+  virtual const uint64_t *wordAt(size_t index) const {
+    return &Lines[index / WORDS * 8 + index % WORDS + 1];
+  }
+
+  virtual size_t size() const { return Words * 64; }
+
+  virtual uint64_t rank(size_t pos) const {
+    const size_t line = pos / 64 / WORDS, slot = pos / 64 % WORDS;
+
+    return Fenwick.prefix(line) + counter(line, slot) +
+           popcount(Lines[line * 8 + slot + 1] & ((1ULL << (pos % 64)) - 1));
+  }
+
+  virtual uint64_t rank(size_t from, size_t to) const { return rank(to) - rank(from); }
+
+  virtual uint64_t rankZero(size_t pos) const { return pos - rank(pos); }
+
+  virtual uint64_t rankZero(size_t from, size_t to) const { return (to - from) - rank(from, to); }
+
+  virtual size_t select(uint64_t rank) const {
+    const size_t line = Fenwick.find(&rank);
+    HFT_COUNT(Statistics.Selects, 1);
+
+    return scan(line, rank, false);
+  }
+
+  virtual size_t selectZero(uint64_t rank) const {
+    const size_t line = Fenwick.compFind(&rank);
+    HFT_COUNT(Statistics.Selects, 1);
+
+    return scan(line, rank, true);
+  }
+
+  virtual void rank(const size_t pos[], uint64_t ranks[], size_t count) const {
+    for (size_t i = 0; i < count; i += BATCH) {
+      const size_t end = min(count, i + BATCH);
+
+      for (size_t j = i; j < end; j++)
+        prefetch(&Lines[pos[j] / 64 / WORDS * 8]);
+
+      for (size_t j = i; j < end; j++)
+        ranks[j] = Fenwick.prefix(pos[j] / 64 / WORDS);
+
+      for (size_t j = i; j < end; j++) {
+        const size_t line = pos[j] / 64 / WORDS, slot = pos[j] / 64 % WORDS;
+        ranks[j] += counter(line, slot) +
+                    popcount(Lines[line * 8 + slot + 1] & ((1ULL << (pos[j] % 64)) - 1));
+      }
+    }
+  }
+
+  virtual void select(const uint64_t rank[], size_t pos[], size_t count) const {
+    selectBatch(rank, pos, count, false);
+  }
+
+  virtual void selectZero(const uint64_t rank[], size_t pos[], size_t count) const {
+    selectBatch(rank, pos, count, true);
+  }
+
+  virtual uint64_t update(size_t index, uint64_t word) {
+    const size_t line = index / WORDS, slot = index % WORDS;
+    const uint64_t old = Lines[line * 8 + slot + 1];
+    Lines[line * 8 + slot + 1] = word;
+
+    const int64_t delta = popcount(word) - popcount(old);
+    addCounters(line, slot, delta);
+    Fenwick.add(line + 1, delta);
+
+    return old;
+  }
+
+  virtual bool set(size_t index) {
+    const size_t line = index / 64 / WORDS, slot = index / 64 % WORDS;
+    uint64_t &word = Lines[line * 8 + slot + 1];
+    const uint64_t old = word;
+    word |= uint64_t(1) << (index % 64);
+
+    if (word != old) {
+      addCounters(line, slot, 1);
+      Fenwick.add(line + 1, 1);
+      return false;
+    }
+
+    return true;
+  }
+
+  virtual bool clear(size_t index) {
+    const size_t line = index / 64 / WORDS, slot = index / 64 % WORDS;
+    uint64_t &word = Lines[line * 8 + slot + 1];
+    const uint64_t old = word;
+    word &= ~(uint64_t(1) << (index % 64));
+
+    if (word != old) {
+      addCounters(line, slot, -1);
+      Fenwick.add(line + 1, -1);
+      return true;
+    }
+
+    return false;
+  }
+
+  virtual bool toggle(size_t index) {
+    const size_t line = index / 64 / WORDS, slot = index / 64 % WORDS;
+    uint64_t &word = Lines[line * 8 + slot + 1];
+    const uint64_t old = word;
+    word ^= uint64_t(1) << (index % 64);
+
+    const bool was_set = word < old;
+    addCounters(line, slot, was_set ? -1 : 1);
+    Fenwick.add(line + 1, was_set ? -1 : 1);
+
+    return was_set;
+  }
+
+  virtual uint64_t rankAndSet(size_t pos) {
+    const size_t line = pos / 64 / WORDS, slot = pos / 64 % WORDS;
+    uint64_t &word = Lines[line * 8 + slot + 1];
+    const uint64_t old = word;
+    word |= uint64_t(1) << (pos % 64);
+
+    // only the counters after the slot change
+    const uint64_t ones = counter(line, slot) + popcount(old & ((1ULL << (pos % 64)) - 1));
+    if (word == old)
+      return Fenwick.prefix(line) + ones;
+
+    addCounters(line, slot, 1);
+    return Fenwick.prefixAndAdd(line, 1) + ones;
+  }
+
+  virtual size_t selectAndClear(uint64_t rank) {
+    const size_t line = Fenwick.findAndAdd(&rank, -1);
+    HFT_COUNT(Statistics.Selects, 1);
+
+    // the tree found the line holding the bit, and took it into account already
+    const size_t pos = scan(line, rank, false);
+    if (pos != SIZE_MAX) {
+      Lines[line * 8 + pos / 64 % WORDS + 1] &= ~(uint64_t(1) << (pos % 64));
+      addCounters(line, pos / 64 % WORDS, -1);
+    }
+
+    return pos;
+  }
+
+  virtual size_t bitCount() const {
+    return sizeof(Line<T>) * 8 + Lines.bitCount() - sizeof(Lines) * 8 + Fenwick.bitCount() -
+           sizeof(Fenwick) * 8;
+  }
+
+  virtual Stats stats() const {
+    Stats stats = Fenwick.stats();
+
+#ifdef HFT_INSTRUMENT
+    stats.Selects = Statistics.Selects;
+    stats.Scanned = Statistics.Scanned;
+#endif
+
+    return stats;
+  }
+
+  virtual void resetStats() {
+    RankSelect::resetStats();
+    Fenwick.resetStats();
+  }
+
+  /**
+   * memoryReport() - Breakdown of the memory used by this structure.
+   *
+   * The headers of the lines are accounted as metadata, like the fields of the object.
+   *
+   */
+  virtual MemoryReport memoryReport() const {
+    const size_t lines = Lines.size() / 8;
+
+    MemoryReport report = Fenwick.memoryReport();
+    report += Lines.memoryReport(Words * 64 + lines * 64);
+    report.Payload -= lines * 64;
+    report.Metadata += lines * 64 + sizeof(Line<T>) * 8 - sizeof(Fenwick) * 8;
+    return report;
+  }
+
+private:
+  // 1-bits of the line @line before its word @slot
+  uint64_t counter(size_t line, size_t slot) const {
+    return Lines[line * 8] >> (9 * slot) & 511;
+  }
+
+  // add @delta to the counters of the words of @line after @slot
+  void addCounters(size_t line, size_t slot, int64_t delta) {
+    Lines[line * 8] += delta * (ONES_STEP_9 & (UINT64_MAX << (9 * slot + 9)));
+  }
+
+  // position of the @rank-th 1-bit (0-bit if @zero) of the line @line
+  size_t scan(size_t line, uint64_t rank, bool zero) const {
+    if (line >= Lines.size() / 8)
+      return SIZE_MAX;
+
+    // the last counter not exceeding @rank, 0-bits are 64 per word minus the 1-bits
+    const uint64_t counters = Lines[line * 8];
+    size_t slot = 0;
+    uint64_t before = 0;
+    for (size_t j = 1; j < WORDS; j++) {
+      const uint64_t ones = counters >> (9 * j) & 511;
+      const uint64_t count = zero ? 64 * j - ones : ones;
+      if (count > rank)
+        break;
+
+      slot = j;
+      before = count;
+    }
+
+    HFT_COUNT(Statistics.Scanned, 1);
+    const uint64_t word = Lines[line * 8 + slot + 1] ^ (zero ? UINT64_MAX : 0);
+    rank -= before;
+    if (rank >= (uint64_t)popcount(word))
+      return SIZE_MAX;
+
+    const size_t pos = (line * WORDS + slot) * 64 + select64(word, rank);
+    return pos < Words * 64 ? pos : SIZE_MAX;
+  }
+
+  void selectBatch(const uint64_t rank[], size_t pos[], size_t count, bool zero) const {
+    uint64_t residual[BATCH];
+
+    for (size_t i = 0; i < count; i += BATCH) {
+      const size_t end = min(count, i + BATCH);
+
+      for (size_t j = i; j < end; j++) {
+        residual[j - i] = rank[j];
+        pos[j] = zero ? Fenwick.compFind(&residual[j - i]) : Fenwick.find(&residual[j - i]);
+        if (pos[j] < Lines.size() / 8)
+          prefetch(&Lines[pos[j] * 8]);
+      }
+
+      HFT_COUNT(Statistics.Selects, end - i);
+      for (size_t j = i; j < end; j++)
+        pos[j] = scan(pos[j], residual[j - i], zero);
+    }
+  }
+
+  static T<BOUND> buildFenwick(const uint64_t bitvector[], size_t size) {
+    uint64_t *sequence = new uint64_t[size / WORDS + 1]();
+    for (size_t i = 0; i < size; i++)
+      sequence[i / WORDS] += popcount(bitvector[i]);
+
+    T<BOUND> tree(sequence, size / WORDS + 1);
+    delete[] sequence;
+    return tree;
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const Line<T> &bv) {
+    const uint64_t nwords = hton(static_cast<uint64_t>(bv.Words));
+    os.write((char *)&nwords, sizeof(uint64_t));
+
+    return os << bv.Fenwick << bv.Lines;
+  }
+
+  friend std::istream &operator>>(std::istream &is, Line<T> &bv) {
+    uint64_t nwords;
+    is.read((char *)&nwords, sizeof(uint64_t));
+    bv.Words = ntoh(nwords);
+
+    return is >> bv.Fenwick >> bv.Lines;
+  }
+};
+
+} // namespace hft::ranking
+
+#endif // __RANKSELECT_LINE_HPP__
@@ -3,9 +3,23 @@
 
 #include "../common.hpp"
 #include "../darray.hpp"
+#include "../stats.hpp"
+#include <iterator>
 
 namespace hft::ranking {
 
+class Bits;
+
+/**
+ * enum BitOp - Boolean operations between bit vectors, see RankSelect::combine().
+ * @AND: a & b.
+ * @OR: a | b.
+ * @XOR: a ^ b.
+ * @ANDNOT: a & ~b.
+ *
+ */
+enum BitOp { AND, OR, XOR, ANDNOT };
+
 /**
  * RankSelect - Dynamic rank & select data structure interface.
  * @bitvector: A bit vector of 64-bit words.
@@ -25,9 +39,22 @@ public:
    * It's a constant, so you can't change the junk inside unless you
    * explicitly cast away the constness (at your own risk).
    *
+   * Structures whose words are not contiguous (e.g. Line) return nullptr: generic code reads the
+   * words through wordAt().
+   *
    */
   virtual const uint64_t *bitvector() const = 0;
 
+  /**
+   * wordAt() - Address of a word of the bit vector.
+   * @index: index (in words) in the bitvector.
+   *
+   * Structures whose words are not contiguous (and whose bitvector() is nullptr) override this
+   * method.
+   *
+   */
+  virtual const uint64_t *wordAt(size_t index) const { return bitvector() + index; }
+
   /**
    * size() - length (in bits) of the bitvector.
    *
@@ -82,6 +109,124 @@ public:
    */
   virtual size_t selectZero(uint64_t rank) const = 0;
 
+  /**
+   * rank() - Numbers of 1-bits preceding each of a batch of positions.
+   * @pos: Indices of the bit vector.
+   * @ranks: Output array, @ranks[i] receives rank(@pos[i]).
+   * @count: Number of positions.
+   *
+   * Queries of a batch are independent: implementations overlap their memory accesses (e.g. the
+   * words of the bit vector are prefetched while the Fenwick tree is traversed).
+   *
+   */
+  virtual void rank(const size_t pos[], uint64_t ranks[], size_t count) const {
+    for (size_t i = 0; i < count; i++)
+      ranks[i] = rank(pos[i]);
+  }
+
+  /**
+   * select() - Indices of the 1-bits with each of a batch of ranks.
+   * @rank: Numbers of 1-bits before the returned indices.
+   * @pos: Output array, @pos[i] receives select(@rank[i]) (SIZE_MAX if there is no such an index).
+   * @count: Number of ranks.
+   *
+   */
+  virtual void select(const uint64_t rank[], size_t pos[], size_t count) const {
+    for (size_t i = 0; i < count; i++)
+      pos[i] = select(rank[i]);
+  }
+
+  /**
+   * selectZero() - Indices of the 0-bits with each of a batch of ranks.
+   * @rank: Numbers of 0-bits before the returned indices.
+   * @pos: Output array, @pos[i] receives selectZero(@rank[i]).
+   * @count: Number of ranks.
+   *
+   */
+  virtual void selectZero(const uint64_t rank[], size_t pos[], size_t count) const {
+    for (size_t i = 0; i < count; i++)
+      pos[i] = selectZero(rank[i]);
+  }
+
+  /**
+   * nextOne() - Index of the first 1-bit following a position (the position itself included).
+   * @pos: An index of the bit vector, or its length.
+   *
+   * This method returns SIZE_MAX if no such an index exists. Implementations look at the words
+   * around @pos first, and only go through the Fenwick tree when the answer is farther.
+   *
+   */
+  virtual size_t nextOne(size_t pos) const { return select(rank(pos)); }
+
+  /**
+   * nextZero() - Index of the first 0-bit following a position (the position itself included).
+   * @pos: An index of the bit vector, or its length.
+   *
+   * This method returns SIZE_MAX if no such an index exists.
+   *
+   */
+  virtual size_t nextZero(size_t pos) const { return selectZero(rankZero(pos)); }
+
+  /**
+   * prevOne() - Index of the last 1-bit preceding a position (the position itself included).
+   * @pos: An index of the bit vector.
+   *
+   * This method returns SIZE_MAX if no such an index exists.
+   *
+   */
+  virtual size_t prevOne(size_t pos) const {
+    const uint64_t ones = rank(pos + 1);
+    return ones ? select(ones - 1) : SIZE_MAX;
+  }
+
+  /**
+   * prevZero() - Index of the last 0-bit preceding a position (the position itself included).
+   * @pos: An index of the bit vector.
+   *
+   * This method returns SIZE_MAX if no such an index exists.
+   *
+   */
+  virtual size_t prevZero(size_t pos) const {
+    const uint64_t zeroes = rankZero(pos + 1);
+    return zeroes ? selectZero(zeroes - 1) : SIZE_MAX;
+  }
+
+  /**
+   * onesFrom() - The 1-bits from a position on, in increasing order.
+   * @pos: An index of the bit vector, or its length.
+   *
+   * The returned range walks the words of the bit vector (a tzcnt and a blsr per 1-bit) and
+   * seeks with nextOne() only when the next word has none, so that enumerating the 1-bits costs
+   * amortized constant time each. The range allocates nothing, and changing the bit vector while
+   * walking it gives undefined results.
+   *
+   *   for (size_t pos : bv.onesFrom(0))
+   *     ...
+   *
+   */
+  Bits onesFrom(size_t pos) const;
+
+  /**
+   * zerosFrom() - The 0-bits from a position on, in increasing order.
+   * @pos: An index of the bit vector, or its length.
+   *
+   */
+  Bits zerosFrom(size_t pos) const;
+
+  /**
+   * onesDownFrom() - The 1-bits up to a position, in decreasing order.
+   * @pos: An index of the bit vector.
+   *
+   */
+  Bits onesDownFrom(size_t pos) const;
+
+  /**
+   * zerosDownFrom() - The 0-bits up to a position, in decreasing order.
+   * @pos: An index of the bit vector.
+   *
+   */
+  Bits zerosDownFrom(size_t pos) const;
+
   /**
    * update() - Replace a given word in the bitvector.
    * @index: index (in words) in the bitvector.
@@ -92,6 +237,83 @@ public:
    */
   virtual uint64_t update(size_t index, uint64_t word) = 0;
 
+  /**
+   * updateRange() - Replace a range of words in the bitvector.
+   * @from: index (in words) of the first replaced word.
+   * @words: new values of the words.
+   * @count: number of words.
+   *
+   * Same as update(@from + i, @words[i]) for each i, but implementations add the changes of a
+   * whole stride to the Fenwick tree at once, or build it again if most strides change.
+   *
+   */
+  virtual void updateRange(size_t from, const uint64_t words[], size_t count) {
+    for (size_t i = 0; i < count; i++)
+      update(from + i, words[i]);
+  }
+
+  /**
+   * fillRange() - Set (set to 1) the bits of a given range.
+   * @from: Starting index (in bits) of the range.
+   * @to: Ending index (in bits, excluded) of the range.
+   *
+   */
+  virtual void fillRange(size_t from, size_t to) {
+    for (size_t i = from / 64; from < to && i <= (to - 1) / 64; i++) {
+      const uint64_t word = *wordAt(i) | rangeMask(i, from, to);
+      if (word != *wordAt(i))
+        update(i, word);
+    }
+  }
+
+  /**
+   * clearRange() - Clear (set to 0) the bits of a given range.
+   * @from: Starting index (in bits) of the range.
+   * @to: Ending index (in bits, excluded) of the range.
+   *
+   */
+  virtual void clearRange(size_t from, size_t to) {
+    for (size_t i = from / 64; from < to && i <= (to - 1) / 64; i++) {
+      const uint64_t word = *wordAt(i) & ~rangeMask(i, from, to);
+      if (word != *wordAt(i))
+        update(i, word);
+    }
+  }
+
+  /**
+   * combine() - Replace the bit vector with a boolean operation between it and another one.
+   * @oth: A bit vector of the same length.
+   * @op: The operation, whose first operand is this bit vector.
+   *
+   * Implementations run @op a stride at a time (a loop the compiler vectorizes) and then update
+   * the Fenwick tree like updateRange().
+   *
+   */
+  virtual void combine(const RankSelect &oth, BitOp op) {
+    assert(size() == oth.size());
+    for (size_t i = 0; i < size() / 64; i++) {
+      uint64_t word = *wordAt(i);
+      combineWords(op, &word, oth, i, 1);
+      if (word != *wordAt(i))
+        update(i, word);
+    }
+  }
+
+  RankSelect &operator&=(const RankSelect &oth) {
+    combine(oth, AND);
+    return *this;
+  }
+
+  RankSelect &operator|=(const RankSelect &oth) {
+    combine(oth, OR);
+    return *this;
+  }
+
+  RankSelect &operator^=(const RankSelect &oth) {
+    combine(oth, XOR);
+    return *this;
+  }
+
   /**
    * set() - Set (set to 1) a given bit in the bitvector.
    * @index: Index (in bits) in the bitvector.
@@ -119,12 +341,83 @@ public:
    */
   virtual bool toggle(size_t index) = 0;
 
+  /**
+   * rankAndSet() - Numbers of 1-bits preceding a position, which is then set to 1.
+   * @pos: An index of the bit vector.
+   *
+   * Same as rank(@pos) followed by set(@pos), but the underlying Fenwick tree is traversed once.
+   *
+   */
+  virtual uint64_t rankAndSet(size_t pos) {
+    const uint64_t ones = rank(pos);
+    set(pos);
+    return ones;
+  }
+
+  /**
+   * rankZeroAndSet() - Numbers of 0-bits preceding a position, which is then set to 1.
+   * @pos: An index of the bit vector.
+   *
+   * Same as rankZero(@pos) followed by set(@pos).
+   *
+   */
+  virtual uint64_t rankZeroAndSet(size_t pos) { return pos - rankAndSet(pos); }
+
+  /**
+   * selectAndClear() - Index of the 1-bit with a given rank, which is then cleared (set to 0).
+   * @rank: Number of 1-bits before the returned index.
+   *
+   * Same as select(@rank) followed by clear() of the returned index, but the underlying Fenwick
+   * tree is traversed once. This method returns SIZE_MAX (and changes nothing) if no such an index
+   * exists.
+   *
+   */
+  virtual size_t selectAndClear(uint64_t rank) {
+    const size_t pos = select(rank);
+    if (pos != SIZE_MAX)
+      clear(pos);
+
+    return pos;
+  }
+
   /**
    * bitCount() - Estimation of the size (in bits) of this structure.
    *
    */
   virtual size_t bitCount() const = 0;
 
+  /**
+   * memoryReport() - Breakdown of the memory used by this structure.
+   *
+   * The bitvector is accounted as payload together with the nodes of the underlying Fenwick tree.
+   *
+   */
+  virtual MemoryReport memoryReport() const = 0;
+
+  /**
+   * stats() - Snapshot of the instrumentation counters.
+   *
+   * It is always empty unless HFT_INSTRUMENT is defined (see hft::Stats).
+   *
+   */
+  virtual Stats stats() const {
+#ifdef HFT_INSTRUMENT
+    return Statistics;
+#else
+    return Stats();
+#endif
+  }
+
+  /**
+   * resetStats() - Zero the instrumentation counters.
+   *
+   */
+  virtual void resetStats() {
+#ifdef HFT_INSTRUMENT
+    Statistics = Stats();
+#endif
+  }
+
   /**
    * Each RankSelect is serializable and deserializable with:
    * - friend std::ostream &operator<<(std::ostream &os, const RankSelect &bv);
@@ -137,8 +430,206 @@ public:
    * data structures without any compatibility layer.
    *
    */
+
+protected:
+  /**
+   * BATCH - Queries of a batch whose tree traversals run before any word of the bit vector is read.
+   *
+   */
+  static constexpr size_t BATCH = 64;
+
+  // bits of the word @index in the range [@from, @to)
+  static uint64_t rangeMask(size_t index, size_t from, size_t to) {
+    uint64_t mask = UINT64_MAX;
+    if (index == from / 64)
+      mask &= UINT64_MAX << (from % 64);
+    if (index == (to - 1) / 64)
+      mask &= UINT64_MAX >> (63 - (to - 1) % 64);
+
+    return mask;
+  }
+
+  // @op between the @count words of @dst and the ones of @oth from the word @index
+  static void combineWords(BitOp op, uint64_t *dst, const RankSelect &oth, size_t index,
+                           size_t count) {
+    const uint64_t *src = oth.wordAt(index);
+    if (count > 1 && oth.wordAt(index + count - 1) != src + count - 1) {
+      // not contiguous (e.g. Line)
+      for (size_t i = 0; i < count; i++)
+        combineWords(op, dst + i, oth, index + i, 1);
+      return;
+    }
+
+    // a loop per operation, so that each one is vectorized
+    switch (op) {
+    case AND:
+      for (size_t i = 0; i < count; i++)
+        dst[i] &= src[i];
+      break;
+    case OR:
+      for (size_t i = 0; i < count; i++)
+        dst[i] |= src[i];
+      break;
+    case XOR:
+      for (size_t i = 0; i < count; i++)
+        dst[i] ^= src[i];
+      break;
+    case ANDNOT:
+      for (size_t i = 0; i < count; i++)
+        dst[i] &= ~src[i];
+      break;
+    }
+  }
+
+#ifdef HFT_INSTRUMENT
+  mutable Stats Statistics;
+#endif
 };
 
+/**
+ * Bits - Range of the 1-bits (or 0-bits) of a RankSelect, see RankSelect::onesFrom().
+ *
+ * Its iterators hold the word of the current bit, with the bits already visited cleared: moving
+ * to the next bit takes a tzcnt (lzcnt going down) while the word has any. Then the following
+ * words, which are prefetched, are read one by one, and only past SCAN empty words the iterator
+ * seeks through the structure (and its Fenwick tree).
+ *
+ */
+class Bits {
+public:
+  class Iterator {
+  private:
+    // words prefetched ahead of the current one, and read before seeking
+    static constexpr size_t AHEAD = 16, SCAN = 64;
+
+    const RankSelect *Bv = nullptr;
+    size_t Size = 0, Words = 0, Pos = SIZE_MAX;
+    uint64_t Word = 0, Flip = 0;
+    bool Down = false;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const size_t *;
+    using reference = size_t;
+
+    Iterator() = default;
+
+    Iterator(const RankSelect *bv, size_t pos, uint64_t flip, bool down)
+        : Bv(bv), Size(bv->size()), Words((Size + 63) / 64), Flip(flip), Down(down) {
+      seek(pos);
+    }
+
+    size_t operator*() const { return Pos; }
+
+    Iterator &operator++() {
+      if (Down) {
+        Word &= ~(uint64_t(1) << (Pos % 64));
+        if (Word) {
+          Pos = Pos / 64 * 64 + 63 - __builtin_clzll(Word);
+          return *this;
+        }
+
+        size_t index = Pos / 64;
+        for (const size_t last = index - min(index, SCAN); index > last;) {
+          Word = load(--index);
+          if (Word) {
+            Pos = index * 64 + 63 - __builtin_clzll(Word);
+            prefetch(Bv->wordAt(index - min(index, AHEAD)));
+            return *this;
+          }
+        }
+
+        if (index == 0)
+          Pos = SIZE_MAX;
+        else
+          seek(index * 64 - 1);
+      } else {
+        Word &= Word - 1;
+        if (Word) {
+          Pos = Pos / 64 * 64 + __builtin_ctzll(Word);
+          return *this;
+        }
+
+        size_t index = Pos / 64 + 1;
+        for (const size_t last = min(Words, index + SCAN); index < last; index++) {
+          Word = load(index);
+          if (Word) {
+            Pos = index * 64 + __builtin_ctzll(Word);
+            prefetch(Bv->wordAt(min(Words - 1, index + AHEAD)));
+            return *this;
+          }
+        }
+
+        if (index == Words)
+          Pos = SIZE_MAX;
+        else
+          seek(index * 64);
+      }
+
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    bool operator==(const Iterator &oth) const { return Pos == oth.Pos; }
+
+    bool operator!=(const Iterator &oth) const { return Pos != oth.Pos; }
+
+  private:
+    // the word @index XOR-ed with Flip, without the zeroes padding the last one
+    uint64_t load(size_t index) const {
+      const uint64_t word = *Bv->wordAt(index) ^ Flip;
+      return index == Size / 64 ? word & ((uint64_t(1) << (Size % 64)) - 1) : word;
+    }
+
+    // the first bit from @pos on (the last one up to @pos going down) and the rest of its word
+    void seek(size_t pos) {
+      if (Down)
+        Pos = Flip ? Bv->prevZero(pos) : Bv->prevOne(pos);
+      else
+        Pos = Flip ? Bv->nextZero(pos) : Bv->nextOne(pos);
+
+      if (Pos == SIZE_MAX)
+        return;
+
+      const size_t index = Pos / 64;
+      if (Down) {
+        prefetch(Bv->wordAt(index - min(index, AHEAD)));
+        Word = load(index) & (UINT64_MAX >> (63 - Pos % 64));
+      } else {
+        prefetch(Bv->wordAt(min(Words - 1, index + AHEAD)));
+        Word = load(index) & (UINT64_MAX << (Pos % 64));
+      }
+    }
+  };
+
+private:
+  Iterator First;
+
+public:
+  Bits(const RankSelect *bv, size_t pos, uint64_t flip, bool down) : First(bv, pos, flip, down) {}
+
+  Iterator begin() const { return First; }
+
+  Iterator end() const { return Iterator(); }
+};
+
+inline Bits RankSelect::onesFrom(size_t pos) const { return Bits(this, pos, 0, false); }
+
+inline Bits RankSelect::zerosFrom(size_t pos) const { return Bits(this, pos, UINT64_MAX, false); }
+
+inline Bits RankSelect::onesDownFrom(size_t pos) const { return Bits(this, pos, 0, true); }
+
+inline Bits RankSelect::zerosDownFrom(size_t pos) const {
+  return Bits(this, pos, UINT64_MAX, true);
+}
+
 } // namespace hft::ranking
 
 #endif // __RANK_SELECT_HPP__
@@ -0,0 +1,284 @@
+#ifndef __RANKSELECT_REPLICATED_HPP__
+#define __RANKSELECT_REPLICATED_HPP__
+
+#include "../replicas.hpp"
+#include "rank_select.hpp"
+#include <memory>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+namespace hft::ranking {
+
+template <typename T> class Hinted;
+
+template <typename T> struct is_hinted : std::false_type {};
+template <typename T> struct is_hinted<Hinted<T>> : std::true_type {};
+
+/**
+ * Replicated - One copy of a rank & select data structure per NUMA node.
+ * @bitvector: A bitvector of 64-bit words.
+ * @size: The length (in words) of the bitvector.
+ * @replicas: number of copies (by default, one per NUMA node).
+ * @T: Replicated data structure (e.g. Stride<ByteL, 8>).
+ *
+ * Queries are answered by the replica local to the calling thread. Updates are applied to the local
+ * replica, so that their result can be returned, and logged for the other ones which replay them
+ * in a batch before their next query (see hft::Replicas).
+ *
+ * Many threads query a replica at the same time, so the const queries of @T must be thread-safe:
+ * Hinted, which updates its hints while answering, can't be replicated.
+ *
+ */
+template <typename T> class Replicated : public RankSelect {
+  static_assert(!is_hinted<T>::value, "Hinted queries are not thread-safe");
+
+private:
+  // fused and range updates are logged as a whole, so that no other writer can slip in between
+  // their read and their write: @Words holds the words of RANGE, @Other the operand of COMBINE
+  struct Update {
+    enum Code : uint8_t {
+      UPDATE,
+      SET,
+      CLEAR,
+      TOGGLE,
+      RANKSET,
+      RANKZEROSET,
+      SELECTCLEAR,
+      FILL,
+      EMPTY,
+      RANGE,
+      COMBINE
+    } Op;
+    size_t Index;
+    uint64_t Word;
+    std::shared_ptr<const std::vector<uint64_t>> Words = nullptr;
+    std::shared_ptr<const T> Other = nullptr;
+  };
+
+  static uint64_t apply(T &bv, const Update &op) {
+    switch (op.Op) {
+    case Update::UPDATE:
+      return bv.update(op.Index, op.Word);
+    case Update::SET:
+      return bv.set(op.Index);
+    case Update::CLEAR:
+      return bv.clear(op.Index);
+    case Update::TOGGLE:
+      return bv.toggle(op.Index);
+    case Update::RANKSET:
+      return bv.rankAndSet(op.Index);
+    case Update::RANKZEROSET:
+      return bv.rankZeroAndSet(op.Index);
+    case Update::SELECTCLEAR:
+      return bv.selectAndClear(op.Word);
+    case Update::FILL:
+      bv.fillRange(op.Index, op.Word);
+      return 0;
+    case Update::EMPTY:
+      bv.clearRange(op.Index, op.Word);
+      return 0;
+    case Update::RANGE:
+      bv.updateRange(op.Index, op.Words->data(), op.Words->size());
+      return 0;
+    default:
+      bv.combine(*op.Other, static_cast<BitOp>(op.Word));
+      return 0;
+    }
+  }
+
+  mutable Replicas<T, Update, apply> Copies;
+
+public:
+  Replicated(uint64_t bitvector[], size_t size, size_t replicas = numa::nodes())
+      : Copies(replicas, [&] { return make_unique<T>(bitvector, size); }) {}
+
+  /**
+   * bitvector() - The bit vector of the local replica.
+   *
+   * The pointer is only valid while no update is being issued: the next update replayed on the
+   * local replica rewrites its words in place (and so does wordAt(), and so do the ranges of
+   * onesFrom() and friends, which read the words through it).
+   *
+   */
+  virtual const uint64_t *bitvector() const {
+    return Copies.read([&](const T &bv) { return bv.bitvector(); });
+  }
+
+  virtual const uint64_t *wordAt(size_t index) const {
+    return Copies.read([&](const T &bv) { return bv.wordAt(index); });
+  }
+
+  virtual size_t size() const { return Copies[0].size(); }
+
+  virtual uint64_t rank(size_t pos) const {
+    return Copies.read([&](const T &bv) { return bv.rank(pos); });
+  }
+
+  virtual uint64_t rank(size_t from, size_t to) const {
+    return Copies.read([&](const T &bv) { return bv.rank(from, to); });
+  }
+
+  virtual uint64_t rankZero(size_t pos) const {
+    return Copies.read([&](const T &bv) { return bv.rankZero(pos); });
+  }
+
+  virtual uint64_t rankZero(size_t from, size_t to) const {
+    return Copies.read([&](const T &bv) { return bv.rankZero(from, to); });
+  }
+
+  virtual size_t select(uint64_t rank) const {
+    return Copies.read([&](const T &bv) { return bv.select(rank); });
+  }
+
+  virtual size_t selectZero(uint64_t rank) const {
+    return Copies.read([&](const T &bv) { return bv.selectZero(rank); });
+  }
+
+  virtual void rank(const size_t pos[], uint64_t ranks[], size_t count) const {
+    Copies.read([&](const T &bv) { bv.rank(pos, ranks, count); });
+  }
+
+  virtual void select(const uint64_t rank[], size_t pos[], size_t count) const {
+    Copies.read([&](const T &bv) { bv.select(rank, pos, count); });
+  }
+
+  virtual void selectZero(const uint64_t rank[], size_t pos[], size_t count) const {
+    Copies.read([&](const T &bv) { bv.selectZero(rank, pos, count); });
+  }
+
+  virtual size_t nextOne(size_t pos) const {
+    return Copies.read([&](const T &bv) { return bv.nextOne(pos); });
+  }
+
+  virtual size_t nextZero(size_t pos) const {
+    return Copies.read([&](const T &bv) { return bv.nextZero(pos); });
+  }
+
+  virtual size_t prevOne(size_t pos) const {
+    return Copies.read([&](const T &bv) { return bv.prevOne(pos); });
+  }
+
+  virtual size_t prevZero(size_t pos) const {
+    return Copies.read([&](const T &bv) { return bv.prevZero(pos); });
+  }
+
+  virtual uint64_t update(size_t index, uint64_t word) {
+    return Copies.write({Update::UPDATE, index, word});
+  }
+
+  virtual bool set(size_t index) { return Copies.write({Update::SET, index, 0}); }
+
+  virtual bool clear(size_t index) { return Copies.write({Update::CLEAR, index, 0}); }
+
+  virtual bool toggle(size_t index) { return Copies.write({Update::TOGGLE, index, 0}); }
+
+  virtual uint64_t rankAndSet(size_t pos) { return Copies.write({Update::RANKSET, pos, 0}); }
+
+  virtual uint64_t rankZeroAndSet(size_t pos) {
+    return Copies.write({Update::RANKZEROSET, pos, 0});
+  }
+
+  virtual size_t selectAndClear(uint64_t rank) {
+    return Copies.write({Update::SELECTCLEAR, 0, rank});
+  }
+
+  virtual void fillRange(size_t from, size_t to) { Copies.write({Update::FILL, from, to}); }
+
+  virtual void clearRange(size_t from, size_t to) { Copies.write({Update::EMPTY, from, to}); }
+
+  virtual void updateRange(size_t from, const uint64_t words[], size_t count) {
+    auto range = std::make_shared<const std::vector<uint64_t>>(words, words + count);
+    Copies.write({Update::RANGE, from, 0, std::move(range)});
+  }
+
+  /**
+   * combine() - Replace the bit vector with a boolean operation between it and another one.
+   *
+   * Replicas replay the update lazily, when @oth may have changed or be gone: its words are copied
+   * into a private (and immutable) instance of @T first.
+   *
+   */
+  virtual void combine(const RankSelect &oth, BitOp op) {
+    assert(size() == oth.size());
+    std::vector<uint64_t> words(oth.size() / 64);
+    for (size_t i = 0; i < words.size(); i++)
+      words[i] = *oth.wordAt(i);
+
+    auto other = std::make_shared<const T>(words.data(), words.size());
+    Copies.write({Update::COMBINE, 0, op, nullptr, std::move(other)});
+  }
+
+  virtual size_t bitCount() const {
+    size_t replicas = 0;
+    for (size_t r = 0; r < Copies.size(); r++)
+      replicas += Copies[r].bitCount();
+
+    return sizeof(Replicated<T>) * 8 + replicas;
+  }
+
+  virtual MemoryReport memoryReport() const {
+    MemoryReport report;
+    for (size_t r = 0; r < Copies.size(); r++)
+      report += Copies[r].memoryReport();
+
+    report.Metadata += sizeof(Replicated<T>) * 8;
+    return report;
+  }
+
+  virtual Stats stats() const {
+    Stats stats;
+    for (size_t r = 0; r < Copies.size(); r++)
+      stats += Copies[r].stats();
+
+    return stats;
+  }
+
+  virtual void resetStats() {
+    for (size_t r = 0; r < Copies.size(); r++)
+      Copies[r].resetStats();
+  }
+
+  /**
+   * replicas() - Number of copies of the data structure.
+   *
+   */
+  size_t replicas() const { return Copies.size(); }
+
+  /**
+   * replica() - Bring every copy up to date and return one of them.
+   * @r: Index of the replica.
+   *
+   */
+  const T &replica(size_t r) const {
+    Copies.flush();
+    return Copies[r];
+  }
+
+private:
+  friend std::ostream &operator<<(std::ostream &os, const Replicated<T> &bv) {
+    return os << bv.replica(0);
+  }
+
+  friend std::istream &operator>>(std::istream &is, Replicated<T> &bv) {
+    T first(nullptr, 0);
+    is >> first;
+
+    std::stringstream buffer;
+    buffer << first;
+    const std::string serialized = buffer.str();
+
+    bv.Copies.rebuild(bv.Copies.size(), [&] {
+      std::istringstream in(serialized);
+      auto copy = make_unique<T>(nullptr, 0);
+      in >> *copy;
+      return copy;
+    });
+
+    return is;
+  }
+};
+
+} // namespace hft::ranking
+
+#endif // __RANKSELECT_REPLICATED_HPP__
@@ -1,7 +1,8 @@
 #ifndef __RANKSELECT_STRIDE_HPP__
 #define __RANKSELECT_STRIDE_HPP__
 
-#include "rank_select.hpp"
+#include "../popcount.hpp"
+#include "strided.hpp"
 
 namespace hft::ranking {
 
@@ -12,34 +13,41 @@ namespace hft::ranking {
  * @T: Underlining Fenwick tree with an ungiven <size_t> bound.
  * @WORDS: Length (in words) of the linear search stride.
  *
+ * The bit vector can grow as the one of Word does.
+ *
  */
 template <template <size_t> class T, size_t WORDS>
-class Stride : public RankSelect {
+class Stride : public Strided<Stride<T, WORDS>, WORDS> {
+  friend class Strided<Stride<T, WORDS>, WORDS>;
+  using Base = Strided<Stride<T, WORDS>, WORDS>;
+  using Base::BATCH;
+#ifdef HFT_INSTRUMENT
+  using Base::Statistics;
+#endif
+
 private:
   static constexpr size_t BOUND = 64 * WORDS;
   T<BOUND> Fenwick;
-  DArray<uint64_t> Vector;
+  DArray<uint64_t> Vector; // the bits from the Bits-th on are zero
+  size_t Bits;
 
 public:
   Stride(uint64_t bitvector[], size_t size)
-      : Fenwick(buildFenwick(bitvector, size)), Vector(DArray<uint64_t>(size)) {
+      : Fenwick(buildFenwick(bitvector, size)), Vector(DArray<uint64_t>(size)), Bits(size * 64) {
     std::copy_n(bitvector, size, Vector.get());
   }
 
   Stride(DArray<uint64_t> bitvector, size_t size)
       : Fenwick(buildFenwick(bitvector.get(), size)),
-        Vector(std::move(bitvector)) {}
+        Vector(std::move(bitvector)), Bits(size * 64) {}
 
   virtual const uint64_t *bitvector() const { return Vector.get(); }
 
-  virtual size_t size() const { return Vector.size() * sizeof(uint64_t); }
+  virtual size_t size() const { return Bits; }
 
   virtual uint64_t rank(size_t pos) const {
     size_t idx = pos / (64 * WORDS);
-    uint64_t value = Fenwick.prefix(idx);
-
-    for (size_t i = idx * WORDS; i < pos / 64; i++)
-      value += popcount(Vector[i]);
+    uint64_t value = Fenwick.prefix(idx) + popcount(&Vector[idx * WORDS], pos / 64 - idx * WORDS);
 
     return value + popcount(Vector[pos / 64] & ((1ULL << (pos % 64)) - 1));
   }
@@ -56,36 +64,72 @@ public:
 
   virtual size_t select(uint64_t rank) const {
     size_t idx = Fenwick.find(&rank);
+    HFT_COUNT(Statistics.Selects, 1);
 
-    for (size_t i = idx * WORDS; i < idx * WORDS + WORDS; i++) {
-      if (i >= Vector.size())
-        return SIZE_MAX;
-
-      uint64_t rank_chunk = popcount(Vector[i]);
-      if (rank < rank_chunk)
-        return i * 64 + select64(Vector[i], rank);
-      else
-        rank -= rank_chunk;
-    }
-
-    return SIZE_MAX;
+    return scan(idx, rank, 0);
   }
 
   virtual size_t selectZero(uint64_t rank) const {
     size_t idx = Fenwick.compFind(&rank);
+    HFT_COUNT(Statistics.Selects, 1);
+
+    return scan(idx, rank, ~uint64_t(0));
+  }
 
-    for (size_t i = idx * WORDS; i < idx * WORDS + WORDS; i++) {
-      if (i >= Vector.size())
-        return SIZE_MAX;
+  virtual void rank(const size_t pos[], uint64_t ranks[], size_t count) const {
+    for (size_t i = 0; i < count; i += BATCH) {
+      const size_t end = min(count, i + BATCH);
 
-      uint64_t rank_chunk = popcount(~Vector[i]);
-      if (rank < rank_chunk)
-        return i * 64 + select64(~Vector[i], rank);
-      else
-        rank -= rank_chunk;
+      for (size_t j = i; j < end; j++) {
+        const size_t first = pos[j] / (64 * WORDS) * WORDS;
+        prefetch(&Vector[first], (pos[j] / 64 - first + 1) * sizeof(uint64_t));
+      }
+
+      for (size_t j = i; j < end; j++)
+        ranks[j] = Fenwick.prefix(pos[j] / (64 * WORDS));
+
+      for (size_t j = i; j < end; j++) {
+        const size_t first = pos[j] / (64 * WORDS) * WORDS;
+        ranks[j] += popcount(&Vector[first], pos[j] / 64 - first);
+        ranks[j] += popcount(Vector[pos[j] / 64] & ((1ULL << (pos[j] % 64)) - 1));
+      }
     }
+  }
+
+  virtual void select(const uint64_t rank[], size_t pos[], size_t count) const {
+    uint64_t residual[BATCH];
 
-    return SIZE_MAX;
+    for (size_t i = 0; i < count; i += BATCH) {
+      const size_t end = min(count, i + BATCH);
+
+      for (size_t j = i; j < end; j++) {
+        residual[j - i] = rank[j];
+        pos[j] = Fenwick.find(&residual[j - i]);
+        prefetchStride(pos[j]);
+      }
+
+      HFT_COUNT(Statistics.Selects, end - i);
+      for (size_t j = i; j < end; j++)
+        pos[j] = scan(pos[j], residual[j - i], 0);
+    }
+  }
+
+  virtual void selectZero(const uint64_t rank[], size_t pos[], size_t count) const {
+    uint64_t residual[BATCH];
+
+    for (size_t i = 0; i < count; i += BATCH) {
+      const size_t end = min(count, i + BATCH);
+
+      for (size_t j = i; j < end; j++) {
+        residual[j - i] = rank[j];
+        pos[j] = Fenwick.compFind(&residual[j - i]);
+        prefetchStride(pos[j]);
+      }
+
+      HFT_COUNT(Statistics.Selects, end - i);
+      for (size_t j = i; j < end; j++)
+        pos[j] = scan(pos[j], residual[j - i], ~uint64_t(0));
+    }
   }
 
   virtual uint64_t update(size_t index, uint64_t word) {
@@ -129,13 +173,174 @@ public:
     return was_set;
   }
 
+  virtual uint64_t rankAndSet(size_t pos) {
+    const uint64_t old = Vector[pos / 64];
+    Vector[pos / 64] |= uint64_t(1) << (pos % 64);
+
+    const size_t idx = pos / (64 * WORDS);
+    uint64_t ones = popcount(old & ((1ULL << (pos % 64)) - 1));
+    ones += popcount(&Vector[idx * WORDS], pos / 64 - idx * WORDS);
+
+    if (Vector[pos / 64] == old)
+      return Fenwick.prefix(idx) + ones;
+
+    return Fenwick.prefixAndAdd(idx, 1) + ones;
+  }
+
+  virtual size_t selectAndClear(uint64_t rank) {
+    const size_t idx = Fenwick.findAndAdd(&rank, -1);
+    HFT_COUNT(Statistics.Selects, 1);
+
+    // the tree found the stride holding the bit, and took it into account already
+    const size_t pos = scan(idx, rank, 0);
+    if (pos != SIZE_MAX)
+      Vector[pos / 64] &= ~(uint64_t(1) << (pos % 64));
+
+    return pos;
+  }
+
+  /**
+   * pushBack() - Append a bit to the bit vector.
+   * @bit: Value of the new bit.
+   *
+   * Amortized constant time, plus an add to the tree if @bit is set.
+   *
+   */
+  void pushBack(bool bit) {
+    grow(Bits + 1);
+    if (bit) {
+      Vector[Bits / 64] |= uint64_t(1) << (Bits % 64);
+      Fenwick.add(Bits / (64 * WORDS) + 1, 1);
+    }
+
+    Bits++;
+  }
+
+  /**
+   * appendWords() - Append whole words to the bit vector.
+   * @words: The 64-bit words to append.
+   * @count: Number of words.
+   *
+   * The bit vector doesn't need to be a whole number of words long. As in updateRange(), the tree
+   * is updated a stride at a time or built again, whichever is cheaper.
+   *
+   */
+  void appendWords(const uint64_t words[], size_t count) {
+    const size_t first = Bits / 64, shift = Bits % 64;
+    grow(Bits + count * 64);
+    Bits += count * 64;
+
+    this->rewrite(first, used(), [&](size_t lo, size_t hi) {
+      if (shift == 0) {
+        std::copy(words + (lo - first), words + (hi - first), &Vector[lo]);
+        return;
+      }
+
+      for (size_t i = lo; i < hi; i++) {
+        const size_t j = i - first;
+        Vector[i] |= (j < count ? words[j] << shift : 0) | (j ? words[j - 1] >> (64 - shift) : 0);
+      }
+    });
+  }
+
+  /**
+   * resize() - Change the length of the bit vector.
+   * @bits: New length (in bits), new bits are zero.
+   *
+   * Shrinking the bit vector doesn't release any memory.
+   *
+   */
+  void resize(size_t bits) {
+    if (bits < Bits)
+      this->clearRange(bits, Bits);
+    else
+      grow(bits);
+
+    Bits = bits;
+  }
+
+  /**
+   * reserve() - Make room for a bit vector of a given length.
+   * @bits: Length (in bits).
+   *
+   */
+  void reserve(size_t bits) {
+    if (bits <= capacity())
+      return;
+
+    Vector.resize((bits + 63) / 64);
+    Fenwick = buildFenwick(Vector.get(), Vector.size());
+  }
+
+  /**
+   * capacity() - Length (in bits) the bit vector can grow to without moving.
+   *
+   */
+  size_t capacity() const { return Vector.size() * 64; }
+
   virtual size_t bitCount() const {
-    return sizeof(Stride<T, WORDS>) +
-           Vector.bitCount() - sizeof(Vector) +
-           Fenwick.bitCount() - sizeof(Fenwick);
+    return sizeof(Stride<T, WORDS>) * 8 +
+           Vector.bitCount() - sizeof(Vector) * 8 +
+           Fenwick.bitCount() - sizeof(Fenwick) * 8;
+  }
+
+  virtual Stats stats() const {
+    Stats stats = Fenwick.stats();
+
+#ifdef HFT_INSTRUMENT
+    stats.Selects = Statistics.Selects;
+    stats.Scanned = Statistics.Scanned;
+#endif
+
+    return stats;
+  }
+
+  virtual void resetStats() {
+    RankSelect::resetStats();
+    Fenwick.resetStats();
+  }
+
+  virtual MemoryReport memoryReport() const {
+    MemoryReport report = Fenwick.memoryReport();
+    report += Vector.memoryReport(Bits);
+    report.Metadata += sizeof(Stride<T, WORDS>) * 8 - sizeof(Fenwick) * 8;
+    return report;
   }
 
 private:
+  // words holding the bit vector
+  size_t used() const { return (Bits + 63) / 64; }
+
+  // make room for @bits bits and one more (a rank of the length reads its word), at least doubling
+  void grow(size_t bits) {
+    if (bits >= capacity())
+      reserve(max(bits + 1, 2 * capacity()));
+  }
+
+  void rebuild() { Fenwick = buildFenwick(Vector.get(), Vector.size()); }
+
+  void prefetchStride(size_t idx) const {
+    if (idx * WORDS < used())
+      prefetch(&Vector[idx * WORDS], (min(used(), idx * WORDS + WORDS) - idx * WORDS) * 8);
+  }
+
+  // position of the @rank-th 1-bit of the words (XOR-ed with @flip) of the stride @idx
+  size_t scan(size_t idx, uint64_t rank, uint64_t flip) const {
+    const size_t first = idx * WORDS;
+    if (first >= used())
+      return SIZE_MAX;
+
+    const size_t words = min(WORDS, used() - first);
+    const size_t i = select_word(&Vector[first], words, &rank, flip);
+    HFT_COUNT(Statistics.Scanned, min(i + 1, words));
+
+    if (i == words)
+      return SIZE_MAX;
+
+    const size_t pos = (first + i) * 64 + select64(Vector[first + i] ^ flip, rank);
+    return pos < Bits ? pos : SIZE_MAX;
+  }
+
   static T<BOUND> buildFenwick(const uint64_t bitvector[], size_t size) {
     uint64_t *sequence = new uint64_t[size / WORDS + 1]();
     for (size_t i = 0; i < size; i++)
@@ -147,10 +352,14 @@ private:
   }
 
   friend std::ostream &operator<<(std::ostream &os, const Stride<T, WORDS> &bv) {
+    Stride::writeLength(os, bv.Bits);
     return os << bv.Fenwick << bv.Vector;
   }
 
   friend std::istream &operator>>(std::istream &is, Stride<T, WORDS> &bv) {
+    if (!Stride::readLength(is, &bv.Bits))
+      return is;
+
     return is >> bv.Fenwick >> bv.Vector;
   }
 };
@@ -0,0 +1,192 @@
+#ifndef __RANKSELECT_STRIDED_HPP__
+#define __RANKSELECT_STRIDED_HPP__
+
+#include "../popcount.hpp"
+#include "rank_select.hpp"
+#include <iostream>
+
+namespace hft::ranking {
+
+/**
+ * Strided - Range updates and scans shared by the data structures counting strides of words.
+ * @D: The derived data structure (e.g. Word, Stride or Counted).
+ * @WORDS: Length (in words) of the strides counted by the Fenwick tree.
+ * @SCAN: Length (in words) of the blocks nextOne() and friends scan before searching the tree.
+ *
+ * @D keeps its words in the DArray Vector, counted (all of them) by the Fenwick tree Fenwick. It
+ * tells how many words hold the bit vector with used(), builds the tree again with rebuild() and
+ * can hide recount() to refresh whatever else it knows about a stride whose words changed, or
+ * prev() to scan backwards in its own way.
+ *
+ */
+template <typename D, size_t WORDS, size_t SCAN = WORDS> class Strided : public RankSelect {
+  static_assert(SCAN % WORDS == 0, "a scanned block must be made of whole strides");
+
+  static constexpr char MAGIC[8] = {'H', 'F', 'T', 'R', 'A', 'N', 'K', 'S'};
+  static constexpr uint32_t VERSION = 1;
+
+public:
+  virtual size_t nextOne(size_t pos) const { return self().next(pos, 0); }
+
+  virtual size_t nextZero(size_t pos) const { return self().next(pos, ~uint64_t(0)); }
+
+  virtual size_t prevOne(size_t pos) const { return self().prev(pos, 0); }
+
+  virtual size_t prevZero(size_t pos) const { return self().prev(pos, ~uint64_t(0)); }
+
+  virtual void updateRange(size_t from, const uint64_t words[], size_t count) {
+    uint64_t *vector = self().Vector.get();
+    rewrite(from, from + count, [&](size_t lo, size_t hi) {
+      std::copy(words + (lo - from), words + (hi - from), vector + lo);
+    });
+  }
+
+  virtual void fillRange(size_t from, size_t to) {
+    uint64_t *vector = self().Vector.get();
+    if (from < to)
+      rewrite(from / 64, (to - 1) / 64 + 1, [&](size_t lo, size_t hi) {
+        vector[lo] |= rangeMask(lo, from, to);
+        if (hi - lo > 1) {
+          std::fill(vector + lo + 1, vector + hi - 1, UINT64_MAX);
+          vector[hi - 1] |= rangeMask(hi - 1, from, to);
+        }
+      });
+  }
+
+  virtual void clearRange(size_t from, size_t to) {
+    uint64_t *vector = self().Vector.get();
+    if (from < to)
+      rewrite(from / 64, (to - 1) / 64 + 1, [&](size_t lo, size_t hi) {
+        vector[lo] &= ~rangeMask(lo, from, to);
+        if (hi - lo > 1) {
+          std::fill(vector + lo + 1, vector + hi - 1, 0);
+          vector[hi - 1] &= ~rangeMask(hi - 1, from, to);
+        }
+      });
+  }
+
+  virtual void combine(const RankSelect &oth, BitOp op) {
+    assert(size() == oth.size());
+    uint64_t *vector = self().Vector.get();
+    rewrite(0, self().used(),
+            [&](size_t lo, size_t hi) { combineWords(op, vector + lo, oth, lo, hi - lo); });
+  }
+
+protected:
+  // let @change rewrite the words [@first, @last) a stride at a time, then update the tree
+  template <typename F> void rewrite(size_t first, size_t last, F &&change) {
+    if (first >= last)
+      return;
+
+    D &bv = self();
+    uint64_t *vector = bv.Vector.get();
+
+    // adding to most strides costs more than building the tree again
+    const size_t strides = bv.Vector.size() / WORDS + 1, begin = first / WORDS;
+    const size_t end = (last - 1) / WORDS + 1;
+    if ((end - begin) * ceil_log2_plus1(strides) >= strides) {
+      change(first, last);
+      bv.rebuild();
+      return;
+    }
+
+    for (size_t idx = begin; idx < end; idx++) {
+      const size_t lo = max(first, idx * WORDS), hi = min(last, idx * WORDS + WORDS);
+      const int64_t ones = popcount(vector + lo, hi - lo);
+      change(lo, hi);
+      bv.recount(idx, lo);
+
+      const int64_t delta = popcount(vector + lo, hi - lo) - ones;
+      if (delta)
+        bv.Fenwick.add(idx + 1, delta);
+    }
+  }
+
+  // the words of the stride @idx changed from the @lo-th on
+  void recount(size_t, size_t) {}
+
+  // a tag precedes the length in bits, which the layout of fixed-size bit vectors lacks
+  static void writeLength(std::ostream &os, size_t bits) {
+    const uint32_t version = hton(VERSION);
+    const uint64_t nbits = hton(static_cast<uint64_t>(bits));
+    os.write(MAGIC, sizeof(MAGIC));
+    os.write((char *)&version, sizeof(uint32_t));
+    os.write((char *)&nbits, sizeof(uint64_t));
+  }
+
+  // any other layout (or version) fails the stream
+  static bool readLength(std::istream &is, size_t *bits) {
+    char magic[sizeof(MAGIC)];
+    uint32_t version;
+    uint64_t nbits;
+    is.read(magic, sizeof(MAGIC));
+    is.read((char *)&version, sizeof(uint32_t));
+    is.read((char *)&nbits, sizeof(uint64_t));
+
+    if (!is || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || ntoh(version) != VERSION) {
+      is.setstate(std::ios::failbit);
+      return false;
+    }
+
+    *bits = ntoh(nbits);
+    return true;
+  }
+
+  // first 1-bit from @pos on in the words XOR-ed with @flip, the rest of its block first
+  size_t next(size_t pos, uint64_t flip) const {
+    const D &bv = self();
+    const uint64_t *vector = bv.Vector.get();
+    size_t i = pos / 64;
+    if (i >= bv.used())
+      return SIZE_MAX;
+
+    const size_t last = min(bv.used(), (i / SCAN + 1) * SCAN);
+    for (uint64_t word = (vector[i] ^ flip) & (UINT64_MAX << (pos % 64));;) {
+      if (word) {
+        // the zeroes padding the last word are not in the bit vector
+        const size_t found = i * 64 + __builtin_ctzll(word);
+        return found < bv.D::size() ? found : SIZE_MAX;
+      }
+      if (++i == last)
+        break;
+      word = vector[i] ^ flip;
+    }
+
+    if (last == bv.used())
+      return SIZE_MAX;
+
+    // the strides before @last hold all the bits to skip
+    const uint64_t ones = bv.Fenwick.prefix(last / WORDS);
+    return flip ? bv.D::selectZero(last * 64 - ones) : bv.D::select(ones);
+  }
+
+  // last 1-bit up to @pos in the words XOR-ed with @flip, the rest of its block first
+  size_t prev(size_t pos, uint64_t flip) const {
+    const D &bv = self();
+    const uint64_t *vector = bv.Vector.get();
+    size_t i = pos / 64;
+    const size_t first = i / SCAN * SCAN;
+    for (uint64_t word = (vector[i] ^ flip) & (UINT64_MAX >> (63 - pos % 64));;) {
+      if (word)
+        return i * 64 + 63 - __builtin_clzll(word);
+      if (i-- == first)
+        break;
+      word = vector[i] ^ flip;
+    }
+
+    const uint64_t ones = bv.Fenwick.prefix(first / WORDS), bits = flip ? first * 64 - ones : ones;
+    if (bits == 0)
+      return SIZE_MAX;
+
+    return flip ? bv.D::selectZero(bits - 1) : bv.D::select(bits - 1);
+  }
+
+private:
+  D &self() { return static_cast<D &>(*this); }
+
+  const D &self() const { return static_cast<const D &>(*this); }
+};
+
+} // namespace hft::ranking
+
+#endif // __RANKSELECT_STRIDED_HPP__
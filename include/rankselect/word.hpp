@@ -1,7 +1,7 @@
 #ifndef __RANKSELECT_WORD_HPP__
 #define __RANKSELECT_WORD_HPP__
 
-#include "rank_select.hpp"
+#include "strided.hpp"
 
 namespace hft::ranking {
 
@@ -11,26 +11,37 @@ namespace hft::ranking {
  * @size: The length (in words) of the bitvector.
  * @T: Underlining Fenwick tree with an ungiven <size_t> bound.
  *
+ * The bit vector can grow (see pushBack(), appendWords() and resize()): the words are kept in an
+ * array with room for more, whose tree is built again only when the array doubles.
+ *
  */
-template <template <size_t> class T> class Word : public RankSelect {
+template <template <size_t> class T> class Word : public Strided<Word<T>, 1, 8> {
+  friend class Strided<Word<T>, 1, 8>;
+  using Base = Strided<Word<T>, 1, 8>;
+  using Base::BATCH;
+#ifdef HFT_INSTRUMENT
+  using Base::Statistics;
+#endif
+
 private:
   static constexpr size_t BOUNDSIZE = 64;
   T<BOUNDSIZE> Fenwick;
-  DArray<uint64_t> Vector;
+  DArray<uint64_t> Vector; // the bits from the Bits-th on are zero
+  size_t Bits;
 
 public:
   Word(uint64_t bitvector[], size_t size)
-      : Fenwick(buildFenwick(bitvector, size)), Vector(DArray<uint64_t>(size)) {
+      : Fenwick(buildFenwick(bitvector, size)), Vector(DArray<uint64_t>(size)), Bits(size * 64) {
     std::copy_n(bitvector, size, Vector.get());
   }
 
   Word(DArray<uint64_t> bitvector, size_t size)
       : Fenwick(buildFenwick(bitvector.get(), size)),
-        Vector(std::move(bitvector)) {}
+        Vector(std::move(bitvector)), Bits(size * 64) {}
 
   virtual const uint64_t *bitvector() const { return Vector.get(); }
 
-  virtual size_t size() const { return Vector.size() * sizeof(uint64_t); }
+  virtual size_t size() const { return Bits; }
 
   virtual uint64_t rank(size_t pos) const {
     return Fenwick.prefix(pos / 64) +
@@ -50,9 +61,11 @@ public:
   virtual size_t select(uint64_t rank) const {
     size_t idx = Fenwick.find(&rank);
 
-    if (idx >= Vector.size())
+    HFT_COUNT(Statistics.Selects, 1);
+    if (idx >= used())
       return SIZE_MAX;
 
+    HFT_COUNT(Statistics.Scanned, 1);
     uint64_t rank_chunk = popcount(Vector[idx]);
     if (rank < rank_chunk)
       return idx * 64 + select64(Vector[idx], rank);
@@ -63,14 +76,89 @@ public:
   virtual size_t selectZero(uint64_t rank) const {
     const size_t idx = Fenwick.compFind(&rank);
 
-    if (idx >= Vector.size())
+    HFT_COUNT(Statistics.Selects, 1);
+    if (idx >= used())
       return SIZE_MAX;
 
+    HFT_COUNT(Statistics.Scanned, 1);
     uint64_t rank_chunk = popcount(~Vector[idx]);
-    if (rank < rank_chunk)
-      return idx * 64 + select64(~Vector[idx], rank);
+    if (rank >= rank_chunk)
+      return SIZE_MAX;
 
-    return SIZE_MAX;
+    // the last word may be padded with zeroes
+    const size_t pos = idx * 64 + select64(~Vector[idx], rank);
+    return pos < Bits ? pos : SIZE_MAX;
+  }
+
+  virtual void rank(const size_t pos[], uint64_t ranks[], size_t count) const {
+    for (size_t i = 0; i < count; i += BATCH) {
+      const size_t end = min(count, i + BATCH);
+
+      for (size_t j = i; j < end; j++)
+        prefetch(&Vector[pos[j] / 64]);
+
+      for (size_t j = i; j < end; j++)
+        ranks[j] = Fenwick.prefix(pos[j] / 64);
+
+      for (size_t j = i; j < end; j++)
+        ranks[j] += popcount(Vector[pos[j] / 64] & ((1ULL << (pos[j] % 64)) - 1));
+    }
+  }
+
+  virtual void select(const uint64_t rank[], size_t pos[], size_t count) const {
+    uint64_t residual[BATCH];
+
+    for (size_t i = 0; i < count; i += BATCH) {
+      const size_t end = min(count, i + BATCH);
+
+      for (size_t j = i; j < end; j++) {
+        residual[j - i] = rank[j];
+        pos[j] = Fenwick.find(&residual[j - i]);
+        if (pos[j] < used())
+          prefetch(&Vector[pos[j]]);
+      }
+
+      HFT_COUNT(Statistics.Selects, end - i);
+      for (size_t j = i; j < end; j++) {
+        const size_t idx = pos[j];
+        pos[j] = SIZE_MAX;
+        if (idx >= used())
+          continue;
+
+        HFT_COUNT(Statistics.Scanned, 1);
+        if (residual[j - i] < (uint64_t)popcount(Vector[idx]))
+          pos[j] = idx * 64 + select64(Vector[idx], residual[j - i]);
+      }
+    }
+  }
+
+  virtual void selectZero(const uint64_t rank[], size_t pos[], size_t count) const {
+    uint64_t residual[BATCH];
+
+    for (size_t i = 0; i < count; i += BATCH) {
+      const size_t end = min(count, i + BATCH);
+
+      for (size_t j = i; j < end; j++) {
+        residual[j - i] = rank[j];
+        pos[j] = Fenwick.compFind(&residual[j - i]);
+        if (pos[j] < used())
+          prefetch(&Vector[pos[j]]);
+      }
+
+      HFT_COUNT(Statistics.Selects, end - i);
+      for (size_t j = i; j < end; j++) {
+        const size_t idx = pos[j];
+        pos[j] = SIZE_MAX;
+        if (idx >= used())
+          continue;
+
+        HFT_COUNT(Statistics.Scanned, 1);
+        if (residual[j - i] < (uint64_t)popcount(~Vector[idx]))
+          pos[j] = idx * 64 + select64(~Vector[idx], residual[j - i]);
+        if (pos[j] >= Bits)
+          pos[j] = SIZE_MAX;
+      }
+    }
   }
 
   virtual uint64_t update(size_t index, uint64_t word) {
@@ -114,13 +202,152 @@ public:
     return was_set;
   }
 
+  virtual uint64_t rankAndSet(size_t pos) {
+    const uint64_t old = Vector[pos / 64];
+    Vector[pos / 64] |= uint64_t(1) << (pos % 64);
+
+    const uint64_t ones = popcount(old & ((1ULL << (pos % 64)) - 1));
+    if (Vector[pos / 64] == old)
+      return Fenwick.prefix(pos / 64) + ones;
+
+    return Fenwick.prefixAndAdd(pos / 64, 1) + ones;
+  }
+
+  virtual size_t selectAndClear(uint64_t rank) {
+    const size_t idx = Fenwick.findAndAdd(&rank, -1);
+
+    HFT_COUNT(Statistics.Selects, 1);
+    if (idx >= used())
+      return SIZE_MAX;
+
+    // the tree found the word holding the bit, and took it into account already
+    HFT_COUNT(Statistics.Scanned, 1);
+    const size_t bit = select64(Vector[idx], rank);
+    Vector[idx] &= ~(uint64_t(1) << bit);
+
+    return idx * 64 + bit;
+  }
+
+  /**
+   * pushBack() - Append a bit to the bit vector.
+   * @bit: Value of the new bit.
+   *
+   * Amortized constant time, plus an add to the tree if @bit is set.
+   *
+   */
+  void pushBack(bool bit) {
+    grow(Bits + 1);
+    if (bit) {
+      Vector[Bits / 64] |= uint64_t(1) << (Bits % 64);
+      Fenwick.add(Bits / 64 + 1, 1);
+    }
+
+    Bits++;
+  }
+
+  /**
+   * appendWords() - Append whole words to the bit vector.
+   * @words: The 64-bit words to append.
+   * @count: Number of words.
+   *
+   * The bit vector doesn't need to be a whole number of words long. As in updateRange(), the tree
+   * is updated a word at a time or built again, whichever is cheaper.
+   *
+   */
+  void appendWords(const uint64_t words[], size_t count) {
+    const size_t first = Bits / 64, shift = Bits % 64;
+    grow(Bits + count * 64);
+    Bits += count * 64;
+
+    this->rewrite(first, used(), [&](size_t lo, size_t hi) {
+      if (shift == 0) {
+        std::copy(words + (lo - first), words + (hi - first), &Vector[lo]);
+        return;
+      }
+
+      for (size_t i = lo; i < hi; i++) {
+        const size_t j = i - first;
+        Vector[i] |= (j < count ? words[j] << shift : 0) | (j ? words[j - 1] >> (64 - shift) : 0);
+      }
+    });
+  }
+
+  /**
+   * resize() - Change the length of the bit vector.
+   * @bits: New length (in bits), new bits are zero.
+   *
+   * Shrinking the bit vector doesn't release any memory.
+   *
+   */
+  void resize(size_t bits) {
+    if (bits < Bits)
+      this->clearRange(bits, Bits);
+    else
+      grow(bits);
+
+    Bits = bits;
+  }
+
+  /**
+   * reserve() - Make room for a bit vector of a given length.
+   * @bits: Length (in bits).
+   *
+   */
+  void reserve(size_t bits) {
+    if (bits <= capacity())
+      return;
+
+    Vector.resize((bits + 63) / 64);
+    Fenwick = buildFenwick(Vector.get(), Vector.size());
+  }
+
+  /**
+   * capacity() - Length (in bits) the bit vector can grow to without moving.
+   *
+   */
+  size_t capacity() const { return Vector.size() * 64; }
+
   virtual size_t bitCount() const {
-    return sizeof(Word<T>) +
-           Vector.bitCount() - sizeof(Vector) +
-           Fenwick.bitCount() - sizeof(Fenwick);
+    return sizeof(Word<T>) * 8 +
+           Vector.bitCount() - sizeof(Vector) * 8 +
+           Fenwick.bitCount() - sizeof(Fenwick) * 8;
+  }
+
+  virtual Stats stats() const {
+    Stats stats = Fenwick.stats();
+
+#ifdef HFT_INSTRUMENT
+    stats.Selects = Statistics.Selects;
+    stats.Scanned = Statistics.Scanned;
+#endif
+
+    return stats;
+  }
+
+  virtual void resetStats() {
+    RankSelect::resetStats();
+    Fenwick.resetStats();
+  }
+
+  virtual MemoryReport memoryReport() const {
+    MemoryReport report = Fenwick.memoryReport();
+    report += Vector.memoryReport(Bits);
+    report.Metadata += sizeof(Word<T>) * 8 - sizeof(Fenwick) * 8;
+    return report;
   }
 
 private:
+  // words holding the bit vector
+  size_t used() const { return (Bits + 63) / 64; }
+
+  // make room for @bits bits and one more (a rank of the length reads its word), at least doubling
+  void grow(size_t bits) {
+    if (bits >= capacity())
+      reserve(max(bits + 1, 2 * capacity()));
+  }
+
+  void rebuild() { Fenwick = buildFenwick(Vector.get(), Vector.size()); }
+
   T<BOUNDSIZE> buildFenwick(const uint64_t bitvector[], size_t size) {
     uint64_t *sequence = new uint64_t[size];
     for (size_t i = 0; i < size; i++)
@@ -132,10 +359,14 @@ private:
   }
 
   friend std::ostream &operator<<(std::ostream &os, const Word<T> &bv) {
+    Word::writeLength(os, bv.Bits);
     return os << bv.Fenwick << bv.Vector;
   }
 
   friend std::istream &operator>>(std::istream &is, Word<T> &bv) {
+    if (!Word::readLength(is, &bv.Bits))
+      return is;
+
     return is >> bv.Fenwick >> bv.Vector;
   }
 };
@@ -0,0 +1,220 @@
+#ifndef __REPLICAS_HPP__
+#define __REPLICAS_HPP__
+
+#include "common.hpp"
+#include "numa.hpp"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+namespace hft {
+
+/**
+ * class Replicas - Lazily synchronized copies of a data structure, one per NUMA node.
+ * @T: Replicated data structure.
+ * @Op: Update operation stored in the log.
+ * @APPLY: Function applying an update to a replica and returning its result.
+ *
+ * Every replica is built (and therefore first-touched) by a thread pinned to its own node. Updates
+ * are appended to a single totally ordered log and every replica replays the entries it missed, in
+ * a batch, right before answering a query from a local thread: updates are therefore fanned out
+ * asynchronously, but each thread always reads its own writes. When the log grows past BATCH
+ * entries every lagging replica is forced to catch up, so that the log stays bounded.
+ *
+ * If there are more replicas than nodes (e.g. to simulate them on a single-node machine) queries
+ * are routed by CPU instead of by node.
+ *
+ * Queries and updates can be issued concurrently by any number of threads.
+ *
+ */
+template <typename T, typename Op, uint64_t (*APPLY)(T &, const Op &)> class Replicas {
+public:
+  static constexpr size_t BATCH = 4096;
+
+private:
+  struct Slot {
+    unique_ptr<T> Tree;
+    std::atomic<size_t> Applied{0};
+    std::shared_mutex Mutex;
+  };
+
+  size_t Count = 0;
+  unique_ptr<Slot[]> Slots;
+
+  std::mutex LogMutex;
+  std::vector<Op> Log;
+  size_t Base = 0;
+  std::atomic<size_t> Published{0};
+
+public:
+  /**
+   * Replicas() - Build the replicas.
+   * @count: Number of replicas (at least one).
+   * @build: Callable returning a unique_ptr<T> to a new replica.
+   *
+   */
+  template <typename Build> Replicas(size_t count, Build build) { rebuild(count, build); }
+
+  /**
+   * rebuild() - Throw away every replica (and the pending updates) and build them again.
+   *
+   */
+  template <typename Build> void rebuild(size_t count, Build build) {
+    Count = max<size_t>(count, 1);
+    Slots = make_unique<Slot[]>(Count);
+    Log.clear();
+    Base = 0;
+    Published = 0;
+
+    std::vector<std::thread> pool;
+    for (size_t r = 0; r < Count; r++) {
+      pool.emplace_back([this, r, &build] {
+        if (numa::nodes() > 1)
+          numa::pin(r % numa::nodes());
+
+        Slots[r].Tree = build();
+      });
+    }
+
+    for (auto &worker : pool)
+      worker.join();
+  }
+
+  /**
+   * size() - Number of replicas.
+   *
+   */
+  size_t size() const { return Count; }
+
+  /**
+   * route() - Index of the replica local to the calling thread.
+   *
+   */
+  size_t route() const {
+    if (Count <= numa::nodes())
+      return numa::node() % Count;
+
+    const int cpu = sched_getcpu();
+    return cpu >= 0 ? cpu % Count : 0;
+  }
+
+  /**
+   * read() - Run a query on the local replica, after replaying the missing updates.
+   * @query: Callable taking a const T&.
+   *
+   */
+  template <typename Query> auto read(Query query) {
+    Slot &slot = Slots[route()];
+
+    if (slot.Applied.load(std::memory_order_acquire) != Published.load(std::memory_order_acquire))
+      sync(slot);
+
+    std::shared_lock<std::shared_mutex> guard(slot.Mutex);
+    return query(static_cast<const T &>(*slot.Tree));
+  }
+
+  /**
+   * post() - Log an update without waiting for any replica to apply it.
+   *
+   */
+  void post(const Op &op) {
+    size_t length;
+    publish(op, &length);
+
+    if (length >= BATCH)
+      flush();
+  }
+
+  /**
+   * write() - Log an update and apply it to the local replica.
+   *
+   * Returns the result of the update on the local replica. The update is logged while holding the
+   * replica exclusively, so that no other thread (a writer, a reader catching up or a flush) can
+   * replay it there first and take its result away.
+   *
+   */
+  uint64_t write(const Op &op) {
+    Slot &slot = Slots[route()];
+    size_t length;
+    uint64_t result;
+    {
+      std::unique_lock<std::shared_mutex> guard(slot.Mutex);
+      const size_t seq = publish(op, &length);
+      result = replay(slot, seq);
+    }
+
+    if (length >= BATCH)
+      flush();
+
+    return result;
+  }
+
+  /**
+   * flush() - Bring every replica up to date and empty the log.
+   *
+   */
+  void flush() {
+    for (size_t r = 0; r < Count; r++)
+      sync(Slots[r]);
+
+    std::lock_guard<std::mutex> guard(LogMutex);
+    size_t applied = SIZE_MAX;
+    for (size_t r = 0; r < Count; r++)
+      applied = min(applied, Slots[r].Applied.load());
+
+    Log.erase(Log.begin(), Log.begin() + (applied - Base));
+    Base = applied;
+  }
+
+  /**
+   * operator[] - Direct access to a replica.
+   *
+   * It does not synchronize anything: call flush() first if you need an up-to-date replica.
+   *
+   */
+  T &operator[](size_t r) const { return *Slots[r].Tree; }
+
+private:
+  size_t publish(const Op &op, size_t *length = nullptr) {
+    std::lock_guard<std::mutex> guard(LogMutex);
+    Log.push_back(op);
+    Published.store(Base + Log.size(), std::memory_order_release);
+
+    if (length != nullptr)
+      *length = Log.size();
+
+    return Base + Log.size() - 1;
+  }
+
+  void sync(Slot &slot) {
+    std::unique_lock<std::shared_mutex> guard(slot.Mutex);
+    replay(slot, SIZE_MAX);
+  }
+
+  // replay the missing updates on @slot (held exclusively), returning the result of the @seq-th
+  uint64_t replay(Slot &slot, size_t seq) {
+    size_t from;
+    std::vector<Op> pending;
+    {
+      std::lock_guard<std::mutex> log(LogMutex);
+      from = slot.Applied.load();
+      pending.assign(Log.begin() + (from - Base), Log.end());
+    }
+
+    uint64_t result = 0;
+    for (size_t i = 0; i < pending.size(); i++) {
+      const uint64_t value = APPLY(*slot.Tree, pending[i]);
+      if (from + i == seq)
+        result = value;
+    }
+
+    slot.Applied.store(from + pending.size(), std::memory_order_release);
+    return result;
+  }
+};
+
+} // namespace hft
+
+#endif // __REPLICAS_HPP__
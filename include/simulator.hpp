@@ -0,0 +1,222 @@
+#ifndef __SIMULATOR_HPP__
+#define __SIMULATOR_HPP__
+
+#include "common.hpp"
+#include "model.hpp"
+#include "stats.hpp"
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace hft::model {
+
+/**
+ * struct Misses - Counters of a simulated cache (or TLB).
+ * @Accesses: Blocks looked up.
+ * @Misses: Blocks not found.
+ * @Compulsory: Misses of blocks never looked up before.
+ * @Capacity: Misses that a fully-associative cache of the same size would have too.
+ * @Conflict: Misses that a fully-associative cache of the same size would have avoided.
+ *
+ */
+struct Misses {
+  uint64_t Accesses = 0, Misses = 0, Compulsory = 0, Capacity = 0, Conflict = 0;
+
+  double rate() const { return Accesses ? (double)Misses / Accesses : 0; }
+};
+
+/**
+ * class Cache - Set-associative cache with LRU replacement.
+ * @size: Bytes of the cache.
+ * @ways: Associativity.
+ * @block: Bytes of a block (a line, or a page for a TLB).
+ *
+ * Blocks are mapped to sets by their number modulo the number of sets, as with virtual indexing.
+ * A shadow fully-associative LRU cache of the same capacity classifies the misses (the three
+ * C's): compulsory, capacity and conflict.
+ *
+ */
+class Cache {
+private:
+  size_t Block, Sets, Ways;
+  std::vector<uint64_t> Tags; // block + 1 (0 is empty), most recently used first in each set
+
+  std::list<uint64_t> Lru;
+  std::unordered_map<uint64_t, std::list<uint64_t>::iterator> Where;
+  std::unordered_set<uint64_t> Seen;
+
+  Misses Counters;
+
+public:
+  Cache(size_t size, size_t ways, size_t block)
+      : Block(max<size_t>(block, 1)), Sets(max<size_t>(size / Block / max<size_t>(ways, 1), 1)),
+        Ways(min(max<size_t>(ways, 1), size / Block)), Tags(Sets * Ways) {}
+
+  /**
+   * access() - Look up a block, and bring it in if it is missing.
+   * @block: Number of the block (the address divided by the block size).
+   *
+   * Return: whether the block was found.
+   *
+   */
+  bool access(uint64_t block) {
+    Counters.Accesses++;
+
+    const auto shadow = Where.find(block);
+    const bool shadowed = shadow != Where.end();
+    if (shadowed)
+      Lru.erase(shadow->second);
+    else if (Where.size() == Sets * Ways && !Lru.empty()) {
+      Where.erase(Lru.back());
+      Lru.pop_back();
+    }
+    if (Sets * Ways != 0) {
+      Lru.push_front(block);
+      Where[block] = Lru.begin();
+    }
+
+    uint64_t *set = Tags.data() + (block % Sets) * Ways;
+    size_t way = 0;
+    while (way < Ways && set[way] != block + 1)
+      way++;
+
+    const bool hit = way < Ways;
+    if (!hit) {
+      Counters.Misses++;
+      if (Seen.insert(block).second)
+        Counters.Compulsory++;
+      else if (shadowed)
+        Counters.Conflict++;
+      else
+        Counters.Capacity++;
+      way = Ways - (Ways != 0);
+    }
+
+    if (Ways != 0) {
+      std::copy_backward(set, set + way, set + way + 1);
+      set[0] = block + 1;
+    }
+    return hit;
+  }
+
+  size_t block() const { return Block; }
+
+  const Misses &misses() const { return Counters; }
+
+  /**
+   * reset() - Zero the counters, keeping the content (e.g. after a warm-up).
+   *
+   */
+  void reset() { Counters = Misses(); }
+};
+
+/**
+ * class Simulator - Memory hierarchy of three cache levels and a TLB, fed with addresses.
+ * @hw: Sizes and associativities of the levels.
+ *
+ * Each line of an access looks up the L1, then the L2 if it misses, then the L3 (levels are
+ * neither inclusive nor exclusive: a missing line is brought in every level it missed). Each page
+ * looks up the TLB.
+ *
+ */
+class Simulator {
+private:
+  std::vector<Cache> Levels;
+  Cache Tlb;
+
+public:
+  explicit Simulator(const Hierarchy &hw = Hierarchy::host())
+      : Levels{Cache(hw.Cache[0], hw.Ways[0], hw.Line), Cache(hw.Cache[1], hw.Ways[1], hw.Line),
+               Cache(hw.Cache[2], hw.Ways[2], hw.Line)},
+        Tlb(hw.Tlb * hw.Page, hw.TlbWays, hw.Page) {}
+
+  /**
+   * access() - Simulate a read (or write) of @bytes bytes at @addr.
+   *
+   */
+  void access(uintptr_t addr, size_t bytes) {
+    const uintptr_t end = addr + max<size_t>(bytes, 1) - 1;
+
+    const size_t line = Levels[0].block();
+    for (uintptr_t l = addr / line; l <= end / line; l++) {
+      for (size_t i = 0; i < Levels.size() && !Levels[i].access(l); i++)
+        ;
+    }
+
+    for (uintptr_t p = addr / Tlb.block(); p <= end / Tlb.block(); p++)
+      Tlb.access(p);
+  }
+
+  /**
+   * level() - Counters of the cache level @l (0 for the L1, 2 for the L3).
+   *
+   */
+  const Misses &level(size_t l) const { return Levels[l].misses(); }
+
+  const Misses &tlb() const { return Tlb.misses(); }
+
+  void reset() {
+    for (Cache &c : Levels)
+      c.reset();
+    Tlb.reset();
+  }
+};
+
+/**
+ * replay() - Feed a simulator with the nodes visited by a sequence of operations.
+ * @sim: Simulator.
+ * @size: Number of elements of the tree.
+ * @op: trace::PREFIX, trace::ADD, trace::FIND or trace::COMPFIND.
+ * @args: Arguments of the operations (see path()).
+ * @count: Number of arguments.
+ *
+ * No tree is built: addresses are the offsets given by T::node() from a page-aligned array, read
+ * with 64-bit loads. Use Watch to follow the trees that are not modelled.
+ *
+ */
+template <typename T>
+void replay(Simulator &sim, size_t size, trace::Op op, const size_t args[], size_t count) {
+  static_assert(modelled<T>, "The layout of the tree is not exposed by T::node()");
+
+  for (size_t i = 0; i < count; i++) {
+    for (size_t idx : path(size, op, args[i])) {
+      const auto [first, end] = internal::bytes(T::node(size, idx));
+      sim.access(first, end - first);
+    }
+  }
+}
+
+#ifdef HFT_INSTRUMENT
+/**
+ * class Watch - Feed a simulator with the nodes visited by any data structure of this thread.
+ * @sim: Simulator.
+ *
+ * Nodes are those recorded by the instrumentation (see stats.hpp), at their actual addresses,
+ * while the watch is alive.
+ *
+ */
+class Watch : public stats::Observer {
+private:
+  Simulator &Sim;
+  stats::Observer *const Previous;
+
+public:
+  explicit Watch(Simulator &sim) : Sim(sim), Previous(stats::Observing) {
+    stats::Observing = this;
+  }
+
+  Watch(const Watch &) = delete;
+  Watch &operator=(const Watch &) = delete;
+
+  ~Watch() { stats::Observing = Previous; }
+
+  virtual void node(const void *addr, size_t bytes) {
+    Sim.access(reinterpret_cast<uintptr_t>(addr), bytes);
+  }
+};
+#endif
+
+} // namespace hft::model
+
+#endif // __SIMULATOR_HPP__
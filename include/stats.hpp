@@ -0,0 +1,145 @@
+#ifndef __STATS_HPP__
+#define __STATS_HPP__
+
+#include "common.hpp"
+#include <cstdint>
+
+namespace hft {
+
+/**
+ * struct Counters - Cumulative counters of a kind of operation.
+ * @Calls: Number of calls.
+ * @Nodes: Nodes visited.
+ * @Lines: Distinct cache lines touched (counted once per call).
+ * @Straddles: Reads and writes spanning two 64-bit words (in bitread() and bitwrite_inc()).
+ * @Holes: Holes crossed while moving from a node to the next one.
+ *
+ */
+struct Counters {
+  uint64_t Calls = 0, Nodes = 0, Lines = 0, Straddles = 0, Holes = 0;
+
+  Counters &operator+=(const Counters &oth) {
+    Calls += oth.Calls;
+    Nodes += oth.Nodes;
+    Lines += oth.Lines;
+    Straddles += oth.Straddles;
+    Holes += oth.Holes;
+    return *this;
+  }
+};
+
+/**
+ * struct Stats - Snapshot of the instrumentation counters of a data structure.
+ * @Prefix: Counters of prefix() (rank() for rank & select).
+ * @Add: Counters of add() (updates for rank & select).
+ * @Find: Counters of find() (select() for rank & select).
+ * @CompFind: Counters of compFind() (selectZero() for rank & select).
+ * @Selects: Number of select() and selectZero() calls (rank & select only).
+ * @Scanned: Words scanned linearly by select() and selectZero() (rank & select only).
+ * @Hits: Selects answered from a hint, without searching the tree (ranking::Hinted only).
+ *
+ * Counters are only collected if HFT_INSTRUMENT is defined: otherwise every snapshot is empty and
+ * the instrumentation costs nothing. Counting is not thread-safe.
+ *
+ */
+struct Stats {
+  Counters Prefix, Add, Find, CompFind;
+  uint64_t Selects = 0, Scanned = 0, Hits = 0;
+
+  Stats &operator+=(const Stats &oth) {
+    Prefix += oth.Prefix;
+    Add += oth.Add;
+    Find += oth.Find;
+    CompFind += oth.CompFind;
+    Selects += oth.Selects;
+    Scanned += oth.Scanned;
+    Hits += oth.Hits;
+    return *this;
+  }
+};
+
+#ifdef HFT_INSTRUMENT
+namespace stats {
+
+/**
+ * struct Observer - Receiver of every node visited by the probes of a thread.
+ *
+ * Set Observing to follow the addresses touched by any data structure (see model::Watch).
+ *
+ */
+struct Observer {
+  virtual ~Observer() = default;
+  virtual void node(const void *addr, size_t bytes) = 0;
+};
+
+inline thread_local Observer *Observing = nullptr;
+
+/**
+ * class Probe - Collect the counters of a single operation.
+ * @target: Counters to update when the operation is over.
+ *
+ */
+class Probe {
+private:
+  static constexpr size_t MAXLINES = 256;
+
+  Counters &Target;
+  const uint64_t Straddles0;
+  size_t LastHole = SIZE_MAX;
+  size_t Count = 0;
+  uintptr_t Seen[MAXLINES];
+
+public:
+  explicit Probe(Counters &target) : Target(target), Straddles0(Straddles) { Target.Calls++; }
+
+  Probe(const Probe &) = delete;
+  Probe &operator=(const Probe &) = delete;
+
+  /**
+   * node() - Record the visit of a node.
+   * @addr: Address of the node.
+   * @bytes: Bytes spanned by the node.
+   * @hole: Number of holes preceding the node (zero if the layout has no holes).
+   *
+   */
+  void node(const void *addr, size_t bytes, size_t hole = 0) {
+    Target.Nodes++;
+    if (Observing)
+      Observing->node(addr, bytes);
+
+    if (LastHole != SIZE_MAX && hole != LastHole)
+      Target.Holes++;
+    LastHole = hole;
+
+    const uintptr_t first = reinterpret_cast<uintptr_t>(addr) >> 6;
+    const uintptr_t last = (reinterpret_cast<uintptr_t>(addr) + max<size_t>(bytes, 1) - 1) >> 6;
+    for (uintptr_t line = first; line <= last; line++) {
+      size_t i = 0;
+      while (i < Count && Seen[i] != line)
+        i++;
+
+      if (i == Count && Count < MAXLINES)
+        Seen[Count++] = line;
+    }
+  }
+
+  ~Probe() {
+    Target.Lines += Count;
+    Target.Straddles += Straddles - Straddles0;
+  }
+};
+
+} // namespace stats
+
+#define HFT_PROBE(counters) hft::stats::Probe __hft_probe(counters)
+#define HFT_NODE(...) __hft_probe.node(__VA_ARGS__)
+#define HFT_COUNT(counter, n) ((counter) += (n))
+#else
+#define HFT_PROBE(counters)
+#define HFT_NODE(...)
+#define HFT_COUNT(counter, n)
+#endif
+
+} // namespace hft
+
+#endif // __STATS_HPP__
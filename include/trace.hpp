@@ -0,0 +1,289 @@
+#ifndef __TRACE_HPP__
+#define __TRACE_HPP__
+
+#include "common.hpp"
+#include "fenwick/fenwick_tree.hpp"
+#include "rankselect/rank_select.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+namespace hft::trace {
+
+/**
+ * enum Kind - Data structure a trace was captured from.
+ *
+ */
+enum Kind : uint32_t { FENWICK = 0, RANKSELECT = 1 };
+
+/**
+ * enum Op - Operation codes.
+ *
+ * The argument of the operation is stored in the index and the value of a record: the index of
+ * prefix() and add(), the prefix of find(), the rank of select(), both positions of a range
+ * rank(from, to) (from in the index, to in the value), and so on.
+ *
+ */
+enum Op : uint8_t {
+  PREFIX,
+  ADD,
+  FIND,
+  COMPFIND,
+  RANK,
+  RANKRANGE,
+  RANKZERO,
+  RANKZERORANGE,
+  SELECT,
+  SELECTZERO,
+  UPDATE,
+  SET,
+  CLEAR,
+  TOGGLE,
+};
+
+/**
+ * struct Header - Beginning of a trace file.
+ * @Magic: "HFTTRACE".
+ * @Version: Format version.
+ * @Kind: Fenwick tree or rank & select.
+ * @Size: Length (in 64-bit words) of the snapshot following the header, i.e. the sequence or the
+ * bitvector the data structure was built from.
+ *
+ * The snapshot is followed by the records, up to the end of the file.
+ *
+ */
+struct Header {
+  char Magic[8];
+  uint32_t Version;
+  uint32_t Kind;
+  uint64_t Size;
+};
+
+/**
+ * struct Record - A single operation (16 bytes).
+ * @Code: Operation code (8 most significant bits) and index (56 bits).
+ * @Value: Second argument of the operation.
+ *
+ */
+struct Record {
+  uint64_t Code;
+  uint64_t Value;
+
+  static constexpr uint64_t INDEX = (1ULL << 56) - 1;
+
+  Record() = default;
+  Record(Op op, uint64_t index, uint64_t value)
+      : Code(uint64_t(op) << 56 | (index & INDEX)), Value(value) {}
+
+  Op op() const { return Op(Code >> 56); }
+  uint64_t index() const { return Code & INDEX; }
+};
+
+static_assert(sizeof(Header) == 24 && sizeof(Record) == 16, "Unexpected padding");
+
+constexpr char MAGIC[8] = {'H', 'F', 'T', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t VERSION = 1;
+
+/**
+ * class Writer - Append the records of a trace to a file.
+ * @filename: Trace file (truncated).
+ * @kind: Kind of the traced data structure.
+ * @snapshot: Initial content of the data structure.
+ * @size: Length (in 64-bit words) of @snapshot.
+ *
+ * Records are buffered and written in blocks of BUFFER records. Not thread-safe.
+ *
+ */
+class Writer {
+public:
+  static constexpr size_t BUFFER = 4096;
+
+private:
+  FILE *File = nullptr;
+  std::vector<Record> Buffer;
+  size_t Count = 0;
+
+public:
+  Writer(const std::string &filename, Kind kind, const uint64_t snapshot[], size_t size)
+      : File(fopen(filename.c_str(), "wb")) {
+    assert(File != nullptr && "cannot open the trace file");
+
+    Header header;
+    memcpy(header.Magic, MAGIC, sizeof(MAGIC));
+    header.Version = VERSION;
+    header.Kind = kind;
+    header.Size = size;
+
+    fwrite(&header, sizeof(header), 1, File);
+    if (size)
+      fwrite(snapshot, sizeof(uint64_t), size, File);
+
+    Buffer.reserve(BUFFER);
+  }
+
+  Writer(const Writer &) = delete;
+  Writer &operator=(const Writer &) = delete;
+
+  ~Writer() {
+    flush();
+    fclose(File);
+  }
+
+  void log(Op op, uint64_t index, uint64_t value = 0) {
+    Buffer.emplace_back(op, index, value);
+    Count++;
+
+    if (Buffer.size() == BUFFER)
+      flush();
+  }
+
+  /**
+   * flush() - Write the buffered records to the file.
+   *
+   */
+  void flush() {
+    fwrite(Buffer.data(), sizeof(Record), Buffer.size(), File);
+    fflush(File);
+    Buffer.clear();
+  }
+
+  /**
+   * count() - Number of logged records.
+   *
+   */
+  size_t count() const { return Count; }
+};
+
+/**
+ * class Reader - Memory-mapped trace.
+ * @filename: Trace file.
+ *
+ * The file is mapped privately and writable, so that the snapshot can be handed to the
+ * constructors of the data structures without copying it.
+ *
+ */
+class Reader {
+private:
+  void *Mem = MAP_FAILED;
+  size_t Length = 0;
+  Header *Head = nullptr;
+
+public:
+  explicit Reader(const std::string &filename) {
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      return;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(Header)) {
+      Length = st.st_size;
+      Mem = mmap(nullptr, Length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+
+    if (Mem == MAP_FAILED)
+      return;
+
+    madvise(Mem, Length, MADV_SEQUENTIAL);
+    Head = static_cast<Header *>(Mem);
+  }
+
+  Reader(const Reader &) = delete;
+  Reader &operator=(const Reader &) = delete;
+
+  ~Reader() {
+    if (Mem != MAP_FAILED)
+      munmap(Mem, Length);
+  }
+
+  /**
+   * valid() - Whether the file could be mapped and is a trace of this version.
+   *
+   */
+  bool valid() const {
+    return Head != nullptr && memcmp(Head->Magic, MAGIC, sizeof(MAGIC)) == 0 &&
+           Head->Version == VERSION && sizeof(Header) + Head->Size * 8 <= Length;
+  }
+
+  Kind kind() const { return Kind(Head->Kind); }
+
+  /**
+   * size() - Length (in 64-bit words) of the snapshot.
+   *
+   */
+  size_t size() const { return Head->Size; }
+
+  uint64_t *snapshot() const { return reinterpret_cast<uint64_t *>(Head + 1); }
+
+  const Record *records() const {
+    return reinterpret_cast<const Record *>(snapshot() + Head->Size);
+  }
+
+  /**
+   * count() - Number of records (a truncated last record is ignored).
+   *
+   */
+  size_t count() const { return (Length - sizeof(Header) - Head->Size * 8) / sizeof(Record); }
+};
+
+/**
+ * apply() - Replay a record on a data structure.
+ * @ds: A Fenwick tree or a rank & select data structure.
+ * @rec: Record to replay.
+ *
+ * Return the result of the operation (zero for add()), so that replays on different data
+ * structures can be compared.
+ *
+ */
+template <typename T> inline uint64_t apply(T &ds, const Record &rec) {
+  if constexpr (std::is_base_of_v<fenwick::FenwickTree, T>) {
+    switch (rec.op()) {
+    case PREFIX:
+      return ds.prefix(rec.index());
+    case ADD:
+      ds.add(rec.index(), int64_t(rec.Value));
+      return 0;
+    case FIND:
+      return ds.find(rec.Value);
+    case COMPFIND:
+      return ds.compFind(rec.Value);
+    default:
+      return UINT64_MAX;
+    }
+  } else {
+    switch (rec.op()) {
+    case RANK:
+      return ds.rank(rec.index());
+    case RANKRANGE:
+      return ds.rank(rec.index(), rec.Value);
+    case RANKZERO:
+      return ds.rankZero(rec.index());
+    case RANKZERORANGE:
+      return ds.rankZero(rec.index(), rec.Value);
+    case SELECT:
+      return ds.select(rec.Value);
+    case SELECTZERO:
+      return ds.selectZero(rec.Value);
+    case UPDATE:
+      return ds.update(rec.index(), rec.Value);
+    case SET:
+      return ds.set(rec.index());
+    case CLEAR:
+      return ds.clear(rec.index());
+    case TOGGLE:
+      return ds.toggle(rec.index());
+    default:
+      return UINT64_MAX;
+    }
+  }
+}
+
+} // namespace hft::trace
+
+#endif // __TRACE_HPP__
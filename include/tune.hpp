@@ -0,0 +1,385 @@
+#ifndef __TUNE_HPP__
+#define __TUNE_HPP__
+
+#include "common.hpp"
+#include "fenwick.hpp"
+#include "rankselect.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace hft::tune {
+
+/**
+ * struct Mix - Proportions of the operations of a workload (they don't need to sum to one).
+ * @Read: Weight of prefix() (or rank()).
+ * @Update: Weight of add() (or toggle()).
+ * @Search: Weight of find() (or select()).
+ *
+ */
+struct Mix {
+  double Read = 1, Update = 0, Search = 0;
+};
+
+/**
+ * struct Result - A measured candidate.
+ * @Name: Runtime configuration, accepted by makeTree() or makeRankSelect().
+ * @Type: C++ type of the candidate.
+ * @Ns: Median time per operation (in nanoseconds), NaN if the candidate doesn't fit.
+ * @Bytes: Memory allocated by the candidate (see MemoryReport::total()).
+ * @Fits: Whether @Bytes is within the budget.
+ *
+ */
+struct Result {
+  std::string Name, Type;
+  double Ns = NAN;
+  size_t Bytes = 0;
+  bool Fits = false;
+};
+
+/**
+ * struct Candidate - A configuration the tuner can choose.
+ * @Name: Runtime configuration (e.g. "hybrid<fixedl,bitf,16>" or "stride<bytel,8>").
+ * @Type: C++ type (e.g. "hft::fenwick::Hybrid<hft::fenwick::FixedL, hft::fenwick::BitF, 64, 16>").
+ * @Build: Build the candidate on a sequence (or a bitvector).
+ * @Measure: Replay a workload on fresh copies of the candidate and fill @Ns, @Bytes and @Fits.
+ *
+ */
+template <typename B> struct Candidate {
+  std::string Name, Type;
+  unique_ptr<B> (*Build)(uint64_t[], size_t);
+  void (*Measure)(Result &, uint64_t[], size_t, const trace::Record[], size_t, size_t, unsigned);
+};
+
+/**
+ * measure() - Time a workload on a data structure.
+ *
+ * The structure is built once to read its memory footprint and, if it fits in @budget, rebuilt
+ * before each of the @reps replays of @ops, so that every replay starts from the same content.
+ * Operations are called on the concrete type: no virtual call is measured.
+ *
+ */
+template <typename T>
+void measure(Result &result, uint64_t data[], size_t size, const trace::Record ops[], size_t count,
+             size_t budget, unsigned reps) {
+  using namespace std::chrono;
+
+  result.Bytes = T(data, size).memoryReport().total() / 8;
+  result.Fits = result.Bytes <= budget;
+  if (!result.Fits)
+    return;
+
+  const double items = std::max<size_t>(count, 1);
+  uint64_t u = 0;
+  std::vector<double> times;
+  for (unsigned r = 0; r < std::max(reps, 1U); r++) {
+    T ds(data, size);
+    const auto begin = high_resolution_clock::now();
+    for (size_t i = 0; i < count; i++)
+      u ^= trace::apply(ds, ops[i]);
+    const auto end = high_resolution_clock::now();
+    times.push_back(duration_cast<nanoseconds>(end - begin).count() / items);
+  }
+
+  std::sort(times.begin(), times.end());
+  result.Ns = times[times.size() / 2];
+
+  const volatile uint64_t __attribute__((unused)) unused = u;
+}
+
+template <typename B, typename T>
+Candidate<B> candidate(const std::string &name, const std::string &type) {
+  return {name, type, [](uint64_t data[], size_t size) -> unique_ptr<B> {
+            return std::make_unique<T>(data, size);
+          },
+          measure<T>};
+}
+
+template <template <size_t> class TOP, template <size_t> class BOTTOM, size_t BOUND, size_t... CUTS>
+void hybrids(std::vector<Candidate<fenwick::FenwickTree>> &list, const std::string &top,
+             const std::string &bottom) {
+  auto lower = [](std::string name) {
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    return name;
+  };
+
+  (list.push_back(candidate<fenwick::FenwickTree, fenwick::Hybrid<TOP, BOTTOM, BOUND, CUTS>>(
+       "hybrid<" + lower(top) + "," + lower(bottom) + "," + std::to_string(CUTS) + ">",
+       "hft::fenwick::Hybrid<hft::fenwick::" + top + ", hft::fenwick::" + bottom + ", " +
+           std::to_string(BOUND) + ", " + std::to_string(CUTS) + ">")),
+   ...);
+}
+
+template <template <size_t> class T, size_t... WORDS>
+void strides(std::vector<Candidate<ranking::RankSelect>> &list, const std::string &tree) {
+  std::string name = tree;
+  std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+  list.push_back(candidate<ranking::RankSelect, ranking::Word<T>>(
+      "word<" + name + ">", "hft::ranking::Word<hft::fenwick::" + tree + ">"));
+  list.push_back(candidate<ranking::RankSelect, ranking::Line<T>>(
+      "line<" + name + ">", "hft::ranking::Line<hft::fenwick::" + tree + ">"));
+  (list.push_back(candidate<ranking::RankSelect, ranking::Stride<T, WORDS>>(
+       "stride<" + name + "," + std::to_string(WORDS) + ">",
+       "hft::ranking::Stride<hft::fenwick::" + tree + ", " + std::to_string(WORDS) + ">")),
+   ...);
+  (list.push_back(candidate<ranking::RankSelect, ranking::Counted<T, WORDS>>(
+       "counted<" + name + "," + std::to_string(WORDS) + ">",
+       "hft::ranking::Counted<hft::fenwick::" + tree + ", " + std::to_string(WORDS) + ">")),
+   ...);
+}
+
+/**
+ * treeCandidates() - Fenwick trees the tuner chooses from: every compression and layout, and
+ * hybrids with a level-ordered top, a classical bottom and a few cut points.
+ *
+ * Hybrids are left out when BOUND is so large that the bound of their top would overflow.
+ *
+ */
+template <size_t BOUND> const std::vector<Candidate<fenwick::FenwickTree>> &treeCandidates() {
+  using namespace fenwick;
+
+  static const std::vector<Candidate<FenwickTree>> list = [] {
+    const std::string b = "<" + std::to_string(BOUND) + ">";
+    std::vector<Candidate<FenwickTree>> list = {
+        candidate<FenwickTree, FixedF<BOUND>>("fixedf", "hft::fenwick::FixedF" + b),
+        candidate<FenwickTree, FixedL<BOUND>>("fixedl", "hft::fenwick::FixedL" + b),
+        candidate<FenwickTree, TypeF<BOUND>>("typef", "hft::fenwick::TypeF" + b),
+        candidate<FenwickTree, TypeL<BOUND>>("typel", "hft::fenwick::TypeL" + b),
+        candidate<FenwickTree, ByteF<BOUND>>("bytef", "hft::fenwick::ByteF" + b),
+        candidate<FenwickTree, ByteL<BOUND>>("bytel", "hft::fenwick::ByteL" + b),
+        candidate<FenwickTree, BitF<BOUND>>("bitf", "hft::fenwick::BitF" + b),
+        candidate<FenwickTree, BitL<BOUND>>("bitl", "hft::fenwick::BitL" + b),
+    };
+
+    if constexpr (BOUND <= (UINT64_MAX >> 24)) {
+      hybrids<FixedL, ByteF, BOUND, 12, 16, 20>(list, "FixedL", "ByteF");
+      hybrids<FixedL, BitF, BOUND, 12, 16, 20>(list, "FixedL", "BitF");
+      hybrids<ByteL, ByteF, BOUND, 12, 16, 20>(list, "ByteL", "ByteF");
+      hybrids<ByteL, BitF, BOUND, 12, 16, 20>(list, "ByteL", "BitF");
+    }
+    return list;
+  }();
+
+  return list;
+}
+
+/**
+ * rankSelectCandidates() - Rank & select structures the tuner chooses from: Word, Line, Stride and
+ * Counted with a few strides, on every compression and layout.
+ *
+ */
+inline const std::vector<Candidate<ranking::RankSelect>> &rankSelectCandidates() {
+  using namespace fenwick;
+
+  static const std::vector<Candidate<ranking::RankSelect>> list = [] {
+    std::vector<Candidate<ranking::RankSelect>> list;
+    strides<FixedF, 4, 8, 16, 32>(list, "FixedF");
+    strides<FixedL, 4, 8, 16, 32>(list, "FixedL");
+    strides<ByteF, 4, 8, 16, 32>(list, "ByteF");
+    strides<ByteL, 4, 8, 16, 32>(list, "ByteL");
+    strides<BitF, 4, 8, 16, 32>(list, "BitF");
+    strides<BitL, 4, 8, 16, 32>(list, "BitL");
+    return list;
+  }();
+
+  return list;
+}
+
+template <typename B>
+unique_ptr<B> make(const std::vector<Candidate<B>> &list, const std::string &name, uint64_t data[],
+                   size_t size) {
+  for (const Candidate<B> &c : list)
+    if (c.Name == name)
+      return c.Build(data, size);
+
+  return nullptr;
+}
+
+/**
+ * makeTree() - Runtime factory of Fenwick trees.
+ * @name: Name of one of treeCandidates(), e.g. the one chosen by tree().
+ * @sequence: sequence of integers.
+ * @size: number of elements.
+ *
+ * Return nullptr if the name is unknown.
+ *
+ */
+template <size_t BOUND>
+unique_ptr<fenwick::FenwickTree> makeTree(const std::string &name, uint64_t sequence[],
+                                          size_t size) {
+  return make(treeCandidates<BOUND>(), name, sequence, size);
+}
+
+/**
+ * makeRankSelect() - Runtime factory of rank & select structures.
+ * @name: Name of one of rankSelectCandidates(), e.g. the one chosen by rankSelect().
+ * @bitvector: A bitvector of 64-bit words.
+ * @size: The length (in words) of the bitvector.
+ *
+ * Return nullptr if the name is unknown.
+ *
+ */
+inline unique_ptr<ranking::RankSelect> makeRankSelect(const std::string &name,
+                                                      uint64_t bitvector[], size_t size) {
+  return make(rankSelectCandidates(), name, bitvector, size);
+}
+
+/**
+ * treeOps() - Draw a workload of @count operations for a Fenwick tree built on @sequence.
+ * @mix: Proportions of prefix(), add() and find().
+ * @seed: Seed of the random engine.
+ *
+ * Indices and searched prefix sums are uniformly distributed; increments keep every element
+ * within [0, BOUND] when the workload is replayed on a tree built on @sequence. Record a trace
+ * (see fenwick::Capture) to tune on a real workload instead.
+ *
+ */
+template <size_t BOUND>
+std::vector<trace::Record> treeOps(const uint64_t sequence[], size_t size, const Mix &mix,
+                                   size_t count, uint64_t seed = 0) {
+  std::mt19937_64 re(seed);
+  std::discrete_distribution<int> kind({mix.Read, mix.Update, mix.Search});
+  std::uniform_int_distribution<size_t> index(1, std::max<size_t>(size, 1));
+
+  std::vector<uint64_t> elements(sequence, sequence + size);
+  uint64_t total = 0;
+  for (uint64_t e : elements)
+    total += e;
+
+  std::vector<trace::Record> ops;
+  ops.reserve(count);
+  for (size_t i = 0; i < count && size != 0; i++) {
+    const size_t idx = index(re);
+    switch (kind(re)) {
+    case 0:
+      ops.emplace_back(trace::PREFIX, idx, 0);
+      break;
+    case 1: {
+      const int64_t inc = elements[idx - 1] < BOUND ? 1 : -1;
+      elements[idx - 1] += inc;
+      total += inc;
+      ops.emplace_back(trace::ADD, idx, uint64_t(inc));
+      break;
+    }
+    default:
+      ops.emplace_back(trace::FIND, 0, std::uniform_int_distribution<uint64_t>(0, total)(re));
+    }
+  }
+
+  return ops;
+}
+
+/**
+ * rankSelectOps() - Draw a workload of @count operations for a rank & select structure.
+ * @mix: Proportions of rank(), toggle() and select().
+ * @seed: Seed of the random engine.
+ *
+ * Positions and ranks are uniformly distributed over the bits (and the ones) of @bitvector, as
+ * they are when the workload gets to them.
+ *
+ */
+inline std::vector<trace::Record> rankSelectOps(const uint64_t bitvector[], size_t size,
+                                                const Mix &mix, size_t count, uint64_t seed = 0) {
+  std::mt19937_64 re(seed);
+  std::discrete_distribution<int> kind({mix.Read, mix.Update, mix.Search});
+  std::uniform_int_distribution<size_t> position(0, std::max<size_t>(size * 64, 1) - 1);
+
+  std::vector<uint64_t> bits(bitvector, bitvector + size);
+  uint64_t ones = 0;
+  for (uint64_t word : bits)
+    ones += popcount(word);
+
+  std::vector<trace::Record> ops;
+  ops.reserve(count);
+  for (size_t i = 0; i < count && size != 0; i++) {
+    const size_t pos = position(re);
+    switch (kind(re)) {
+    case 0:
+      ops.emplace_back(trace::RANK, pos, 0);
+      break;
+    case 1:
+      ones += (bits[pos / 64] >> (pos % 64) & 1) ? -1 : 1;
+      bits[pos / 64] ^= 1ULL << (pos % 64);
+      ops.emplace_back(trace::TOGGLE, pos, 0);
+      break;
+    default:
+      const uint64_t last = std::max<uint64_t>(ones, 1) - 1;
+      ops.emplace_back(trace::SELECT, 0, std::uniform_int_distribution<uint64_t>(0, last)(re));
+    }
+  }
+
+  return ops;
+}
+
+/**
+ * rank() - Measure every candidate and sort them: fitting ones by time, then the others by size.
+ *
+ */
+template <typename B>
+std::vector<Result> rank(const std::vector<Candidate<B>> &list, uint64_t data[], size_t size,
+                         const trace::Record ops[], size_t count, size_t budget, unsigned reps) {
+  std::vector<Result> results;
+  for (const Candidate<B> &c : list) {
+    Result result;
+    result.Name = c.Name;
+    result.Type = c.Type;
+    c.Measure(result, data, size, ops, count, budget, reps);
+    results.push_back(result);
+  }
+
+  std::stable_sort(results.begin(), results.end(), [](const Result &a, const Result &b) {
+    if (a.Fits != b.Fits)
+      return a.Fits;
+    return a.Fits ? a.Ns < b.Ns : a.Bytes < b.Bytes;
+  });
+  return results;
+}
+
+/**
+ * tree() - Benchmark every Fenwick tree on a workload.
+ * @sequence: Sequence of integers the trees are built on.
+ * @size: Number of elements.
+ * @ops: Workload, e.g. from treeOps() or from a trace::Reader.
+ * @count: Number of operations.
+ * @budget: Largest acceptable footprint, in bytes.
+ * @reps: Number of replays of the workload (the median is kept).
+ *
+ * Return every candidate, the fastest one fitting in @budget first (see rank()).
+ *
+ */
+template <size_t BOUND>
+std::vector<Result> tree(uint64_t sequence[], size_t size, const trace::Record ops[], size_t count,
+                         size_t budget = SIZE_MAX, unsigned reps = 3) {
+  return rank(treeCandidates<BOUND>(), sequence, size, ops, count, budget, reps);
+}
+
+/**
+ * rankSelect() - Benchmark every rank & select structure on a workload.
+ * @bitvector: Bitvector the structures are built on.
+ * @size: Length (in words) of the bitvector.
+ *
+ * The other parameters and the result are the same of tree().
+ *
+ */
+inline std::vector<Result> rankSelect(uint64_t bitvector[], size_t size, const trace::Record ops[],
+                                      size_t count, size_t budget = SIZE_MAX, unsigned reps = 3) {
+  return rank(rankSelectCandidates(), bitvector, size, ops, count, budget, reps);
+}
+
+/**
+ * snippet() - Type alias of a chosen candidate, ready to be pasted in the code.
+ * @alias: Name of the alias.
+ *
+ */
+inline std::string snippet(const Result &result, const std::string &alias = "Tree") {
+  return "using " + alias + " = " + result.Type + ";";
+}
+
+} // namespace hft::tune
+
+#endif // __TUNE_HPP__
@@ -0,0 +1,175 @@
+#ifndef __TEST_APPEND_HPP__
+#define __TEST_APPEND_HPP__
+
+#include "utils.hpp"
+#include <sstream>
+
+// a growing bit vector, checked against the positions of its bits
+template <typename T> void append_test(std::size_t words)
+{
+    static std::mt19937_64 mte;
+
+    std::vector<bool> bits;
+    std::vector<std::uint64_t> bitvector(words);
+    for (std::size_t i = 0; i < words; i++) {
+        bitvector[i] = mte() & mte();
+        for (std::size_t j = 0; j < 64; j++)
+            bits.push_back(bitvector[i] >> j & 1);
+    }
+
+    T bv(bitvector.data(), words);
+
+    for (std::size_t i = 0; i < 30; i++) {
+        // short appends add to the tree, long ones build it again
+        const std::size_t length = i % 2 ? mte() % 4 : mte() % 300;
+
+        switch (mte() % 4) {
+        case 0:
+            for (std::size_t j = 0; j < 64 * length + mte() % 64; j++) {
+                const bool bit = mte() % 3 == 0;
+                bv.pushBack(bit);
+                bits.push_back(bit);
+            }
+            break;
+        case 1:
+        case 2: {
+            std::vector<std::uint64_t> append(length);
+            for (std::uint64_t &word : append) {
+                word = mte() | mte();
+                for (std::size_t j = 0; j < 64; j++)
+                    bits.push_back(word >> j & 1);
+            }
+            bv.appendWords(append.data(), length);
+            break;
+        }
+        default:
+            // shrinking clears the bits, so that growing again finds zeroes
+            const std::size_t size =
+                mte() % 2 ? mte() % (bits.size() + 1) : bits.size() + mte() % 200;
+            bv.resize(size);
+            bits.resize(size, false);
+        }
+
+        ASSERT_EQ(bits.size(), bv.size());
+        ASSERT_LE(bv.size(), bv.capacity());
+
+        std::vector<std::size_t> ones, zeroes;
+        for (std::size_t pos = 0; pos < bits.size(); pos++)
+            (bits[pos] ? ones : zeroes).push_back(pos);
+
+        for (std::size_t pos = 0; pos < bits.size(); pos += 1 + bits.size() / 100) {
+            ASSERT_EQ(bits[pos], *bv.wordAt(pos / 64) >> (pos % 64) & 1) << "position: " << pos;
+            ASSERT_EQ(std::lower_bound(ones.begin(), ones.end(), pos) - ones.begin(), bv.rank(pos))
+                << "position: " << pos;
+        }
+        ASSERT_EQ(ones.size(), bv.rank(bits.size()));
+
+        for (std::uint64_t rank = 0; rank < ones.size(); rank += 1 + ones.size() / 50)
+            ASSERT_EQ(ones[rank], bv.select(rank)) << "rank: " << rank;
+        for (std::uint64_t rank = 0; rank < zeroes.size(); rank += 1 + zeroes.size() / 50)
+            ASSERT_EQ(zeroes[rank], bv.selectZero(rank)) << "rank: " << rank;
+        ASSERT_EQ(SIZE_MAX, bv.select(ones.size()));
+        ASSERT_EQ(SIZE_MAX, bv.selectZero(zeroes.size()));
+
+        // the zeroes padding the last word are not in the bit vector
+        if (!bits.empty()) {
+            ASSERT_EQ(bits.back() ? SIZE_MAX : bits.size() - 1, bv.nextZero(bits.size() - 1));
+        }
+
+        std::size_t count = 0;
+        for (std::size_t pos : bv.zerosFrom(0))
+            ASSERT_EQ(zeroes[count++], pos);
+        ASSERT_EQ(zeroes.size(), count);
+    }
+}
+
+TEST(append, rankselect)
+{
+    using namespace hft::fenwick;
+    using namespace hft::ranking;
+
+    for (std::size_t words : {0, 1, 9, 100}) {
+        append_test<Word<FixedF>>(words);
+        append_test<Word<TypeL>>(words);
+        append_test<Word<BitF>>(words);
+        append_test<Stride<ByteL, 8>>(words);
+        append_test<Stride<FixedL, 64>>(words);
+    }
+}
+
+// a bit vector whose length is not a multiple of 64 survives a round trip, the old layout doesn't
+template <typename T> void serialization_test(std::size_t words)
+{
+    static std::mt19937_64 mte;
+
+    std::vector<std::uint64_t> bitvector(words);
+    for (std::uint64_t &word : bitvector)
+        word = mte();
+
+    T bv(bitvector.data(), words);
+    bv.resize(64 * words - 13);
+
+    std::stringstream buffer;
+    buffer << bv;
+    T copy(nullptr, 0);
+    buffer >> copy;
+    ASSERT_FALSE(buffer.fail());
+    ASSERT_EQ(bv.size(), copy.size());
+    for (std::size_t pos = 0; pos <= bv.size(); pos += 7)
+        ASSERT_EQ(bv.rank(pos), copy.rank(pos)) << "position: " << pos;
+
+    // the layout of fixed-size bit vectors: the tree, then the words
+    std::stringstream legacy;
+    std::vector<std::uint64_t> counts(words);
+    for (std::size_t i = 0; i < words; i++)
+        counts[i] = hft::popcount(bitvector[i]);
+    hft::DArray<std::uint64_t> array(words);
+    std::copy(bitvector.begin(), bitvector.end(), array.get());
+    legacy << hft::fenwick::FixedF<64>(counts.data(), words) << array;
+
+    T rejected(nullptr, 0);
+    legacy >> rejected;
+    EXPECT_TRUE(legacy.fail());
+}
+
+TEST(append, serialization)
+{
+    using namespace hft::fenwick;
+    using namespace hft::ranking;
+
+    serialization_test<Word<FixedF>>(100);
+    serialization_test<Stride<ByteL, 8>>(100);
+}
+
+TEST(append, darray)
+{
+    hft::DArray<std::uint64_t> array(1000);
+    for (std::size_t i = 0; i < array.size(); i++)
+        array[i] = i;
+
+    // past a page, and back within the first one
+    array.resize(100000);
+    EXPECT_EQ(100000, array.size());
+    for (std::size_t i = 0; i < 1000; i++)
+        EXPECT_EQ(i, array[i]);
+    for (std::size_t i = 1000; i < array.size(); i++)
+        EXPECT_EQ(0, array[i]);
+
+    array.resize(10);
+    array.resize(2000);
+    for (std::size_t i = 0; i < 10; i++)
+        EXPECT_EQ(i, array[i]);
+    for (std::size_t i = 10; i < array.size(); i++)
+        EXPECT_EQ(0, array[i]);
+
+    // pages that can't be moved leave the array as it was
+    EXPECT_THROW(array.resize(SIZE_MAX / 16), std::system_error);
+    EXPECT_EQ(2000, array.size());
+    for (std::size_t i = 0; i < 10; i++)
+        EXPECT_EQ(i, array[i]);
+
+    array.resize(0);
+    EXPECT_EQ(nullptr, array.get());
+}
+
+#endif // __TEST_APPEND_HPP__
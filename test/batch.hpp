@@ -0,0 +1,65 @@
+#ifndef __TEST_BATCH_HPP__
+#define __TEST_BATCH_HPP__
+
+#include "utils.hpp"
+
+template <typename T> void batch_test(std::size_t words)
+{
+    static std::mt19937_64 mte;
+
+    std::uint64_t *bitvector = new std::uint64_t[words];
+    for (std::size_t i = 0; i < words; i++)
+        bitvector[i] = mte() & mte();
+
+    T bv(bitvector, words);
+    const hft::ranking::RankSelect &base = bv;
+    const std::size_t count = 1000;
+    const std::uint64_t ones = bv.rank(64 * words - 1), zeroes = 64 * words - 1 - ones;
+
+    std::vector<std::size_t> pos(count), selected(count);
+    std::vector<std::uint64_t> ranks(count), rankszero(count), results(count);
+    for (std::size_t i = 0; i < count; i++) {
+        pos[i] = mte() % (64 * words);
+        // a few ranks out of range
+        ranks[i] = mte() % (ones + 2);
+        rankszero[i] = mte() % (zeroes + 2);
+    }
+
+    base.rank(pos.data(), results.data(), count);
+    for (std::size_t i = 0; i < count; i++)
+        EXPECT_EQ(bv.rank(pos[i]), results[i]) << "position: " << pos[i];
+
+    base.select(ranks.data(), selected.data(), count);
+    for (std::size_t i = 0; i < count; i++)
+        EXPECT_EQ(bv.select(ranks[i]), selected[i]) << "rank: " << ranks[i];
+
+    base.selectZero(rankszero.data(), selected.data(), count);
+    for (std::size_t i = 0; i < count; i++)
+        EXPECT_EQ(bv.selectZero(rankszero[i]), selected[i]) << "rank: " << rankszero[i];
+
+    // an empty batch, and a batch shorter than a block
+    base.rank(pos.data(), results.data(), 0);
+    base.select(ranks.data(), selected.data(), 3);
+    for (std::size_t i = 0; i < 3; i++)
+        EXPECT_EQ(bv.select(ranks[i]), selected[i]) << "rank: " << ranks[i];
+
+    delete[] bitvector;
+}
+
+TEST(batch, rankselect)
+{
+    using namespace hft::fenwick;
+    using namespace hft::ranking;
+
+    for (std::size_t words : {1, 7, 1000, 100000}) {
+        batch_test<Word<FixedF>>(words);
+        batch_test<Word<ByteL>>(words);
+        batch_test<Word<TypeF>>(words);
+        batch_test<Stride<FixedF, 1>>(words);
+        batch_test<Stride<BitF, 8>>(words);
+        batch_test<Stride<TypeL, 3>>(words);
+        batch_test<hft::ranking::Replicated<Word<BitL>>>(words);
+    }
+}
+
+#endif // __TEST_BATCH_HPP__
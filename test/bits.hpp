@@ -0,0 +1,76 @@
+#ifndef __TEST_BITS_HPP__
+#define __TEST_BITS_HPP__
+
+#include "utils.hpp"
+
+// the four ranges from a few positions, checked against a linear search
+template <typename T> void bits_test(std::size_t words, std::uint64_t density)
+{
+    static std::mt19937_64 mte;
+
+    // about @density 1-bits out of 64, and a long run of equal bits
+    std::uint64_t *bitvector = new std::uint64_t[words];
+    for (std::size_t i = 0; i < words; i++) {
+        bitvector[i] = 0;
+        for (std::size_t j = 0; j < 64; j++)
+            bitvector[i] |= std::uint64_t(mte() % 64 < density) << j;
+    }
+    for (std::size_t i = words / 3; i < words / 2; i++)
+        bitvector[i] = density < 32 ? 0 : UINT64_MAX;
+
+    T bv(bitvector, words);
+    const std::size_t size = 64 * words;
+    auto bit = [&](std::size_t pos) { return bitvector[pos / 64] >> (pos % 64) & 1; };
+
+    for (std::size_t from : {std::size_t(0), size / 3 + 5, size - 1, size}) {
+        std::vector<std::size_t> expected[2], walked[2];
+        for (std::size_t pos = from; pos < size; pos++)
+            expected[bit(pos)].push_back(pos);
+
+        for (std::size_t pos : bv.onesFrom(from))
+            walked[1].push_back(pos);
+        for (std::size_t pos : bv.zerosFrom(from))
+            walked[0].push_back(pos);
+        EXPECT_EQ(expected[1], walked[1]) << "from: " << from;
+        EXPECT_EQ(expected[0], walked[0]) << "from: " << from;
+
+        if (from == size)
+            continue;
+
+        expected[0].clear(), expected[1].clear(), walked[0].clear(), walked[1].clear();
+        for (std::size_t pos = from + 1; pos-- > 0;)
+            expected[bit(pos)].push_back(pos);
+
+        for (std::size_t pos : bv.onesDownFrom(from))
+            walked[1].push_back(pos);
+        for (std::size_t pos : bv.zerosDownFrom(from))
+            walked[0].push_back(pos);
+        EXPECT_EQ(expected[1], walked[1]) << "from: " << from;
+        EXPECT_EQ(expected[0], walked[0]) << "from: " << from;
+    }
+
+    // standard algorithms work on the iterators too
+    const hft::ranking::Bits ones = bv.onesFrom(0);
+    EXPECT_EQ(bv.rank(size), std::uint64_t(std::distance(ones.begin(), ones.end())));
+
+    delete[] bitvector;
+}
+
+TEST(bits, rankselect)
+{
+    using namespace hft::fenwick;
+    using namespace hft::ranking;
+
+    for (std::size_t words : {1, 7, 8, 9, 100, 1000}) {
+        for (std::uint64_t density : {0, 1, 32, 63, 64}) {
+            bits_test<Word<FixedF>>(words, density);
+            bits_test<Stride<ByteL, 16>>(words, density);
+            bits_test<Counted<BitF, 8>>(words, density);
+            bits_test<Line<FixedL>>(words, density);
+            bits_test<Hinted<Word<BitL>>>(words, density);
+            bits_test<hft::ranking::Replicated<Line<ByteF>>>(words, density);
+        }
+    }
+}
+
+#endif // __TEST_BITS_HPP__
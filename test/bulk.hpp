@@ -0,0 +1,102 @@
+#ifndef __TEST_BULK_HPP__
+#define __TEST_BULK_HPP__
+
+#include "utils.hpp"
+
+// range updates and boolean operations, checked against a structure built from scratch
+template <typename T> void bulk_test(std::size_t words)
+{
+    using namespace hft::ranking;
+    static std::mt19937_64 mte;
+
+    std::vector<std::uint64_t> bitvector(words), other(words);
+    for (std::size_t i = 0; i < words; i++) {
+        bitvector[i] = mte() & mte();
+        other[i] = mte() | mte();
+    }
+
+    T bv(bitvector.data(), words);
+    T oth(other.data(), words);
+
+    for (std::size_t i = 0; i < 40; i++) {
+        // short ranges add to the tree, long ones build it again
+        const std::size_t length = i % 2 ? mte() % 4 : mte() % (64 * words + 1);
+        const std::size_t from = mte() % (64 * words - length + 1), to = from + length;
+
+        switch (mte() % 8) {
+        case 0: {
+            const std::size_t first = from / 64, count = std::min(words - first, length / 64);
+            std::vector<std::uint64_t> update(count);
+            for (std::uint64_t &word : update)
+                word = mte();
+            bv.updateRange(first, update.data(), count);
+            std::copy(update.begin(), update.end(), bitvector.begin() + first);
+            break;
+        }
+        case 1:
+            bv.fillRange(from, to);
+            for (std::size_t pos = from; pos < to; pos++)
+                bitvector[pos / 64] |= std::uint64_t(1) << (pos % 64);
+            break;
+        case 2:
+            bv.clearRange(from, to);
+            for (std::size_t pos = from; pos < to; pos++)
+                bitvector[pos / 64] &= ~(std::uint64_t(1) << (pos % 64));
+            break;
+        case 3:
+            bv &= oth;
+            for (std::size_t j = 0; j < words; j++)
+                bitvector[j] &= other[j];
+            break;
+        case 4:
+            bv |= oth;
+            for (std::size_t j = 0; j < words; j++)
+                bitvector[j] |= other[j];
+            break;
+        case 5:
+            bv ^= oth;
+            for (std::size_t j = 0; j < words; j++)
+                bitvector[j] ^= other[j];
+            break;
+        case 6:
+            bv.combine(oth, ANDNOT);
+            for (std::size_t j = 0; j < words; j++)
+                bitvector[j] &= ~other[j];
+            break;
+        default:
+            // the tree must be still right for the single updates
+            bv.toggle(from % (64 * words));
+            bitvector[from % (64 * words) / 64] ^= std::uint64_t(1) << (from % 64);
+        }
+
+        Word<hft::fenwick::FixedF> fresh(bitvector.data(), words);
+        for (std::size_t j = 0; j < words; j++)
+            ASSERT_EQ(bitvector[j], *bv.wordAt(j)) << "word: " << j;
+        for (std::size_t pos = 0; pos <= 64 * words; pos += 1 + words / 4)
+            ASSERT_EQ(fresh.rank(pos), bv.rank(pos)) << "position: " << pos;
+
+        const std::uint64_t ones = fresh.rank(64 * words), zeroes = 64 * words - ones;
+        for (std::uint64_t rank = 0; rank <= ones; rank += 1 + ones / 50)
+            ASSERT_EQ(fresh.select(rank), bv.select(rank)) << "rank: " << rank;
+        for (std::uint64_t rank = 0; rank <= zeroes; rank += 1 + zeroes / 50)
+            ASSERT_EQ(fresh.selectZero(rank), bv.selectZero(rank)) << "rank: " << rank;
+    }
+}
+
+TEST(bulk, rankselect)
+{
+    using namespace hft::fenwick;
+    using namespace hft::ranking;
+
+    for (std::size_t words : {1, 7, 8, 9, 100, 1000}) {
+        bulk_test<Word<FixedF>>(words);
+        bulk_test<Word<TypeL>>(words);
+        bulk_test<Stride<TypeF, 8>>(words);
+        bulk_test<Stride<BitL, 64>>(words);
+        bulk_test<Counted<ByteF, 16>>(words);
+        bulk_test<Line<FixedL>>(words);
+        bulk_test<Hinted<Stride<ByteL, 4>>>(words);
+    }
+}
+
+#endif // __TEST_BULK_HPP__
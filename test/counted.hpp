@@ -0,0 +1,21 @@
+#ifndef __TEST_COUNTED_HPP__
+#define __TEST_COUNTED_HPP__
+
+#include "utils.hpp"
+
+TEST(counted, rankselect)
+{
+    using namespace hft::fenwick;
+    using namespace hft::ranking;
+
+    for (std::size_t words : {1, 6, 7, 8, 63, 64, 65, 1000, 20000}) {
+        mutable_test<Counted<FixedF, 1>>(words);
+        mutable_test<Counted<ByteL, 7>>(words);
+        mutable_test<Counted<BitF, 64>>(words);
+        mutable_test<Counted<FixedL, 128>>(words);
+        mutable_test<Counted<ByteF, 512>>(words);
+        batch_test<Counted<BitL, 64>>(words);
+    }
+}
+
+#endif // __TEST_COUNTED_HPP__
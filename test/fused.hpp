@@ -0,0 +1,110 @@
+#ifndef __TEST_FUSED_HPP__
+#define __TEST_FUSED_HPP__
+
+#include "utils.hpp"
+
+template <typename T> void fused_test(std::size_t size)
+{
+    static std::mt19937_64 mte;
+
+    std::uint64_t *sequence = new std::uint64_t[size];
+    for (std::size_t i = 0; i < size; i++)
+        sequence[i] = mte() % 33;
+
+    hft::fenwick::FixedF<64> plain(sequence, size);
+    T tree(sequence, size);
+
+    for (std::size_t i = 0; i < 4 * size; i++) {
+        // weighted sampling: draw an element, move part of its weight to the one before it
+        const std::uint64_t total = plain.prefix(size);
+        std::uint64_t val = total ? mte() % total : 0, expected_val = val;
+        const std::size_t expected = plain.find(&expected_val);
+        if (expected < size)
+            plain.add(expected + 1, -1);
+
+        EXPECT_EQ(expected, tree.findAndAdd(&val, -1)) << "size: " << size;
+        EXPECT_EQ(expected_val, val) << "size: " << size;
+
+        const std::size_t idx = mte() % (size + 1);
+        const std::uint64_t prefix = plain.prefix(idx);
+        if (idx < size)
+            plain.add(idx + 1, 1);
+
+        EXPECT_EQ(prefix, tree.prefixAndAdd(idx, 1)) << "index: " << idx << ", size: " << size;
+    }
+
+    for (std::size_t i = 0; i <= size; i++)
+        EXPECT_EQ(plain.prefix(i), tree.prefix(i)) << "index: " << i << ", size: " << size;
+
+    delete[] sequence;
+}
+
+TEST(fused, fenwick)
+{
+    using namespace hft::fenwick;
+
+    for (std::size_t size : {0, 1, 2, 7, 64, 1000, 4097}) {
+        fused_test<FixedF<64>>(size);
+        fused_test<FixedL<64>>(size);
+        fused_test<ByteF<64>>(size);
+        fused_test<ByteL<64>>(size);
+        fused_test<BitF<64>>(size);
+        fused_test<BitL<64>>(size);
+        fused_test<TypeF<64>>(size);
+        fused_test<TypeL<64>>(size);
+        fused_test<Hybrid<FixedL, BitF, 64, 4>>(size);
+    }
+}
+
+template <typename T> void fused_rankselect_test(std::size_t words)
+{
+    static std::mt19937_64 mte;
+
+    std::uint64_t *bitvector = new std::uint64_t[words];
+    for (std::size_t i = 0; i < words; i++)
+        bitvector[i] = mte() & mte();
+
+    hft::ranking::Word<hft::fenwick::FixedF> plain(bitvector, words);
+    T bv(bitvector, words);
+
+    for (std::size_t i = 0; i < 64 * words; i++) {
+        const std::size_t pos = mte() % (64 * words);
+        const std::uint64_t zeroes = plain.rankZero(pos);
+        plain.set(pos);
+        EXPECT_EQ(zeroes, bv.rankZeroAndSet(pos)) << "position: " << pos;
+
+        const std::uint64_t ones = plain.rank(64 * words - 1);
+        if (ones == 0)
+            continue;
+
+        const std::uint64_t rank = mte() % ones;
+        const std::size_t selected = plain.select(rank);
+        plain.clear(selected);
+        EXPECT_EQ(selected, bv.selectAndClear(rank)) << "rank: " << rank;
+    }
+
+    EXPECT_EQ(SIZE_MAX, bv.selectAndClear(64 * words));
+    for (std::size_t i = 0; i < words; i++)
+        EXPECT_EQ(plain.bitvector()[i], bv.bitvector()[i]) << "word: " << i;
+    for (std::size_t i = 0; i < 64 * words; i += 61)
+        EXPECT_EQ(plain.rank(i), bv.rank(i)) << "position: " << i;
+
+    delete[] bitvector;
+}
+
+TEST(fused, rankselect)
+{
+    using namespace hft::fenwick;
+    using namespace hft::ranking;
+
+    for (std::size_t words : {1, 3, 100, 1000}) {
+        fused_rankselect_test<Word<FixedF>>(words);
+        fused_rankselect_test<Word<BitL>>(words);
+        fused_rankselect_test<Word<TypeL>>(words);
+        fused_rankselect_test<Stride<ByteF, 4>>(words);
+        fused_rankselect_test<Stride<TypeF, 8>>(words);
+        fused_rankselect_test<Stride<FixedL, 3>>(words);
+    }
+}
+
+#endif // __TEST_FUSED_HPP__
@@ -0,0 +1,79 @@
+#ifndef __TEST_HINTED_HPP__
+#define __TEST_HINTED_HPP__
+
+#include "utils.hpp"
+
+// selects interleaved with updates (one every @period queries on average), checked against Word
+template <typename T> void hinted_test(std::size_t words, std::size_t period)
+{
+    static std::mt19937_64 mte;
+
+    std::uint64_t *bitvector = new std::uint64_t[words];
+    for (std::size_t i = 0; i < words; i++)
+        bitvector[i] = mte() & mte();
+
+    hft::ranking::Word<hft::fenwick::FixedF> plain(bitvector, words);
+    // small samples, reach and regions, so that every path is taken
+    hft::ranking::Hinted<T> bv(bitvector, words, 64, 4, 8);
+
+    for (std::size_t i = 0; i < 50 * words; i++) {
+        const std::size_t pos = mte() % (64 * words);
+        if (mte() % period == 0) {
+            switch (mte() % 6) {
+            case 0: {
+                const std::size_t index = mte() % words;
+                const std::uint64_t word = mte() & mte();
+                EXPECT_EQ(plain.update(index, word), bv.update(index, word)) << "word: " << index;
+                break;
+            }
+            case 1:
+                EXPECT_EQ(plain.set(pos), bv.set(pos)) << "position: " << pos;
+                break;
+            case 2:
+                EXPECT_EQ(plain.clear(pos), bv.clear(pos)) << "position: " << pos;
+                break;
+            case 3:
+                EXPECT_EQ(plain.toggle(pos), bv.toggle(pos)) << "position: " << pos;
+                break;
+            case 4:
+                EXPECT_EQ(plain.rankAndSet(pos), bv.rankAndSet(pos)) << "position: " << pos;
+                break;
+            default: {
+                const std::uint64_t rank = mte() % (plain.rank(64 * words) + 2);
+                EXPECT_EQ(plain.selectAndClear(rank), bv.selectAndClear(rank)) << "rank: " << rank;
+            }
+            }
+        }
+
+        const std::uint64_t ones = plain.rank(64 * words), zeroes = 64 * words - ones;
+        const std::uint64_t rank = mte() % (ones + 2), rankzero = mte() % (zeroes + 2);
+        EXPECT_EQ(plain.select(rank), bv.select(rank)) << "rank: " << rank;
+        EXPECT_EQ(plain.selectZero(rankzero), bv.selectZero(rankzero)) << "rank: " << rankzero;
+        EXPECT_EQ(plain.rank(pos), bv.rank(pos)) << "position: " << pos;
+    }
+
+    for (std::size_t i = 0; i < words; i++)
+        EXPECT_EQ(plain.bitvector()[i], *bv.wordAt(i)) << "word: " << i;
+
+    delete[] bitvector;
+}
+
+TEST(hinted, rankselect)
+{
+    using namespace hft::fenwick;
+    using namespace hft::ranking;
+
+    for (std::size_t words : {1, 7, 8, 9, 1000, 5000}) {
+        for (std::size_t period : {1, 10, 1000}) {
+            hinted_test<Word<FixedF>>(words, period);
+            hinted_test<Word<BitL>>(words, period);
+            hinted_test<Stride<ByteF, 16>>(words, period);
+            hinted_test<Counted<BitF, 64>>(words, period);
+            hinted_test<Line<FixedF>>(words, period);
+        }
+        batch_test<Hinted<Word<ByteL>>>(words);
+        batch_test<Hinted<Counted<FixedF, 8>>>(words);
+    }
+}
+
+#endif // __TEST_HINTED_HPP__
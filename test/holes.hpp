@@ -0,0 +1,93 @@
+#ifndef __TEST_HOLES_HPP__
+#define __TEST_HOLES_HPP__
+
+#include "utils.hpp"
+#include <set>
+
+template <typename T> void holes_test(std::size_t size)
+{
+    using namespace hft::fenwick;
+    static std::mt19937_64 mte;
+
+    std::uint64_t *sequence = new std::uint64_t[size];
+    for (std::size_t i = 0; i < size; i++)
+        sequence[i] = mte() % 65;
+
+    HoledFixedF<64, Holes<0, 0>> plain(sequence, size);
+    T tree(sequence, size);
+
+    for (std::size_t i = 0; i < size; i += 3) {
+        const std::uint64_t inc = mte() % (65 - sequence[i]);
+        sequence[i] += inc;
+        plain.add(i + 1, inc);
+        tree.add(i + 1, inc);
+    }
+
+    for (std::size_t i = 0; i <= size; i++)
+        EXPECT_EQ(plain.prefix(i), tree.prefix(i)) << "index: " << i << ", size: " << size;
+    for (std::uint64_t val = 0; val <= plain.prefix(size); val += 1 + size / 100) {
+        EXPECT_EQ(plain.find(val), tree.find(val)) << "value: " << val << ", size: " << size;
+        EXPECT_EQ(plain.compFind(val), tree.compFind(val))
+            << "value: " << val << ", size: " << size;
+    }
+
+    // serialization keeps the layout
+    std::stringstream buffer;
+    buffer << tree;
+    T copy(nullptr, 0);
+    buffer >> copy;
+    EXPECT_EQ(size, copy.size());
+    for (std::size_t i = 0; i <= size; i += 7)
+        EXPECT_EQ(plain.prefix(i), copy.prefix(i)) << "index: " << i << ", size: " << size;
+
+    delete[] sequence;
+}
+
+TEST(holes, policies)
+{
+    using namespace hft::fenwick;
+
+    for (std::size_t size : {0, 1, 7, 1000, 5000, 70000}) {
+        holes_test<HoledFixedF<64, Holes<0, 0, true>>>(size);
+        holes_test<HoledFixedF<64, Holes<4, 64>>>(size);
+        holes_test<HoledFixedF<64, Holes<6, 100, true>>>(size);
+        holes_test<HoledFixedF<64, Holes<14, 64, true>>>(size);
+        holes_test<HoledByteF<64, Holes<0, 0>>>(size);
+        holes_test<HoledByteF<64, Holes<5, 24>>>(size);
+        holes_test<HoledByteF<64, Holes<9, 3>>>(size);
+        holes_test<HoledBitF<64, Holes<0, 0>>>(size);
+        holes_test<HoledBitF<64, Holes<3, 64>>>(size);
+        holes_test<HoledBitF<64, Holes<7, 1>>>(size);
+    }
+}
+
+TEST(holes, layout)
+{
+    using namespace hft::fenwick;
+
+    // the defaults: a word every 2^14 nodes in FixedF and BitF, no holes in small ByteF
+    EXPECT_EQ(((1 << 14) + 1) * 64, FixedF<64>::node(1 << 14, 1 << 14).Bit);
+    EXPECT_EQ((1 << 14) * 64, (HoledFixedF<64, Holes<0, 0>>::node(1 << 14, 1 << 14).Bit));
+    EXPECT_EQ(64, (BitF<64>::node(1 << 15, (1 << 14) + 1).Bit -
+                   HoledBitF<64, Holes<0, 0>>::node(1 << 15, (1 << 14) + 1).Bit));
+    EXPECT_EQ((HoledByteF<64, Holes<0, 0>>::node(1 << 20, 1 << 20).Bit),
+              ByteF<64>::node(1 << 20, 1 << 20).Bit);
+
+    // holes are rounded up to the unit of the layout
+    EXPECT_EQ((4 + 2) * 64, (HoledFixedF<64, Holes<2, 100>>::node(8, 4).Bit));
+    EXPECT_EQ(3 * 8, (HoledByteF<64, Holes<2, 20>>::node(8, 5).Bit -
+                      HoledByteF<64, Holes<0, 0>>::node(8, 5).Bit));
+
+    // the permutation moves whole lines within 4 KiB blocks, and scatters a power-of-two stride
+    using Xor = HoledFixedF<64, Holes<0, 0, true>>;
+    std::set<std::size_t> sets;
+    for (std::size_t idx = 512; idx <= 64 * 512; idx += 512) {
+        const std::size_t bit = Xor::node(64 * 512, idx).Bit;
+        EXPECT_EQ(idx / 512, bit / (4096 * 8)) << "index: " << idx;
+        EXPECT_EQ(idx % 8, bit / 64 % 8) << "index: " << idx;
+        sets.insert(bit / 512 % 64);
+    }
+    EXPECT_EQ(64, sets.size());
+}
+
+#endif // __TEST_HOLES_HPP__
@@ -0,0 +1,96 @@
+#ifndef __TEST_LINE_HPP__
+#define __TEST_LINE_HPP__
+
+#include "utils.hpp"
+
+// i-th word of the bitvector of @bv, wherever it is stored
+inline std::uint64_t bitvector_word(const hft::ranking::RankSelect &bv, std::size_t i)
+{
+    return *bv.wordAt(i);
+}
+
+// random updates and queries, checked against a Word<FixedF>
+template <typename T> void mutable_test(std::size_t words)
+{
+    static std::mt19937_64 mte;
+
+    std::uint64_t *bitvector = new std::uint64_t[words];
+    for (std::size_t i = 0; i < words; i++)
+        bitvector[i] = mte() & mte();
+
+    hft::ranking::Word<hft::fenwick::FixedF> plain(bitvector, words);
+    T bv(bitvector, words);
+    EXPECT_EQ(64 * words, bv.size());
+
+    for (std::size_t i = 0; i < 20 * words; i++) {
+        const std::size_t pos = mte() % (64 * words);
+        switch (mte() % 8) {
+        case 0: {
+            const std::size_t index = mte() % words;
+            const std::uint64_t word = mte() & mte();
+            EXPECT_EQ(plain.update(index, word), bv.update(index, word)) << "word: " << index;
+            break;
+        }
+        case 1:
+            EXPECT_EQ(plain.set(pos), bv.set(pos)) << "position: " << pos;
+            break;
+        case 2:
+            EXPECT_EQ(plain.clear(pos), bv.clear(pos)) << "position: " << pos;
+            break;
+        case 3:
+            EXPECT_EQ(plain.toggle(pos), bv.toggle(pos)) << "position: " << pos;
+            break;
+        case 4:
+            EXPECT_EQ(plain.rankAndSet(pos), bv.rankAndSet(pos)) << "position: " << pos;
+            break;
+        case 5: {
+            const std::uint64_t rank = mte() % (plain.rank(64 * words) + 2);
+            EXPECT_EQ(plain.selectAndClear(rank), bv.selectAndClear(rank)) << "rank: " << rank;
+            break;
+        }
+        default:
+            EXPECT_EQ(plain.rank(pos), bv.rank(pos)) << "position: " << pos;
+        }
+    }
+
+    const std::uint64_t ones = plain.rank(64 * words), zeroes = 64 * words - ones;
+    for (std::size_t pos = 0; pos <= 64 * words; pos += 1 + words / 10) {
+        EXPECT_EQ(plain.rank(pos), bv.rank(pos)) << "position: " << pos;
+        EXPECT_EQ(plain.rankZero(pos), bv.rankZero(pos)) << "position: " << pos;
+    }
+    for (std::uint64_t rank = 0; rank <= ones + 1; rank += 1 + words / 10)
+        EXPECT_EQ(plain.select(rank), bv.select(rank)) << "rank: " << rank;
+    for (std::uint64_t rank = 0; rank <= zeroes + 1; rank += 1 + words / 10)
+        EXPECT_EQ(plain.selectZero(rank), bv.selectZero(rank)) << "rank: " << rank;
+
+    for (std::size_t i = 0; i < words; i++)
+        EXPECT_EQ(plain.bitvector()[i], bitvector_word(bv, i)) << "word: " << i;
+
+    std::stringstream buffer;
+    buffer << bv;
+    T copy(nullptr, 0);
+    buffer >> copy;
+    EXPECT_EQ(bv.size(), copy.size());
+    for (std::size_t pos = 0; pos <= 64 * words; pos += 1 + words / 10)
+        EXPECT_EQ(plain.rank(pos), copy.rank(pos)) << "position: " << pos;
+
+    delete[] bitvector;
+}
+
+TEST(line, rankselect)
+{
+    using namespace hft::fenwick;
+    using namespace hft::ranking;
+
+    for (std::size_t words : {1, 6, 7, 8, 14, 1000, 20000}) {
+        mutable_test<Line<FixedF>>(words);
+        mutable_test<Line<FixedL>>(words);
+        mutable_test<Line<ByteF>>(words);
+        mutable_test<Line<ByteL>>(words);
+        mutable_test<Line<BitF>>(words);
+        mutable_test<Line<BitL>>(words);
+        batch_test<Line<BitF>>(words);
+    }
+}
+
+#endif // __TEST_LINE_HPP__
@@ -0,0 +1,113 @@
+#ifndef __TEST_MEMORYREPORT_HPP__
+#define __TEST_MEMORYREPORT_HPP__
+
+#include "utils.hpp"
+
+template <typename T>
+void memoryreport_test(std::size_t size, std::size_t width(std::size_t height))
+{
+    std::uint64_t *sequence = new std::uint64_t[size]();
+    T tree(sequence, size);
+    const hft::MemoryReport report = tree.memoryReport();
+
+    std::size_t payload = 0;
+    for (std::size_t i = 1; i <= size; i++)
+        payload += width(hft::rho(i));
+
+    EXPECT_EQ(payload, report.Payload) << "size: " << size << "\ntemplate argument: " << typeid(T).name();
+    EXPECT_EQ(tree.bitCount(), report.total()) << "size: " << size << "\ntemplate argument: " << typeid(T).name();
+    EXPECT_GE(report.Metadata, sizeof(T) * 8) << "size: " << size << "\ntemplate argument: " << typeid(T).name();
+    EXPECT_LE(report.Resident, report.Payload + report.Holes + report.Pages);
+
+    // every page the tree was built on is resident
+    EXPECT_GE(report.Resident, report.Payload) << "size: " << size << "\ntemplate argument: " << typeid(T).name();
+
+    delete[] sequence;
+}
+
+TEST(memoryreport, fenwick)
+{
+    using namespace hft::fenwick;
+    auto fixed = [](std::size_t) -> std::size_t { return 64; };
+    auto bit = [](std::size_t height) -> std::size_t { return 7 + height; };
+    auto byte = [](std::size_t height) -> std::size_t { return (((6 + height) >> 3) + 1) * 8; };
+    auto type = [](std::size_t height) -> std::size_t { return 7 + height <= 8 ? 8 : 7 + height <= 16 ? 16 : 64; };
+
+    for (std::size_t size : {0, 1, 2, 1000, 100000, 1000000}) {
+        memoryreport_test<FixedF<64>>(size, fixed);
+        memoryreport_test<FixedL<64>>(size, fixed);
+        memoryreport_test<ByteF<64>>(size, byte);
+        memoryreport_test<ByteL<64>>(size, byte);
+        memoryreport_test<BitF<64>>(size, bit);
+        memoryreport_test<BitL<64>>(size, bit);
+        memoryreport_test<TypeL<64>>(size, type);
+    }
+}
+
+TEST(memoryreport, holes)
+{
+    using namespace hft::fenwick;
+    constexpr std::size_t SIZE = 1000000;
+
+    std::uint64_t *sequence = new std::uint64_t[SIZE]();
+
+    // FixedF leaves a one word hole every 2^14 nodes
+    FixedF<64> fixed(sequence, SIZE);
+    EXPECT_EQ(fixed.memoryReport().Holes, ((SIZE >> 14) + 1) * 64);
+
+    // level-ordered trees have no holes at all
+    FixedL<64> fixedl(sequence, SIZE);
+    EXPECT_EQ(fixedl.memoryReport().Holes, 0);
+
+    // and page rounding never exceeds a page
+    for (const FenwickTree *tree : {(FenwickTree *)&fixed, (FenwickTree *)&fixedl})
+        EXPECT_LT(tree->memoryReport().Pages, hft::DArray<std::uint8_t>::PAGESIZE * 8);
+
+    delete[] sequence;
+}
+
+TEST(memoryreport, hybrid)
+{
+    using namespace hft::fenwick;
+    constexpr std::size_t SIZE = 100000;
+
+    std::uint64_t *sequence = new std::uint64_t[SIZE]();
+    Hybrid<ByteL, BitF, 64, 8> hybrid(sequence, SIZE);
+    const hft::MemoryReport report = hybrid.memoryReport();
+
+    EXPECT_EQ(hybrid.bitCount(), report.total());
+    // the bottom trees alone are made of (at least) SIZE nodes of at least 7 bits
+    EXPECT_GE(report.Payload, SIZE * 7);
+    EXPECT_GE(report.Metadata, sizeof(hybrid) * 8 + (SIZE >> 8) * sizeof(BitF<64>) * 8);
+
+    delete[] sequence;
+}
+
+TEST(memoryreport, rankselect)
+{
+    using namespace hft;
+    constexpr std::size_t SIZE = 10000;
+
+    std::uint64_t *bitvect = new std::uint64_t[SIZE];
+    std::fill_n(bitvect, SIZE, UINT64_MAX);
+
+    ranking::Word<fenwick::BitF> word(bitvect, SIZE);
+    ranking::Stride<fenwick::ByteL, 8> stride(bitvect, SIZE);
+
+    const MemoryReport wreport = word.memoryReport();
+    EXPECT_EQ(word.bitCount(), wreport.total());
+    EXPECT_GE(wreport.Payload, SIZE * 64 + SIZE * 7);
+
+    const MemoryReport sreport = stride.memoryReport();
+    EXPECT_EQ(stride.bitCount(), sreport.total());
+    EXPECT_GE(sreport.Payload, SIZE * 64 + SIZE / 8 * 10);
+
+    ranking::Replicated<ranking::Stride<fenwick::ByteL, 8>> replicated(bitvect, SIZE, 3);
+    const MemoryReport rreport = replicated.memoryReport();
+    EXPECT_EQ(replicated.bitCount(), rreport.total());
+    EXPECT_EQ(3 * sreport.Payload, rreport.Payload);
+
+    delete[] bitvect;
+}
+
+#endif // __TEST_MEMORYREPORT_HPP__
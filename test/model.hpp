@@ -0,0 +1,227 @@
+#ifndef __TEST_MODEL_HPP__
+#define __TEST_MODEL_HPP__
+
+#include "utils.hpp"
+
+// Exposes the array of a tree, to read the nodes where T::node() says they are
+template <typename T> struct Open : public T {
+    using T::T;
+    using T::Tree;
+
+    std::uint64_t read(hft::fenwick::Span span) const
+    {
+        const std::uint8_t *bytes = reinterpret_cast<const std::uint8_t *>(&Tree[0]);
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < span.Bits; i++)
+            value |= std::uint64_t(bytes[(span.Bit + i) / 8] >> ((span.Bit + i) % 8) & 1) << i;
+        return value;
+    }
+};
+
+template <typename T> void layout_test(std::uint64_t sequence[], std::size_t size)
+{
+    using namespace hft;
+    Open<T> tree(sequence, size);
+
+    std::uint64_t *prefix = new std::uint64_t[size + 1];
+    prefix[0] = 0;
+    for (std::size_t i = 1; i <= size; i++)
+        prefix[i] = prefix[i - 1] + sequence[i - 1];
+
+    // every node holds the sum of its range, and no two nodes overlap
+    std::vector<fenwick::Span> spans;
+    for (std::size_t idx = 1; idx <= size; idx++) {
+        const fenwick::Span span = T::node(size, idx);
+        ASSERT_EQ(prefix[idx] - prefix[clear_rho(idx)], tree.read(span)) << "index: " << idx;
+        spans.push_back(span);
+    }
+
+    std::sort(spans.begin(), spans.end(), [](fenwick::Span a, fenwick::Span b) { return a.Bit < b.Bit; });
+    for (std::size_t i = 1; i < spans.size(); i++)
+        EXPECT_LE(spans[i - 1].Bit + spans[i - 1].Bits, spans[i].Bit) << "span: " << i;
+
+    // prefix() and add() visit the nodes of model::path()
+    for (std::size_t idx = 1; idx <= size; idx += 13) {
+        std::uint64_t sum = 0;
+        for (std::size_t node : model::path(size, trace::PREFIX, idx))
+            sum += tree.read(T::node(size, node));
+        EXPECT_EQ(prefix[idx], sum) << "index: " << idx;
+
+        std::vector<std::size_t> nodes = model::path(size, trace::ADD, idx);
+        ASSERT_FALSE(nodes.empty());
+        EXPECT_EQ(idx, nodes.front());
+        EXPECT_LE(nodes.back(), size);
+        EXPECT_GT(nodes.back() + mask_rho(nodes.back()), size);
+    }
+
+    // a find() descending through the spans visits the nodes of model::path() of its result
+    for (std::uint64_t val = 0; val <= prefix[size]; val += 1 + prefix[size] / 500) {
+        std::uint64_t rest = val;
+        std::size_t node = 0;
+        std::vector<std::size_t> visited;
+        for (std::size_t m = mask_lambda(size); m != 0; m >>= 1) {
+            if (node + m > size)
+                continue;
+
+            visited.push_back(node + m);
+            const std::uint64_t value = tree.read(T::node(size, node + m));
+            if (rest >= value) {
+                node += m;
+                rest -= value;
+            }
+        }
+
+        EXPECT_EQ(tree.find(val), node) << "value: " << val;
+        EXPECT_EQ(model::path(size, trace::FIND, node), visited) << "value: " << val;
+    }
+
+    delete[] prefix;
+}
+
+TEST(model, layout)
+{
+    using namespace hft::fenwick;
+    static std::mt19937_64 mte;
+
+    // FixedF and BitF have a hole every 2^14 nodes
+    for (std::size_t size : {1, 2, 3, 5, 64, 1000, 1 << 14, (1 << 15) + 1000}) {
+        std::uint64_t *sequence = new std::uint64_t[size];
+        for (std::size_t i = 0; i < size; i++)
+            sequence[i] = mte() % 65;
+
+        layout_test<FixedF<64>>(sequence, size);
+        layout_test<FixedL<64>>(sequence, size);
+        layout_test<ByteF<64>>(sequence, size);
+        layout_test<ByteL<64>>(sequence, size);
+        layout_test<BitF<64>>(sequence, size);
+        layout_test<BitL<64>>(sequence, size);
+
+        for (std::size_t i = 0; i < size; i++)
+            sequence[i] = mte() % 1000001;
+
+        layout_test<ByteF<1000000>>(sequence, size);
+        layout_test<ByteL<1000000>>(sequence, size);
+        layout_test<BitF<1000000>>(sequence, size);
+        layout_test<BitL<1000000>>(sequence, size);
+
+        layout_test<HoledFixedF<1000000, Holes<5, 64, true>>>(sequence, size);
+        layout_test<HoledByteF<1000000, Holes<4, 8>>>(sequence, size);
+        layout_test<HoledBitF<1000000, Holes<6, 64>>>(sequence, size);
+
+        delete[] sequence;
+    }
+
+    static_assert(hft::model::modelled<FixedF<64>> && hft::model::modelled<BitL<64>>);
+    static_assert(!hft::model::modelled<Hybrid<FixedL, BitF, 64, 8>>);
+    static_assert(!hft::model::modelled<TypeF<64>>);
+}
+
+TEST(model, predict)
+{
+    using namespace hft;
+    using namespace hft::fenwick;
+    constexpr std::size_t SIZE = 1000;
+
+    // every prefix is computed: the nodes are exact
+    double nodes = 0;
+    for (std::size_t i = 1; i <= SIZE; i++)
+        nodes += popcount(i);
+
+    model::Hierarchy hw;
+    hw.Line = 64;
+    hw.Page = 4096;
+    hw.Cache[0] = 32 << 10;
+    hw.Cache[1] = 1 << 20;
+    hw.Cache[2] = 8 << 20;
+    hw.Tlb = 64;
+
+    // a small tree lives in the L1 and in a couple of pages
+    const model::Cost small = model::predict<FixedF<64>>(SIZE, trace::PREFIX, hw);
+    EXPECT_DOUBLE_EQ(nodes / SIZE, small.Nodes);
+    EXPECT_LE(small.Lines, small.Nodes);
+    EXPECT_GE(small.Lines, 1);
+    EXPECT_EQ(0, small.L1);
+    EXPECT_EQ(0, small.Tlb);
+
+    // with no cache at all every line misses
+    model::Hierarchy none = hw;
+    none.Cache[0] = none.Cache[1] = none.Cache[2] = 0;
+    none.Tlb = 0;
+    const model::Cost cold = model::predict<BitL<64>>(SIZE, trace::ADD, none);
+    EXPECT_DOUBLE_EQ(cold.Lines, cold.L1);
+    EXPECT_DOUBLE_EQ(cold.Lines, cold.L3);
+    EXPECT_DOUBLE_EQ(cold.Pages, cold.Tlb);
+
+    // larger caches miss less, and compression reduces the misses
+    constexpr std::size_t LARGE = 1 << 24;
+    const model::Cost fixed = model::predict<FixedF<64>>(LARGE, trace::FIND, hw, 1 << 12);
+    const model::Cost bit = model::predict<BitF<64>>(LARGE, trace::FIND, hw, 1 << 12);
+    EXPECT_DOUBLE_EQ(25, fixed.Nodes);
+    EXPECT_GE(fixed.L1, fixed.L2);
+    EXPECT_GE(fixed.L2, fixed.L3);
+    EXPECT_GT(fixed.L3, 0);
+    EXPECT_LE(bit.L1, fixed.L1);
+    EXPECT_LT(bit.L3, fixed.L3);
+    EXPECT_LE(bit.Tlb, fixed.Tlb);
+}
+
+// Build with PARAMS=-DHFT_INSTRUMENT to compare the predictions with the instrumented counters
+#ifdef HFT_INSTRUMENT
+
+template <typename T> void lines_test(std::uint64_t sequence[], std::size_t size)
+{
+    using namespace hft;
+    static std::mt19937_64 mte;
+    T tree(sequence, size);
+
+    std::vector<std::size_t> indices, results;
+    std::vector<std::uint64_t> values;
+    for (std::size_t i = 0; i < 1000; i++) {
+        indices.push_back(1 + mte() % size);
+        values.push_back(mte() % (tree.prefix(size) + 1));
+        results.push_back(tree.find(values.back()));
+    }
+
+    tree.resetStats();
+    for (std::size_t i = 0; i < 1000; i++) {
+        tree.prefix(indices[i]);
+        tree.find(values[i]);
+    }
+
+    model::Hierarchy hw;
+    hw.Line = 64;
+    const Stats stats = tree.stats();
+    const model::Cost prefix =
+        model::predict<T>(size, trace::PREFIX, indices.data(), indices.size(), hw);
+    const model::Cost find =
+        model::predict<T>(size, trace::FIND, results.data(), results.size(), hw);
+
+    EXPECT_DOUBLE_EQ(stats.Find.Nodes / 1000., find.Nodes);
+    EXPECT_DOUBLE_EQ(stats.Find.Lines / 1000., find.Lines);
+    EXPECT_DOUBLE_EQ(stats.Prefix.Nodes / 1000., prefix.Nodes);
+    EXPECT_DOUBLE_EQ(stats.Prefix.Lines / 1000., prefix.Lines);
+}
+
+TEST(model, instrumented)
+{
+    using namespace hft::fenwick;
+    constexpr std::size_t SIZE = 100000;
+    static std::mt19937_64 mte;
+
+    std::uint64_t *sequence = new std::uint64_t[SIZE];
+    for (std::size_t i = 0; i < SIZE; i++)
+        sequence[i] = mte() % 65;
+
+    // BitL records the bytes of its nodes, not the 64-bit loads
+    lines_test<FixedF<64>>(sequence, SIZE);
+    lines_test<FixedL<64>>(sequence, SIZE);
+    lines_test<ByteF<64>>(sequence, SIZE);
+    lines_test<ByteL<64>>(sequence, SIZE);
+    lines_test<BitF<64>>(sequence, SIZE);
+
+    delete[] sequence;
+}
+
+#endif // HFT_INSTRUMENT
+
+#endif // __TEST_MODEL_HPP__
@@ -0,0 +1,128 @@
+#ifndef __TEST_POPCOUNT_HPP__
+#define __TEST_POPCOUNT_HPP__
+
+#include "utils.hpp"
+
+TEST(popcount, select64)
+{
+    using namespace hft;
+    static std::mt19937_64 mte;
+
+    const cpu::Features host = cpu::Features::host();
+    if (!host.Bmi2)
+        std::cerr << "[ WARNING  ] BMI2 is not supported: PDEP not tested\n";
+
+    for (std::size_t i = 0; i < 10000; i++) {
+        const std::uint64_t word = mte() & (i % 3 ? mte() : ~std::uint64_t(0));
+        EXPECT_EQ(popcount(word), __builtin_popcountll(word));
+        if (word == 0)
+            continue;
+
+        const std::uint64_t rank = mte() % popcount(word);
+        const std::uint64_t bit = select64_broadword(word, rank);
+        EXPECT_EQ(1, (word >> bit) & 1);
+        EXPECT_EQ(rank, popcount(word & ((1ULL << bit) - 1)));
+
+        EXPECT_EQ(bit, select64(word, rank));
+#ifdef __x86_64__
+        if (host.Bmi2) {
+            EXPECT_EQ(bit, select64_pdep(word, rank));
+        }
+#endif
+    }
+}
+
+TEST(popcount, kernels)
+{
+    using namespace hft;
+    static std::mt19937_64 mte;
+
+    const cpu::Features host = cpu::Features::host();
+    if (!host.Avx2 || !host.Avx512Popcnt)
+        std::cerr << "[ WARNING  ] some vector kernels are not supported: not tested\n";
+
+    std::vector<std::uint64_t> words(200);
+    for (std::uint64_t &word : words)
+        word = mte() & mte();
+    words[5] = 0;
+    words[6] = UINT64_MAX;
+
+    for (std::uint64_t flip : {std::uint64_t(0), ~std::uint64_t(0)}) {
+        for (std::size_t count = 0; count <= words.size(); count++) {
+            const std::uint64_t ones = simd::popcount_scalar(words.data(), count, flip);
+            EXPECT_EQ(ones, popcount(words.data(), count, flip)) << "count: " << count;
+#ifdef HFT_X86
+            if (host.Avx2) {
+                EXPECT_EQ(ones, simd::popcount_avx2(words.data(), count, flip))
+                    << "count: " << count;
+            }
+            if (host.Avx512Popcnt) {
+                EXPECT_EQ(ones, simd::popcount_avx512(words.data(), count, flip))
+                    << "count: " << count;
+            }
+#endif
+
+            for (std::uint64_t rank = 0; rank <= ones; rank += 1 + ones / 50) {
+                std::uint64_t expected = rank, dispatched = rank;
+                const std::size_t idx =
+                    simd::select_word_scalar(words.data(), count, &expected, flip);
+                EXPECT_EQ(rank < ones ? idx : count, idx)
+                    << "count: " << count << ", rank: " << rank;
+                EXPECT_EQ(idx, select_word(words.data(), count, &dispatched, flip));
+                EXPECT_EQ(expected, dispatched);
+
+#ifdef HFT_X86
+                if (host.Avx2) {
+                    std::uint64_t avx2 = rank;
+                    EXPECT_EQ(idx, simd::select_word_avx2(words.data(), count, &avx2, flip))
+                        << "count: " << count << ", rank: " << rank;
+                    EXPECT_EQ(expected, avx2) << "count: " << count << ", rank: " << rank;
+                }
+                if (host.Avx512Popcnt) {
+                    std::uint64_t avx512 = rank;
+                    EXPECT_EQ(idx, simd::select_word_avx512(words.data(), count, &avx512, flip))
+                        << "count: " << count << ", rank: " << rank;
+                    EXPECT_EQ(expected, avx512) << "count: " << count << ", rank: " << rank;
+                }
+#endif
+            }
+        }
+    }
+}
+
+template <typename T> void popcount_stride_test(std::size_t words)
+{
+    static std::mt19937_64 mte;
+
+    std::uint64_t *bitvector = new std::uint64_t[words];
+    for (std::size_t i = 0; i < words; i++)
+        bitvector[i] = mte() & mte() & mte();
+
+    hft::ranking::Word<hft::fenwick::FixedF> plain(bitvector, words);
+    T bv(bitvector, words);
+
+    const std::uint64_t ones = plain.rank(64 * words - 1);
+    for (std::size_t pos = 0; pos < 64 * words; pos += 1 + mte() % 97)
+        EXPECT_EQ(plain.rank(pos), bv.rank(pos)) << "position: " << pos;
+    for (std::uint64_t rank = 0; rank <= ones + 1; rank += 1 + mte() % 31)
+        EXPECT_EQ(plain.select(rank), bv.select(rank)) << "rank: " << rank;
+    for (std::uint64_t rank = 0; rank <= 64 * words - ones + 1; rank += 1 + mte() % 97)
+        EXPECT_EQ(plain.selectZero(rank), bv.selectZero(rank)) << "rank: " << rank;
+
+    delete[] bitvector;
+}
+
+TEST(popcount, strides)
+{
+    using namespace hft::fenwick;
+    using namespace hft::ranking;
+
+    for (std::size_t words : {1, 5, 63, 64, 65, 1000}) {
+        popcount_stride_test<Stride<FixedF, 5>>(words);
+        popcount_stride_test<Stride<ByteL, 16>>(words);
+        popcount_stride_test<Stride<BitF, 32>>(words);
+        popcount_stride_test<Stride<FixedL, 64>>(words);
+    }
+}
+
+#endif // __TEST_POPCOUNT_HPP__
@@ -0,0 +1,300 @@
+#ifndef __TEST_REPLICATED_HPP__
+#define __TEST_REPLICATED_HPP__
+
+#include "utils.hpp"
+#include <sstream>
+#include <thread>
+
+template <typename T>
+void replicated_random_test(std::size_t size, std::size_t replicas)
+{
+    static std::mt19937 mte;
+    std::uniform_int_distribution<std::uint64_t> dist(0, 16);
+
+    std::uint64_t *increments = new std::uint64_t[size];
+    for (std::size_t i = 0; i < size; i++)
+        increments[i] = dist(mte);
+
+    hft::fenwick::FixedF<64> naive(increments, size);
+    hft::fenwick::Replicated<T> replicated(increments, size, replicas);
+    EXPECT_EQ(replicas, replicated.replicas());
+
+    // add, interleaved with queries (enough to overflow the log a few times)
+    std::uniform_int_distribution<std::size_t> idxdist(1, size);
+    for (std::size_t i = 0; i < 3 * 4096; i++) {
+        const std::size_t idx = idxdist(mte);
+        naive.add(idx, 1);
+        replicated.add(idx, 1);
+
+        if (i % 97 == 0) {
+            EXPECT_EQ(naive.prefix(idx), replicated.prefix(idx)) << "At index: " << idx;
+        }
+    }
+
+    for (size_t i = 1; i <= size; i++)
+        EXPECT_EQ(naive.prefix(i), replicated.prefix(i)) << "At index: " << i;
+
+    for (std::uint64_t i = 0; i < size; i++) {
+        EXPECT_EQ(naive.find(i), replicated.find(i)) << "At index: " << i;
+        EXPECT_EQ(naive.compFind(i), replicated.compFind(i)) << "At index: " << i;
+    }
+
+    // every replica is identical once flushed
+    for (std::size_t r = 0; r < replicas; r++)
+        for (size_t i = 1; i <= size; i++)
+            EXPECT_EQ(naive.prefix(i), replicated.replica(r).prefix(i)) << "Replica: " << r;
+
+    // serialization
+    std::stringstream buffer;
+    buffer << replicated;
+    hft::fenwick::Replicated<T> copy(nullptr, 0, replicas);
+    buffer >> copy;
+    EXPECT_EQ(size, copy.size());
+    for (size_t i = 1; i <= size; i++)
+        EXPECT_EQ(naive.prefix(i), copy.prefix(i)) << "At index: " << i;
+
+    delete[] increments;
+}
+
+TEST(replicated, fenwick)
+{
+    using namespace hft::fenwick;
+
+    for (std::size_t replicas = 1; replicas <= 4; replicas++) {
+        replicated_random_test<FixedF<64>>(1000, replicas);
+        replicated_random_test<ByteL<64>>(1000, replicas);
+        replicated_random_test<Hybrid<ByteL, BitF, 64, 8>>(100000, replicas);
+    }
+}
+
+TEST(replicated, concurrent)
+{
+    using namespace hft::fenwick;
+    constexpr std::size_t SIZE = 10000, THREADS = 4, ADDS = 20000;
+
+    std::uint64_t *sequence = new std::uint64_t[SIZE]();
+    Replicated<Hybrid<ByteL, BitF, 64, 8>> replicated(sequence, SIZE, 3);
+
+    std::vector<std::thread> pool;
+    for (std::size_t t = 0; t < THREADS; t++) {
+        pool.emplace_back([&replicated, t] {
+            std::mt19937 mte(t);
+            std::uniform_int_distribution<std::size_t> idxdist(1, SIZE);
+            for (std::size_t i = 0; i < ADDS; i++) {
+                replicated.add(idxdist(mte), 1);
+                replicated.prefix(idxdist(mte));
+            }
+        });
+    }
+
+    for (auto &worker : pool)
+        worker.join();
+
+    FixedF<64> naive(sequence, SIZE);
+    for (std::size_t t = 0; t < THREADS; t++) {
+        std::mt19937 mte(t);
+        std::uniform_int_distribution<std::size_t> idxdist(1, SIZE);
+        for (std::size_t i = 0; i < ADDS; i++) {
+            naive.add(idxdist(mte), 1);
+            idxdist(mte);
+        }
+    }
+
+    for (std::size_t r = 0; r < replicated.replicas(); r++)
+        for (std::size_t i = 1; i <= SIZE; i++)
+            EXPECT_EQ(naive.prefix(i), replicated.replica(r).prefix(i)) << "Replica: " << r;
+
+    delete[] sequence;
+}
+
+TEST(replicated, rankselect)
+{
+    using namespace hft;
+    constexpr std::size_t SIZE = 2000;
+    static std::mt19937 mte;
+
+    std::uint64_t *bitvect = new std::uint64_t[SIZE];
+    for (std::size_t i = 0; i < SIZE; i++)
+        bitvect[i] = mte();
+
+    ranking::Stride<fenwick::ByteL, 8> naive(bitvect, SIZE);
+    ranking::Replicated<ranking::Stride<fenwick::ByteL, 8>> replicated(bitvect, SIZE, 3);
+
+    std::uniform_int_distribution<std::size_t> posdist(0, SIZE * 64 - 1);
+    for (std::size_t i = 0; i < 10000; i++) {
+        const std::size_t pos = posdist(mte);
+        switch (i % 8) {
+        case 0:
+            EXPECT_EQ(naive.set(pos), replicated.set(pos));
+            break;
+        case 1:
+            EXPECT_EQ(naive.clear(pos), replicated.clear(pos));
+            break;
+        case 2:
+            EXPECT_EQ(naive.toggle(pos), replicated.toggle(pos));
+            break;
+        case 3:
+            EXPECT_EQ(naive.rankAndSet(pos), replicated.rankAndSet(pos)) << "At index: " << pos;
+            break;
+        case 4:
+            EXPECT_EQ(naive.rankZeroAndSet(pos), replicated.rankZeroAndSet(pos))
+                << "At index: " << pos;
+            break;
+        case 5: {
+            const std::uint64_t rank = mte() % (naive.rank(SIZE * 64) + 1);
+            EXPECT_EQ(naive.selectAndClear(rank), replicated.selectAndClear(rank))
+                << "At rank: " << rank;
+            break;
+        }
+        case 6: {
+            const std::size_t to = std::min(pos + mte() % 300, SIZE * 64);
+            if (i % 16 == 6) {
+                naive.fillRange(pos, to);
+                replicated.fillRange(pos, to);
+            } else {
+                naive.clearRange(pos, to);
+                replicated.clearRange(pos, to);
+            }
+            break;
+        }
+        default: {
+            const std::uint64_t word = mte();
+            EXPECT_EQ(naive.update(pos / 64, word), replicated.update(pos / 64, word))
+                << "At word: " << pos / 64;
+        }
+        }
+    }
+
+    std::vector<std::uint64_t> words(SIZE);
+    for (std::uint64_t &word : words)
+        word = mte();
+    naive.updateRange(SIZE / 3, words.data(), SIZE / 2);
+    replicated.updateRange(SIZE / 3, words.data(), SIZE / 2);
+
+    // the operand is copied, so changing it afterwards doesn't matter
+    ranking::Word<fenwick::FixedF> other(words.data(), SIZE);
+    naive.combine(other, ranking::XOR);
+    replicated.combine(other, ranking::XOR);
+    other.update(0, ~other.bitvector()[0]);
+
+    for (std::size_t i = 0; i <= SIZE * 64; i += 7) {
+        EXPECT_EQ(naive.rank(i), replicated.rank(i)) << "At index: " << i;
+        EXPECT_EQ(naive.rankZero(i), replicated.rankZero(i)) << "At index: " << i;
+    }
+
+    for (std::size_t i = 0; i < naive.rank(SIZE * 64); i += 5)
+        EXPECT_EQ(naive.select(i), replicated.select(i)) << "At rank: " << i;
+
+    for (std::size_t i = 0; i < naive.rankZero(SIZE * 64); i += 5)
+        EXPECT_EQ(naive.selectZero(i), replicated.selectZero(i)) << "At rank: " << i;
+
+    for (std::size_t r = 0; r < replicated.replicas(); r++)
+        for (std::size_t i = 0; i < SIZE; i++)
+            EXPECT_EQ(naive.bitvector()[i], replicated.replica(r).bitvector()[i]) << "Replica: " << r;
+
+    delete[] bitvect;
+}
+
+TEST(replicated, concurrent_rankselect)
+{
+    using namespace hft;
+    constexpr std::size_t SIZE = 2000, THREADS = 4, OPS = 20000;
+    static std::mt19937 mte;
+
+    std::uint64_t *bitvect = new std::uint64_t[SIZE];
+    for (std::size_t i = 0; i < SIZE; i++)
+        bitvect[i] = mte();
+
+    ranking::Replicated<ranking::Stride<fenwick::ByteL, 8>> replicated(bitvect, SIZE, 3);
+
+    // every thread owns the bits congruent to it, so that a serial replay of its own updates
+    // predicts their results whatever the interleaving (and whoever replays them first)
+    std::atomic<std::size_t> wrong{0};
+    std::vector<std::vector<bool>> owned(THREADS);
+    std::vector<std::thread> pool;
+    for (std::size_t t = 0; t < THREADS; t++) {
+        pool.emplace_back([&, t] {
+            std::mt19937 mte(t);
+            std::uniform_int_distribution<std::size_t> posdist(0, SIZE * 64 / THREADS - 1);
+            std::vector<bool> bits(SIZE * 64 / THREADS);
+            for (std::size_t i = 0; i < bits.size(); i++)
+                bits[i] = bitvect[(i * THREADS + t) / 64] >> ((i * THREADS + t) % 64) & 1;
+
+            for (std::size_t i = 0; i < OPS; i++) {
+                const std::size_t idx = posdist(mte), pos = idx * THREADS + t;
+                bool result;
+                switch (i % 3) {
+                case 0:
+                    result = replicated.set(pos);
+                    break;
+                case 1:
+                    result = replicated.clear(pos);
+                    break;
+                default:
+                    result = replicated.toggle(pos);
+                }
+
+                if (result != bits[idx])
+                    wrong++;
+                bits[idx] = i % 3 == 0 ? true : i % 3 == 1 ? false : !bits[idx];
+
+                replicated.rank(posdist(mte) * THREADS);
+            }
+
+            owned[t] = std::move(bits);
+        });
+    }
+
+    for (auto &worker : pool)
+        worker.join();
+
+    EXPECT_EQ(0, wrong.load());
+    for (std::size_t r = 0; r < replicated.replicas(); r++) {
+        const std::uint64_t *words = replicated.replica(r).bitvector();
+        for (std::size_t pos = 0; pos < SIZE * 64; pos++)
+            ASSERT_EQ(owned[pos % THREADS][pos / THREADS], words[pos / 64] >> (pos % 64) & 1)
+                << "Replica: " << r << ", position: " << pos;
+    }
+
+    delete[] bitvect;
+}
+
+TEST(replicated, concurrent_select_and_clear)
+{
+    using namespace hft;
+    constexpr std::size_t SIZE = 4000, THREADS = 4;
+
+    std::uint64_t *bitvect = new std::uint64_t[SIZE];
+    for (std::size_t i = 0; i < SIZE; i++)
+        bitvect[i] = UINT64_MAX;
+
+    ranking::Replicated<ranking::Stride<fenwick::ByteL, 8>> replicated(bitvect, SIZE, 3);
+
+    // every thread takes the first 1-bit until none is left: no bit can be taken twice
+    std::vector<std::vector<std::size_t>> taken(THREADS);
+    std::vector<std::thread> pool;
+    for (std::size_t t = 0; t < THREADS; t++) {
+        pool.emplace_back([&, t] {
+            for (std::size_t pos; (pos = replicated.selectAndClear(0)) != SIZE_MAX;)
+                taken[t].push_back(pos);
+        });
+    }
+
+    for (auto &worker : pool)
+        worker.join();
+
+    std::vector<std::size_t> count(SIZE * 64);
+    for (const auto &positions : taken)
+        for (std::size_t pos : positions)
+            count[pos]++;
+
+    for (std::size_t pos = 0; pos < SIZE * 64; pos++)
+        ASSERT_EQ(1, count[pos]) << "position: " << pos;
+
+    for (std::size_t r = 0; r < replicated.replicas(); r++)
+        EXPECT_EQ(0, replicated.replica(r).rank(SIZE * 64)) << "Replica: " << r;
+
+    delete[] bitvect;
+}
+
+#endif // __TEST_REPLICATED_HPP__
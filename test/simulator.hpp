@@ -0,0 +1,161 @@
+#ifndef __TEST_SIMULATOR_HPP__
+#define __TEST_SIMULATOR_HPP__
+
+#include "utils.hpp"
+
+TEST(simulator, cache)
+{
+    using namespace hft::model;
+
+    // direct-mapped, 4 sets: blocks 0 and 4 fight for a set, a fully-associative cache keeps both
+    Cache direct(4 * 64, 1, 64);
+    for (int i = 0; i < 10; i++) {
+        direct.access(0);
+        direct.access(4);
+    }
+    EXPECT_EQ(20, direct.misses().Accesses);
+    EXPECT_EQ(20, direct.misses().Misses);
+    EXPECT_EQ(2, direct.misses().Compulsory);
+    EXPECT_EQ(18, direct.misses().Conflict);
+    EXPECT_EQ(0, direct.misses().Capacity);
+
+    // fully-associative, 4 blocks: LRU thrashes on a cycle of 5
+    Cache full(4 * 64, 4, 64);
+    for (int i = 0; i < 10; i++)
+        for (std::uint64_t b = 0; b < 5; b++)
+            full.access(b);
+    EXPECT_EQ(50, full.misses().Misses);
+    EXPECT_EQ(5, full.misses().Compulsory);
+    EXPECT_EQ(45, full.misses().Capacity);
+    EXPECT_EQ(0, full.misses().Conflict);
+
+    // a cycle of 4 fits: only the first round misses
+    full.reset();
+    for (int i = 0; i < 10; i++)
+        for (std::uint64_t b = 10; b < 14; b++)
+            EXPECT_EQ(i > 0, full.access(b));
+    EXPECT_EQ(4, full.misses().Misses);
+    EXPECT_DOUBLE_EQ(0.1, full.misses().rate());
+
+    // no room at all
+    Cache none(0, 8, 64);
+    EXPECT_FALSE(none.access(1));
+    EXPECT_FALSE(none.access(1));
+    EXPECT_EQ(1, none.misses().Capacity);
+}
+
+TEST(simulator, replay)
+{
+    using namespace hft;
+    using namespace hft::fenwick;
+    constexpr std::size_t SIZE = 1 << 20, OPS = 20000;
+    static std::mt19937_64 mte;
+
+    std::vector<std::size_t> args(OPS);
+    for (std::size_t &arg : args)
+        arg = 1 + mte() % SIZE;
+
+    model::Hierarchy hw;
+    hw.Line = 64;
+    hw.Page = 4096;
+    hw.Cache[0] = 32 << 10;
+    hw.Cache[1] = 1 << 20;
+    hw.Cache[2] = 8 << 20;
+    hw.Ways[0] = 8;
+    hw.Ways[1] = hw.Ways[2] = 16;
+    hw.Tlb = 64;
+    hw.TlbWays = 4;
+
+    // every node of FixedF is a line, and every level sees the misses of the previous one
+    model::Simulator fixedf(hw);
+    model::replay<FixedF<64>>(fixedf, SIZE, trace::PREFIX, args.data(), OPS);
+    const model::Cost cost =
+        model::predict<FixedF<64>>(SIZE, trace::PREFIX, args.data(), OPS, hw);
+    EXPECT_DOUBLE_EQ(cost.Nodes * OPS, fixedf.level(0).Accesses);
+    EXPECT_EQ(fixedf.level(0).Misses, fixedf.level(1).Accesses);
+    EXPECT_EQ(fixedf.level(1).Misses, fixedf.level(2).Accesses);
+    EXPECT_GT(fixedf.level(0).Misses, fixedf.level(1).Misses);
+    for (std::size_t l = 0; l < 3; l++) {
+        const model::Misses &m = fixedf.level(l);
+        EXPECT_EQ(m.Misses, m.Compulsory + m.Capacity + m.Conflict) << "level: " << l;
+    }
+
+    // the whole tree fits in the L3: after a warm-up only the L1 and the L2 miss
+    fixedf.reset();
+    model::replay<FixedF<64>>(fixedf, SIZE, trace::PREFIX, args.data(), OPS);
+    EXPECT_EQ(0, fixedf.level(2).Misses);
+    EXPECT_GT(fixedf.level(1).Misses, 0);
+
+    // compression fits more of the tree in each level
+    model::Simulator bitf(hw);
+    model::replay<BitF<64>>(bitf, SIZE, trace::PREFIX, args.data(), OPS);
+    bitf.reset();
+    model::replay<BitF<64>>(bitf, SIZE, trace::PREFIX, args.data(), OPS);
+    EXPECT_LT(bitf.level(0).Misses, fixedf.level(0).Misses);
+    EXPECT_LT(bitf.level(1).Misses, fixedf.level(1).Misses);
+    EXPECT_LE(bitf.tlb().Misses, fixedf.tlb().Misses);
+}
+
+// Build with PARAMS=-DHFT_INSTRUMENT to feed the simulator with the nodes of actual trees
+#ifdef HFT_INSTRUMENT
+
+TEST(simulator, watch)
+{
+    using namespace hft;
+    using namespace hft::fenwick;
+    constexpr std::size_t SIZE = 100000, OPS = 10000;
+    static std::mt19937_64 mte;
+
+    std::uint64_t *sequence = new std::uint64_t[SIZE];
+    for (std::size_t i = 0; i < SIZE; i++)
+        sequence[i] = mte() % 65;
+
+    std::vector<std::size_t> args(OPS);
+    for (std::size_t &arg : args)
+        arg = 1 + mte() % SIZE;
+
+    // sets span no more than a page: the base address of the tree doesn't change the mapping
+    model::Hierarchy hw;
+    hw.Line = 64;
+    hw.Page = 4096;
+    hw.Cache[0] = 2 << 10;
+    hw.Cache[1] = 8 << 10;
+    hw.Cache[2] = 32 << 10;
+    hw.Ways[0] = 1;
+    hw.Ways[1] = 2;
+    hw.Ways[2] = 8;
+    hw.Tlb = hw.TlbWays = 16;
+
+    ByteF<64> bytef(sequence, SIZE);
+    model::Simulator online(hw), offline(hw);
+    {
+        model::Watch watch(online);
+        for (std::size_t arg : args)
+            bytef.add(arg, 0);
+    }
+    model::replay<ByteF<64>>(offline, SIZE, trace::ADD, args.data(), OPS);
+
+    for (std::size_t l = 0; l < 3; l++) {
+        EXPECT_EQ(offline.level(l).Accesses, online.level(l).Accesses) << "level: " << l;
+        EXPECT_EQ(offline.level(l).Misses, online.level(l).Misses) << "level: " << l;
+        EXPECT_EQ(offline.level(l).Conflict, online.level(l).Conflict) << "level: " << l;
+    }
+    EXPECT_EQ(offline.tlb().Misses, online.tlb().Misses);
+
+    // trees that are not modelled can be watched too
+    Hybrid<FixedL, BitF, 64, 8> hybrid(sequence, SIZE);
+    model::Simulator any(hw);
+    {
+        model::Watch watch(any);
+        for (std::size_t arg : args)
+            hybrid.prefix(arg);
+    }
+    EXPECT_GE(any.level(0).Accesses, OPS);
+    EXPECT_EQ(any.level(0).Misses, any.level(1).Accesses);
+
+    delete[] sequence;
+}
+
+#endif // HFT_INSTRUMENT
+
+#endif // __TEST_SIMULATOR_HPP__
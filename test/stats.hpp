@@ -0,0 +1,211 @@
+#ifndef __TEST_STATS_HPP__
+#define __TEST_STATS_HPP__
+
+#include "utils.hpp"
+
+// Build with PARAMS=-DHFT_INSTRUMENT to run the instrumented tests
+#ifdef HFT_INSTRUMENT
+
+TEST(stats, nodes)
+{
+    using namespace hft::fenwick;
+    constexpr std::size_t SIZE = 1 << 16;
+
+    std::uint64_t *sequence = new std::uint64_t[SIZE]();
+    FixedF<64> fixedf(sequence, SIZE);
+    FixedL<64> fixedl(sequence, SIZE);
+    ByteF<64> bytef(sequence, SIZE);
+    BitL<64> bitl(sequence, SIZE);
+
+    for (const FenwickTree *tree : std::initializer_list<const FenwickTree *>{&fixedf, &fixedl, &bytef, &bitl}) {
+        std::uint64_t nodes = 0;
+        for (std::size_t i = 1; i <= SIZE; i++) {
+            tree->prefix(i);
+            nodes += hft::popcount(i);
+        }
+
+        const hft::Stats stats = tree->stats();
+        EXPECT_EQ(SIZE, stats.Prefix.Calls);
+        EXPECT_EQ(nodes, stats.Prefix.Nodes);
+        EXPECT_LE(stats.Prefix.Lines, 2 * stats.Prefix.Nodes);
+        EXPECT_GE(stats.Prefix.Lines, stats.Prefix.Calls);
+        EXPECT_EQ(0, stats.Add.Calls);
+    }
+
+    // a find on a power-of-two tree visits one node per level (unless it ends up on the root)
+    std::fill_n(sequence, SIZE, 1);
+    FixedF<64> ones(sequence, SIZE);
+    for (std::size_t i = 0; i < 100; i++)
+        ones.find(i);
+    EXPECT_EQ(100, ones.stats().Find.Calls);
+    EXPECT_EQ(100 * 17, ones.stats().Find.Nodes);
+    EXPECT_EQ(0, ones.stats().Prefix.Calls);
+
+    delete[] sequence;
+}
+
+TEST(stats, holes)
+{
+    using namespace hft::fenwick;
+    constexpr std::size_t SIZE = 1 << 16;
+
+    std::uint64_t *sequence = new std::uint64_t[SIZE]();
+    FixedF<64> fixedf(sequence, SIZE);
+    FixedL<64> fixedl(sequence, SIZE);
+
+    // FixedF has a hole every 2^14 nodes: 1, 2, ..., 2^13 | 2^14 | 2^15 | 2^16
+    fixedf.add(1, 1);
+    EXPECT_EQ(17, fixedf.stats().Add.Nodes);
+    EXPECT_EQ(3, fixedf.stats().Add.Holes);
+
+    fixedl.add(1, 1);
+    EXPECT_EQ(17, fixedl.stats().Add.Nodes);
+    EXPECT_EQ(0, fixedl.stats().Add.Holes);
+
+    delete[] sequence;
+}
+
+TEST(stats, straddles)
+{
+    using namespace hft::fenwick;
+    constexpr std::size_t SIZE = 1 << 12;
+
+    std::uint64_t *sequence = new std::uint64_t[SIZE]();
+    BitL<64> small(sequence, SIZE);
+    BitL<(1ULL << 50)> large(sequence, SIZE);
+
+    for (std::size_t i = 1; i <= SIZE; i++) {
+        small.prefix(i);
+        large.prefix(i);
+    }
+
+    // 7 to 19 bits nodes never straddle, 51 to 63 bits nodes often do
+    EXPECT_EQ(0, small.stats().Prefix.Straddles);
+    EXPECT_GT(large.stats().Prefix.Straddles, 0);
+
+    delete[] sequence;
+}
+
+TEST(stats, hybrid)
+{
+    using namespace hft::fenwick;
+    constexpr std::size_t SIZE = 100000;
+
+    std::uint64_t *sequence = new std::uint64_t[SIZE]();
+    Hybrid<ByteL, BitF, 64, 8> hybrid(sequence, SIZE);
+    hybrid.resetStats(); // the constructor queries the bottom trees
+
+    for (std::size_t i = 1; i <= 1000; i++)
+        hybrid.prefix(i * 97);
+
+    const hft::Stats top = hybrid.topStats(), bottom = hybrid.bottomStats(), stats = hybrid.stats();
+    EXPECT_EQ(1000, stats.Prefix.Calls);
+    EXPECT_EQ(1000, top.Prefix.Calls);
+    EXPECT_EQ(1000, bottom.Prefix.Calls);
+    EXPECT_GT(top.Prefix.Nodes, 0);
+    EXPECT_GT(bottom.Prefix.Nodes, 0);
+    EXPECT_EQ(top.Prefix.Nodes + bottom.Prefix.Nodes, stats.Prefix.Nodes);
+    EXPECT_EQ(top.Prefix.Lines + bottom.Prefix.Lines, stats.Prefix.Lines);
+
+    hybrid.resetStats();
+    EXPECT_EQ(0, hybrid.stats().Prefix.Calls);
+    EXPECT_EQ(0, hybrid.bottomStats().Prefix.Nodes);
+
+    delete[] sequence;
+}
+
+TEST(stats, stride)
+{
+    using namespace hft;
+    constexpr std::size_t SIZE = 10000, WORDS = 16;
+    static std::mt19937 mte;
+
+    std::uint64_t *bitvect = new std::uint64_t[SIZE];
+    for (std::size_t i = 0; i < SIZE; i++)
+        bitvect[i] = mte();
+
+    ranking::Stride<fenwick::FixedF, WORDS> stride(bitvect, SIZE);
+    const std::uint64_t ones = stride.rank(SIZE * 64);
+    stride.resetStats();
+
+    for (std::uint64_t i = 0; i < ones; i += 101)
+        stride.select(i);
+
+    const Stats stats = stride.stats();
+    EXPECT_EQ((ones + 100) / 101, stats.Selects);
+    EXPECT_EQ(stats.Selects, stats.Find.Calls);
+    EXPECT_GE(stats.Scanned, stats.Selects);
+    EXPECT_LE(stats.Scanned, stats.Selects * WORDS);
+
+    delete[] bitvect;
+}
+
+TEST(stats, hinted)
+{
+    using namespace hft;
+    constexpr std::size_t SIZE = 10000;
+    static std::mt19937 mte;
+
+    std::uint64_t *bitvect = new std::uint64_t[SIZE];
+    for (std::size_t i = 0; i < SIZE; i++)
+        bitvect[i] = mte();
+
+    ranking::Hinted<ranking::Word<fenwick::FixedF>> hinted(bitvect, SIZE, 256);
+    const std::uint64_t ones = hinted.rank(SIZE * 64);
+    for (std::uint64_t i = 0; i < ones; i += 101)
+        hinted.select(i);
+
+    // the hints are there already: no select searches the tree
+    hinted.resetStats();
+    for (std::uint64_t i = 0; i < ones; i += 101)
+        hinted.select(i);
+
+    Stats stats = hinted.stats();
+    EXPECT_EQ((ones + 100) / 101, stats.Selects);
+    EXPECT_EQ(stats.Selects, stats.Hits);
+    EXPECT_EQ(0, stats.Find.Calls);
+    EXPECT_EQ(0, stats.Prefix.Calls);
+
+    // a change in another region only costs a rank per hint
+    hinted.toggle(SIZE * 64 - 1);
+    hinted.resetStats();
+    for (std::uint64_t i = 0; i < ones / 2; i += 101)
+        hinted.select(i);
+
+    stats = hinted.stats();
+    EXPECT_EQ(stats.Selects, stats.Hits);
+    EXPECT_EQ(0, stats.Find.Calls);
+    EXPECT_LE(stats.Prefix.Calls, (ones + 255) / 256);
+
+    delete[] bitvect;
+}
+
+#else
+
+TEST(stats, disabled)
+{
+    using namespace hft;
+    constexpr std::size_t SIZE = 1000;
+
+    std::uint64_t *sequence = new std::uint64_t[SIZE]();
+    fenwick::FixedF<64> tree(sequence, SIZE);
+    ranking::Stride<fenwick::FixedF, 8> stride(sequence, SIZE);
+
+    tree.prefix(SIZE);
+    tree.add(1, 1);
+    tree.find(10);
+    stride.select(0);
+
+    EXPECT_EQ(0, tree.stats().Prefix.Calls);
+    EXPECT_EQ(0, tree.stats().Add.Nodes);
+    EXPECT_EQ(0, stride.stats().Selects);
+
+    // no counters are stored at all
+    EXPECT_EQ(sizeof(void *) + sizeof(std::size_t) + sizeof(DArray<std::uint64_t>), sizeof(tree));
+
+    delete[] sequence;
+}
+
+#endif
+
+#endif // __TEST_STATS_HPP__
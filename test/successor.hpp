@@ -0,0 +1,64 @@
+#ifndef __TEST_SUCCESSOR_HPP__
+#define __TEST_SUCCESSOR_HPP__
+
+#include "utils.hpp"
+
+// nextOne/nextZero/prevOne/prevZero of every position, checked against a linear search
+template <typename T> void successor_test(std::size_t words, std::uint64_t density)
+{
+    static std::mt19937_64 mte;
+
+    // about @density 1-bits out of 64
+    std::uint64_t *bitvector = new std::uint64_t[words];
+    for (std::size_t i = 0; i < words; i++) {
+        bitvector[i] = 0;
+        for (std::size_t j = 0; j < 64; j++)
+            bitvector[i] |= std::uint64_t(mte() % 64 < density) << j;
+    }
+    // a long empty (or full) run, crossing strides and lines
+    for (std::size_t i = words / 3; i < words / 2; i++)
+        bitvector[i] = density < 32 ? 0 : UINT64_MAX;
+
+    T bv(bitvector, words);
+    const std::size_t size = 64 * words;
+    auto bit = [&](std::size_t pos) { return bitvector[pos / 64] >> (pos % 64) & 1; };
+
+    std::size_t next[2] = {SIZE_MAX, SIZE_MAX};
+    EXPECT_EQ(SIZE_MAX, bv.nextOne(size));
+    EXPECT_EQ(SIZE_MAX, bv.nextZero(size));
+    for (std::size_t pos = size; pos-- > 0;) {
+        next[bit(pos)] = pos;
+        EXPECT_EQ(next[1], bv.nextOne(pos)) << "position: " << pos;
+        EXPECT_EQ(next[0], bv.nextZero(pos)) << "position: " << pos;
+    }
+
+    std::size_t prev[2] = {SIZE_MAX, SIZE_MAX};
+    for (std::size_t pos = 0; pos < size; pos++) {
+        prev[bit(pos)] = pos;
+        EXPECT_EQ(prev[1], bv.prevOne(pos)) << "position: " << pos;
+        EXPECT_EQ(prev[0], bv.prevZero(pos)) << "position: " << pos;
+    }
+
+    delete[] bitvector;
+}
+
+TEST(successor, rankselect)
+{
+    using namespace hft::fenwick;
+    using namespace hft::ranking;
+
+    for (std::size_t words : {1, 7, 8, 9, 100, 1000}) {
+        for (std::uint64_t density : {0, 1, 32, 63, 64}) {
+            successor_test<Word<FixedF>>(words, density);
+            successor_test<Word<BitL>>(words, density);
+            successor_test<Stride<ByteF, 1>>(words, density);
+            successor_test<Stride<FixedL, 16>>(words, density);
+            successor_test<Counted<BitF, 8>>(words, density);
+            successor_test<Counted<ByteL, 64>>(words, density);
+            successor_test<Line<FixedF>>(words, density);
+            successor_test<Hinted<Stride<BitL, 4>>>(words, density);
+        }
+    }
+}
+
+#endif // __TEST_SUCCESSOR_HPP__
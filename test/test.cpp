@@ -14,6 +14,24 @@
 
 #include "fenwicktree.hpp"
 #include "rankselect.hpp"
+#include "replicated.hpp"
+#include "memoryreport.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
+#include "tune.hpp"
+#include "model.hpp"
+#include "simulator.hpp"
+#include "holes.hpp"
+#include "fused.hpp"
+#include "batch.hpp"
+#include "popcount.hpp"
+#include "line.hpp"
+#include "counted.hpp"
+#include "hinted.hpp"
+#include "successor.hpp"
+#include "bits.hpp"
+#include "bulk.hpp"
+#include "append.hpp"
 
 int main(int argc, char **argv)
 {
@@ -0,0 +1,104 @@
+#ifndef __TEST_TRACE_HPP__
+#define __TEST_TRACE_HPP__
+
+#include "utils.hpp"
+
+TEST(trace, fenwick)
+{
+    using namespace hft;
+    constexpr std::size_t SIZE = 10000, OPS = 20000;
+    const std::string filename = ::testing::TempDir() + "fenwick.trace";
+    static std::mt19937 mte;
+    std::uniform_int_distribution<std::size_t> idxdist(1, SIZE);
+
+    std::uint64_t *sequence = new std::uint64_t[SIZE];
+    for (std::size_t i = 0; i < SIZE; i++)
+        sequence[i] = mte() % 32;
+
+    std::vector<std::uint64_t> results;
+    {
+        fenwick::Capture<fenwick::FixedF<64>> capture(sequence, SIZE, filename);
+        for (std::size_t i = 0; i < OPS; i++) {
+            const std::size_t idx = idxdist(mte);
+            switch (i % 4) {
+            case 0: results.push_back(capture.prefix(idx)); break;
+            case 1: capture.add(idx, 1); results.push_back(0); break;
+            case 2: results.push_back(capture.find(idx * 16)); break;
+            default: results.push_back(capture.compFind(idx * 16)); break;
+            }
+        }
+    }
+
+    trace::Reader reader(filename);
+    ASSERT_TRUE(reader.valid());
+    EXPECT_EQ(trace::FENWICK, reader.kind());
+    EXPECT_EQ(SIZE, reader.size());
+    EXPECT_TRUE(std::equal(sequence, sequence + SIZE, reader.snapshot()));
+    ASSERT_EQ(OPS, reader.count());
+
+    // the same trace replayed on another tree gives the same results
+    fenwick::Hybrid<fenwick::ByteL, fenwick::BitF, 64, 8> hybrid(reader.snapshot(), reader.size());
+    for (std::size_t i = 0; i < reader.count(); i++)
+        EXPECT_EQ(results[i], trace::apply(hybrid, reader.records()[i])) << "record: " << i;
+
+    delete[] sequence;
+    std::remove(filename.c_str());
+}
+
+TEST(trace, rankselect)
+{
+    using namespace hft;
+    constexpr std::size_t SIZE = 1000, OPS = 20000;
+    const std::string filename = ::testing::TempDir() + "rankselect.trace";
+    static std::mt19937_64 mte;
+    std::uniform_int_distribution<std::size_t> bitdist(0, SIZE * 64 - 1);
+
+    std::uint64_t *bitvect = new std::uint64_t[SIZE];
+    for (std::size_t i = 0; i < SIZE; i++)
+        bitvect[i] = mte();
+
+    std::vector<std::uint64_t> results;
+    {
+        ranking::Capture<ranking::Stride<fenwick::FixedF, 8>> capture(bitvect, SIZE, filename);
+        for (std::size_t i = 0; i < OPS; i++) {
+            const std::size_t pos = bitdist(mte);
+            const std::uint64_t ones = capture.rank(SIZE * 64);
+            switch (i % 6) {
+            case 0: results.push_back(capture.rankZero(pos)); break;
+            case 1: results.push_back(capture.rank(pos / 2, pos)); break;
+            case 2: results.push_back(capture.select(pos % ones)); break;
+            case 3: results.push_back(capture.selectZero(pos % (SIZE * 64 - ones))); break;
+            case 4: results.push_back(capture.toggle(pos)); break;
+            default: results.push_back(capture.update(pos / 64, mte())); break;
+            }
+        }
+    }
+
+    trace::Reader reader(filename);
+    ASSERT_TRUE(reader.valid());
+    EXPECT_EQ(trace::RANKSELECT, reader.kind());
+    ASSERT_EQ(2 * OPS, reader.count());
+
+    ranking::Word<fenwick::BitL> word(reader.snapshot(), reader.size());
+    for (std::size_t i = 0; i < reader.count(); i += 2) {
+        EXPECT_EQ(trace::RANK, reader.records()[i].op());
+        trace::apply(word, reader.records()[i]);
+        EXPECT_EQ(results[i / 2], trace::apply(word, reader.records()[i + 1])) << "record: " << i + 1;
+    }
+
+    delete[] bitvect;
+    std::remove(filename.c_str());
+}
+
+TEST(trace, invalid)
+{
+    const std::string filename = ::testing::TempDir() + "invalid.trace";
+    std::ofstream(filename) << "not a trace, even if it is longer than a header";
+
+    EXPECT_FALSE(hft::trace::Reader(filename).valid());
+    EXPECT_FALSE(hft::trace::Reader(filename + ".missing").valid());
+
+    std::remove(filename.c_str());
+}
+
+#endif // __TEST_TRACE_HPP__
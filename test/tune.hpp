@@ -0,0 +1,116 @@
+#ifndef __TEST_TUNE_HPP__
+#define __TEST_TUNE_HPP__
+
+#include "utils.hpp"
+
+TEST(tune, factory)
+{
+    using namespace hft;
+    constexpr std::size_t SIZE = 3000;
+    static std::mt19937_64 mte;
+
+    std::uint64_t *sequence = new std::uint64_t[SIZE];
+    for (std::size_t i = 0; i < SIZE; i++)
+        sequence[i] = mte() % 65;
+
+    // every candidate built at runtime behaves like FixedF
+    fenwick::FixedF<64> fixedf(sequence, SIZE);
+    for (const auto &candidate : tune::treeCandidates<64>()) {
+        unique_ptr<fenwick::FenwickTree> tree = tune::makeTree<64>(candidate.Name, sequence, SIZE);
+        ASSERT_NE(nullptr, tree) << candidate.Name;
+        EXPECT_EQ(SIZE, tree->size()) << candidate.Name;
+        for (std::size_t i = 0; i <= SIZE; i += 7)
+            EXPECT_EQ(fixedf.prefix(i), tree->prefix(i)) << candidate.Name << ", index: " << i;
+        for (std::uint64_t val = 0; val < fixedf.prefix(SIZE); val += 101)
+            EXPECT_EQ(fixedf.find(val), tree->find(val)) << candidate.Name << ", value: " << val;
+    }
+    EXPECT_EQ(nullptr, tune::makeTree<64>("nonexistent", sequence, SIZE));
+
+    ranking::Word<fenwick::FixedF> word(sequence, SIZE);
+    for (const auto &candidate : tune::rankSelectCandidates()) {
+        unique_ptr<ranking::RankSelect> rs = tune::makeRankSelect(candidate.Name, sequence, SIZE);
+        ASSERT_NE(nullptr, rs) << candidate.Name;
+        for (std::size_t pos = 0; pos < SIZE * 64; pos += 97)
+            EXPECT_EQ(word.rank(pos), rs->rank(pos)) << candidate.Name << ", position: " << pos;
+        for (std::uint64_t rank = 0; rank < word.rank(SIZE * 64); rank += 53)
+            EXPECT_EQ(word.select(rank), rs->select(rank)) << candidate.Name << ", rank: " << rank;
+    }
+    EXPECT_EQ(nullptr, tune::makeRankSelect("nonexistent", sequence, SIZE));
+
+    delete[] sequence;
+}
+
+TEST(tune, fenwick)
+{
+    using namespace hft;
+    constexpr std::size_t SIZE = 3000, OPS = 5000;
+    static std::mt19937_64 mte;
+
+    std::uint64_t *sequence = new std::uint64_t[SIZE];
+    for (std::size_t i = 0; i < SIZE; i++)
+        sequence[i] = mte() % 65;
+
+    const std::vector<trace::Record> ops = tune::treeOps<64>(sequence, SIZE, {1, 2, 1}, OPS, 7);
+    ASSERT_EQ(OPS, ops.size());
+
+    // the updates keep every element within the bound: compressed trees agree with FixedF
+    fenwick::FixedF<64> fixedf(sequence, SIZE);
+    fenwick::BitF<64> bitf(sequence, SIZE);
+    for (std::size_t i = 0; i < OPS; i++)
+        EXPECT_EQ(trace::apply(fixedf, ops[i]), trace::apply(bitf, ops[i])) << "operation: " << i;
+
+    // FixedF and FixedL don't fit
+    const std::size_t budget = fixedf.memoryReport().total() / 8 - 1;
+    const std::vector<tune::Result> results =
+        tune::tree<64>(sequence, SIZE, ops.data(), ops.size(), budget, 1);
+    ASSERT_EQ(tune::treeCandidates<64>().size(), results.size());
+    ASSERT_TRUE(results[0].Fits);
+
+    for (std::size_t i = 0; i < results.size(); i++) {
+        EXPECT_EQ(results[i].Bytes <= budget, results[i].Fits) << results[i].Name;
+        EXPECT_NE(results[i].Name == "fixedf" || results[i].Name == "fixedl", results[i].Fits);
+        if (i > 0 && results[i].Fits) {
+            EXPECT_LE(results[i - 1].Ns, results[i].Ns);
+        }
+        if (i > 0 && !results[i - 1].Fits) {
+            EXPECT_FALSE(results[i].Fits);
+        }
+    }
+
+    EXPECT_EQ("using Tree = " + results[0].Type + ";", tune::snippet(results[0]));
+
+    delete[] sequence;
+}
+
+TEST(tune, rankselect)
+{
+    using namespace hft;
+    constexpr std::size_t SIZE = 1000, OPS = 5000;
+    static std::mt19937_64 mte;
+
+    std::uint64_t *bitvect = new std::uint64_t[SIZE];
+    for (std::size_t i = 0; i < SIZE; i++)
+        bitvect[i] = mte();
+
+    const std::vector<trace::Record> ops = tune::rankSelectOps(bitvect, SIZE, {1, 1, 1}, OPS, 7);
+    ASSERT_EQ(OPS, ops.size());
+
+    // selects never go past the ones left by the toggles
+    ranking::Word<fenwick::FixedF> word(bitvect, SIZE);
+    for (std::size_t i = 0; i < OPS; i++)
+        EXPECT_NE(SIZE_MAX, trace::apply(word, ops[i])) << "operation: " << i;
+
+    const std::vector<tune::Result> results =
+        tune::rankSelect(bitvect, SIZE, ops.data(), ops.size(), SIZE_MAX, 1);
+    ASSERT_EQ(tune::rankSelectCandidates().size(), results.size());
+    for (std::size_t i = 0; i < results.size(); i++) {
+        EXPECT_TRUE(results[i].Fits);
+        if (i > 0) {
+            EXPECT_LE(results[i - 1].Ns, results[i].Ns);
+        }
+    }
+
+    delete[] bitvect;
+}
+
+#endif // __TEST_TUNE_HPP__
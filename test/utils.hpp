@@ -18,10 +18,21 @@
 #include "../include/fenwick/bitf.hpp"
 #include "../include/fenwick/bitl.hpp"
 #include "../include/fenwick/hybrid.hpp"
+#include "../include/fenwick/replicated.hpp"
+#include "../include/fenwick/capture.hpp"
 
 #include "../include/rankselect/rank_select.hpp"
 #include "../include/rankselect/word.hpp"
 #include "../include/rankselect/stride.hpp"
+#include "../include/rankselect/line.hpp"
+#include "../include/rankselect/counted.hpp"
+#include "../include/rankselect/replicated.hpp"
+#include "../include/rankselect/capture.hpp"
+#include "../include/rankselect/hinted.hpp"
+
+#include "../include/tune.hpp"
+#include "../include/model.hpp"
+#include "../include/simulator.hpp"
 
 
 // Exposed classes
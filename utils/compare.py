@@ -0,0 +1,123 @@
+#example: python utils/compare.py benchout/driver/before/ benchout/driver/after/ --alpha 0.01
+# Compare two sets of JSON results (see benchmark/results.hpp): for every configuration measured
+# by both (same tree, op, size and other parameters) print the change of the mean time with its
+# Welch confidence interval, and flag it when the whole interval is beyond the threshold. The
+# exit status is 1 if some configuration regressed.
+import sys, os, json, math, argparse
+
+# fields shown first in the name of a configuration
+PRIMARY = ['tree', 'op', 'size']
+
+def load(paths):
+    results, metadata = {}, []
+    files = []
+    for path in paths:
+        if os.path.isdir(path):
+            for root, _, names in os.walk(path):
+                files += [os.path.join(root, name) for name in sorted(names) if name.endswith('.json')]
+        else:
+            files.append(path)
+
+    for filename in files:
+        with open(filename, "r") as jsonfile:
+            data = json.load(jsonfile)
+        metadata.append(data['metadata'])
+        for result in data['results']:
+            fields = [k for k in result if k not in ('unit', 'samples')]
+            fields.sort(key=lambda k: (PRIMARY.index(k) if k in PRIMARY else len(PRIMARY), k))
+            key = tuple((k, str(result[k])) for k in fields)
+            results.setdefault(key, []).extend(result['samples'])
+    return results, metadata
+
+def betacf(a, b, x):
+    # continued fraction of the incomplete beta function (Numerical Recipes)
+    qab, qap, qam = a + b, a + 1, a - 1
+    c, d = 1., 1 - qab * x / qap
+    d = 1 / (d if abs(d) > 1e-300 else 1e-300)
+    h = d
+    for m in range(1, 300):
+        m2 = 2 * m
+        for aa in (m * (b - m) * x / ((qam + m2) * (a + m2)), -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2))):
+            d = 1 + aa * d
+            d = 1 / (d if abs(d) > 1e-300 else 1e-300)
+            c = 1 + aa / c
+            c = c if abs(c) > 1e-300 else 1e-300
+            h *= d * c
+        if abs(d * c - 1) < 1e-12: break
+    return h
+
+def betainc(a, b, x):
+    if x <= 0 or x >= 1: return max(0., min(1., x))
+    front = math.exp(math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b) + a * math.log(x) + b * math.log(1 - x))
+    if x < (a + 1) / (a + b + 2): return front * betacf(a, b, x) / a
+    return 1 - front * betacf(b, a, 1 - x) / b
+
+def tcdf(t, df):
+    tail = 0.5 * betainc(df / 2, 0.5, df / (df + t * t))
+    return 1 - tail if t > 0 else tail
+
+def tquantile(p, df):
+    lo, hi = 0., 1e3
+    for _ in range(200):
+        mid = (lo + hi) / 2
+        if tcdf(mid, df) < p: lo = mid
+        else: hi = mid
+    return (lo + hi) / 2
+
+def stats(samples):
+    n = len(samples)
+    mean = sum(samples) / n
+    var = sum((s - mean) ** 2 for s in samples) / (n - 1) if n > 1 else float('nan')
+    return n, mean, var
+
+def welch(base, new, alpha):
+    # confidence interval of mean(new) - mean(base)
+    n1, m1, v1 = stats(base)
+    n2, m2, v2 = stats(new)
+    if n1 < 2 or n2 < 2: return m1, m2, None
+    se2 = v1 / n1 + v2 / n2
+    if se2 == 0: return m1, m2, (m2 - m1, m2 - m1)
+    df = se2 ** 2 / ((v1 / n1) ** 2 / (n1 - 1) + (v2 / n2) ** 2 / (n2 - 1))
+    half = tquantile(1 - alpha / 2, df) * math.sqrt(se2)
+    return m1, m2, (m2 - m1 - half, m2 - m1 + half)
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Flag significant changes between two sets of results')
+    parser.add_argument('base', help='JSON file or directory of the baseline')
+    parser.add_argument('new', help='JSON file or directory of the candidate')
+    parser.add_argument('--alpha', type=float, default=0.05, help='1 - confidence level (default: 0.05)')
+    parser.add_argument('--threshold', type=float, default=0.02, help='relative change ignored (default: 0.02)')
+    parser.add_argument('--all', action='store_true', help='print unchanged configurations too')
+    args = parser.parse_args()
+
+    base, basemeta = load([args.base])
+    new, newmeta = load([args.new])
+
+    for field in ('cpu', 'compiler', 'flags', 'pages', 'placement'):
+        before, after = {m.get(field) for m in basemeta}, {m.get(field) for m in newmeta}
+        if before != after:
+            print('warning: different %s: %s -> %s' % (field, ', '.join(map(str, before)), ', '.join(map(str, after))), file=sys.stderr)
+
+    regressions = 0
+    print('%-60s %12s %12s %8s %20s  %s' % ('configuration', 'base', 'new', 'change', 'interval', 'verdict'))
+    for key in sorted(base.keys() & new.keys()):
+        m1, m2, interval = welch(base[key], new[key], args.alpha)
+        name = ' '.join(v for _, v in key)
+        change = (m2 - m1) / m1 if m1 else 0.
+
+        if interval is None:
+            verdict, text = '', 'too few samples'
+        else:
+            lo, hi = interval[0] / m1, interval[1] / m1
+            text = '[%+.1f%%, %+.1f%%]' % (100 * lo, 100 * hi)
+            verdict = 'REGRESSION' if lo > args.threshold else 'improvement' if hi < -args.threshold else ''
+        regressions += verdict == 'REGRESSION'
+
+        if verdict or args.all:
+            print('%-60s %12.3f %12.3f %+7.1f%% %20s  %s' % (name, m1, m2, 100 * change, text, verdict))
+
+    missing = len(base.keys() ^ new.keys())
+    if missing:
+        print('%d configurations measured by only one of the sets were ignored' % missing, file=sys.stderr)
+
+    sys.exit(1 if regressions else 0)
@@ -0,0 +1,50 @@
+#example: python utils/histmerge.py run1/latency_find_hist.csv run2/latency_find_hist.csv > find.csv
+# Merge the latency histograms of several runs (see benchmark/latency.hpp) and print their
+# percentiles in the format of latency_<op>.csv
+import sys, csv, math
+
+SUBBITS = 5
+SUB = 1 << SUBBITS
+
+def bucket(value):
+    if value < SUB: return value
+    exp = value.bit_length() - 1
+    return (exp - SUBBITS + 1) * SUB + ((value >> (exp - SUBBITS)) & (SUB - 1))
+
+def lowest(b):
+    if b < SUB: return b
+    exp = b // SUB + SUBBITS - 1
+    return (SUB + b % SUB) << (exp - SUBBITS)
+
+def highest(b):
+    return lowest(b + 1) - 1
+
+# the largest value recorded, or (for files lacking the Max column) the bound of the top bucket
+def merge(filenames):
+    hists, maxes = {}, {}
+    for filename in filenames:
+        with open(filename, "r") as csvfile:
+            for row in csv.DictReader(csvfile):
+                key = (int(row['Elements']), row['Tree'])
+                hist = hists.setdefault(key, {})
+                b = bucket(int(row['Low']))
+                hist[b] = hist.get(b, 0) + int(row['Count'])
+                top = int(row['Max']) if row.get('Max') else highest(b)
+                maxes[key] = max(maxes.get(key, 0), top)
+    return hists, maxes
+
+def percentile(hist, total, top, p):
+    rank = min(max(math.ceil(p * total), 1), total)
+    cumulative = 0
+    for b in sorted(hist):
+        cumulative += hist[b]
+        if cumulative >= rank: return min(highest(b), top)
+
+if __name__ == '__main__':
+    writer = csv.writer(sys.stdout)
+    writer.writerow(['Elements', 'Tree', 'p50', 'p90', 'p99', 'p999', 'max'])
+    hists, maxes = merge(sys.argv[1:])
+    for (elements, tree), hist in hists.items():
+        total = sum(hist.values())
+        top = maxes[(elements, tree)]
+        writer.writerow([elements, tree] + [ percentile(hist, total, top, p) for p in (.5, .9, .99, .999) ] + [top])
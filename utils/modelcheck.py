@@ -0,0 +1,68 @@
+#example: python utils/modelcheck.py benchout/fenwick/uniform/
+# Compare the costs predicted by include/model.hpp (model.csv, written by the Fenwick benchmark)
+# with the hardware counters measured on the same queries (perf_<op>.csv): for every size, tree and
+# operation print the predicted and measured L1 misses, LLC misses and dTLB misses per operation,
+# and their ratio. Rows repeated by several runs are averaged.
+import sys, os, csv, argparse
+
+# predicted column -> measured column
+COUNTERS = [('l1dmiss', 'l1dmiss'), ('llcmiss', 'llcmiss'), ('dtlbmiss', 'dtlbmiss')]
+
+def average(rows, key, fields):
+    sums = {}
+    for row in rows:
+        values = sums.setdefault(key(row), {f: [] for f in fields})
+        for f in fields:
+            if row.get(f):
+                values[f].append(float(row[f]))
+    return {k: {f: sum(v) / len(v) if v else None for f, v in values.items()} for k, values in sums.items()}
+
+def load(path):
+    with open(os.path.join(path, 'model.csv'), 'r') as modelfile:
+        model = average(csv.DictReader(modelfile), lambda r: (int(r['Elements']), r['Tree'], r['Op']),
+                        ['nodes', 'lines', 'pages'] + [p for p, _ in COUNTERS])
+
+    perf = {}
+    for op in sorted({op for _, _, op in model}):
+        filename = os.path.join(path, 'perf_%s.csv' % op)
+        if not os.path.exists(filename):
+            continue
+        with open(filename, 'r') as perffile:
+            rows = average(csv.DictReader(perffile), lambda r: (int(r['Elements']), r['Tree']),
+                           [m for _, m in COUNTERS])
+        perf.update({(size, tree, op): values for (size, tree), values in rows.items()})
+    return model, perf
+
+def ratio(measured, predicted):
+    if measured is None: return 'n/a'
+    if predicted == 0: return '-' if measured == 0 else 'inf'
+    return '%.2f' % (measured / predicted)
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Compare the cost model with the hardware counters')
+    parser.add_argument('path', help='output directory of the Fenwick benchmark')
+    args = parser.parse_args()
+
+    model, perf = load(args.path)
+    if not model:
+        sys.exit('%s has no predictions' % os.path.join(args.path, 'model.csv'))
+
+    header = '%10s %-16s %-7s %6s %6s' % ('size', 'tree', 'op', 'nodes', 'lines')
+    for p, _ in COUNTERS:
+        header += ' %21s' % ('%s pred/meas/x' % p)
+    print(header)
+
+    measured = 0
+    for key in sorted(model):
+        size, tree, op = key
+        predicted, counters = model[key], perf.get(key, {})
+        line = '%10d %-16s %-7s %6.2f %6.2f' % (size, tree, op, predicted['nodes'], predicted['lines'])
+        for p, m in COUNTERS:
+            value = counters.get(m)
+            measured += value is not None
+            line += ' %21s' % ('%.2f/%s/%s' % (predicted[p], '-' if value is None else '%.2f' % value,
+                                                ratio(value, predicted[p])))
+        print(line)
+
+    if not measured:
+        print('No hardware counters were measured: only the predictions are shown', file=sys.stderr)